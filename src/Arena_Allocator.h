@@ -0,0 +1,372 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                      'Arena' class
+    //
+    //          The Arena is a bump allocator intended for interpreter evaluation
+    //          scopes, in which many short lived sequences are created and all die
+    //          together.  An allocation is a pointer bump inside the current chunk,
+    //          releasing a single allocation does nothing, (unless it was the most
+    //          recent one), and reset() frees the entire scope at once.
+    //
+    //          An Arena is not thread safe, each thread is expected to bind its own.
+    //
+    /********************************************************************************************/
+
+    class Arena {
+
+    public:
+        static constexpr std::size_t default_chunk_bytes = std::size_t{ 1 } << 16;
+
+        Arena(std::size_t chunk_bytes = default_chunk_bytes);
+        ~Arena();
+
+        Arena(Arena&&)                  = delete;
+        Arena(const Arena&)             = delete;
+        Arena& operator =(Arena&&)      = delete;
+        Arena& operator =(const Arena&) = delete;
+
+        void*   allocate(std::size_t bytes, std::size_t align);
+        void  deallocate(void* buffer, std::size_t bytes) noexcept;
+
+        void reset() noexcept;
+
+        std::size_t bytes_used()     const noexcept;
+        std::size_t bytes_reserved() const noexcept;
+
+        Arena* outer() const noexcept;
+
+        static Arena*& current() noexcept;
+
+    private:
+        friend class ArenaScope;
+
+        struct Chunk {
+            std::byte*  data;
+            std::size_t size;
+        };
+
+        std::vector<Chunk> _chunks;
+        std::size_t        _chunk_bytes;
+        std::byte*         _top;
+        std::byte*         _limit;
+        std::size_t        _used;
+        Arena*             _outer;
+
+        void grow(std::size_t bytes, std::size_t align);
+    };
+
+    /********************************************************************************************/
+    //
+    //                                    'ArenaScope' class
+    //
+    //          Binds an Arena as the current arena of the calling thread for the
+    //          lifetime of the scope.  On exit the previous arena is restored and
+    //          every allocation made within the scope is released at once.
+    //
+    //          While bound, the arena records the arena which was current before
+    //          it, (its outer arena, or nullptr for the global heap), which is
+    //          where a sequence moved out of it is rebuilt, (see ArenaVector).
+    //
+    //          A sequence allocated within the scope must not outlive it, but one
+    //          moved out of it may.  Copy elision bypasses the move constructor, so
+    //          a function holding the scope returns a local arena sequence with
+    //          'return std::move(seq);' rather than 'return seq;'.
+    //
+    /********************************************************************************************/
+
+    class ArenaScope {
+
+    public:
+        ArenaScope(std::size_t chunk_bytes = Arena::default_chunk_bytes);
+        ArenaScope(Arena& arena);
+        ~ArenaScope();
+
+        ArenaScope(ArenaScope&&)                  = delete;
+        ArenaScope(const ArenaScope&)             = delete;
+        ArenaScope& operator =(ArenaScope&&)      = delete;
+        ArenaScope& operator =(const ArenaScope&) = delete;
+
+        Arena& arena() noexcept;
+
+    private:
+        Arena  _owned;
+        Arena* _arena;
+        Arena* _previous;
+    };
+
+    /********************************************************************************************/
+    //
+    //                                  'ArenaAllocator' class
+    //
+    //          The allocator binds to the current arena of the thread when it is
+    //          constructed, or to the global heap when no ArenaScope is active.
+    //
+    //          A copy constructed container rebinds to the current arena, and move
+    //          assignment does not propagate the allocator, so move assigning to a
+    //          container of another arena moves the elements one by one.
+    //
+    /********************************************************************************************/
+
+    template <typename T>
+    class ArenaAllocator {
+
+    public:
+        using value_type      = T;
+        using size_type       = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        using is_always_equal                        = std::false_type;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::false_type;
+        using propagate_on_container_swap            = std::true_type;
+
+        ArenaAllocator() noexcept : _arena(Arena::current()) {
+        }
+
+        ArenaAllocator(Arena* arena) noexcept : _arena(arena) {
+        }
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) noexcept : _arena(other.arena()) {
+        }
+
+        T* allocate(std::size_t n) {
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+                throw std::bad_array_new_length();
+            }
+            if (_arena != nullptr) {
+                return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+            }
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ alignof(T) }));
+        }
+
+        void deallocate(T* buffer, std::size_t n) noexcept {
+            if (_arena != nullptr) {
+                _arena->deallocate(buffer, n * sizeof(T));
+            }
+            else {
+                ::operator delete(buffer, n * sizeof(T), std::align_val_t{ alignof(T) });
+            }
+        }
+
+        ArenaAllocator select_on_container_copy_construction() const noexcept {
+            return ArenaAllocator();
+        }
+
+        Arena* arena() const noexcept {
+            return _arena;
+        }
+
+        template <typename U>
+        bool operator ==(const ArenaAllocator<U>& other) const noexcept {
+            return _arena == other.arena();
+        }
+
+    private:
+        Arena* _arena;
+    };
+
+    /********************************************************************************************/
+    //
+    //                                   'ArenaVector' class
+    //
+    //          The IMPL of an ArenaSeqContainer.  A std::vector moved by construction
+    //          keeps its allocator, so moving a sequence into a container which
+    //          outlives the scope, (keep.push_back(std::move(tmp))), would leave it
+    //          pointing into the released arena.  ArenaVector instead move constructs
+    //          onto the outer arena of the source, (or the global heap), copying the
+    //          elements once per scope they leave.  A sequence on the global heap is
+    //          moved as usual.
+    //
+    /********************************************************************************************/
+
+    template <typename T>
+    class ArenaVector : public std::vector<T, ArenaAllocator<T>> {
+
+        using base = std::vector<T, ArenaAllocator<T>>;
+
+    public:
+        using base::base;
+
+        ArenaVector() = default;
+        ~ArenaVector() = default;
+
+        ArenaVector(ArenaVector&& other) : base(std::move(other), outer_allocator(other)) {
+        }
+
+        ArenaVector(const ArenaVector& other)             = default;
+        ArenaVector& operator =(ArenaVector&& other)      = default;
+        ArenaVector& operator =(const ArenaVector& other) = default;
+
+    private:
+        static ArenaAllocator<T> outer_allocator(const ArenaVector& seq) noexcept {
+            const auto arena = seq.get_allocator().arena();
+            return ArenaAllocator<T>(arena != nullptr ? arena->outer() : nullptr);
+        }
+    };
+
+    template <typename VALUE = intmax_t>
+    using ArenaSeqContainer = SeqContainer<VALUE, ArenaVector<VALUE>>;
+
+    /*****************************************************************************************/
+    //
+    //                                  Arena Construction
+    //
+    /*****************************************************************************************/
+
+    inline Arena::Arena(std::size_t chunk_bytes) : _chunks(), _chunk_bytes(std::max<std::size_t>(chunk_bytes, 256)), _top(nullptr), _limit(nullptr), _used(0), _outer(nullptr) {
+    }
+
+    inline Arena::~Arena() {
+        for (auto& chunk : _chunks) {
+            ::operator delete(chunk.data, chunk.size, std::align_val_t{ alignof(std::max_align_t) });
+        }
+    }
+
+    inline Arena* Arena::outer() const noexcept {
+        return _outer;
+    }
+
+    inline Arena*& Arena::current() noexcept {
+        thread_local Arena* arena = nullptr;
+        return arena;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                 Arena Allocation
+    //
+    /*****************************************************************************************/
+
+    inline void* Arena::allocate(std::size_t bytes, std::size_t align) {
+        auto top = reinterpret_cast<std::uintptr_t>(_top);
+        auto at  = (top + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1);
+        if (_top == nullptr || at + bytes > reinterpret_cast<std::uintptr_t>(_limit)) {
+            grow(bytes, align);
+            top = reinterpret_cast<std::uintptr_t>(_top);
+            at  = (top + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1);
+        }
+        _top   = reinterpret_cast<std::byte*>(at + bytes);
+        _used += bytes;
+        return reinterpret_cast<void*>(at);
+    }
+
+    /*
+        Only the most recent allocation can be given back, which is the common
+        case of a temporary that dies before anything else is allocated.
+    */
+    inline void Arena::deallocate(void* buffer, std::size_t bytes) noexcept {
+        if (static_cast<std::byte*>(buffer) + bytes == _top) {
+            _top   = static_cast<std::byte*>(buffer);
+            _used -= bytes;
+        }
+    }
+
+    /*
+        Keeps the largest chunk, so that a scope which is entered repeatedly
+        does not go back to the system allocator on every entry.
+    */
+    inline void Arena::reset() noexcept {
+        if (_chunks.empty()) {
+            return;
+        }
+        auto largest = std::max_element(_chunks.begin(), _chunks.end(), [](const Chunk& a, const Chunk& b) {
+            return a.size < b.size;
+        });
+        std::swap(*largest, _chunks.front());
+        for (std::size_t i = 1; i < _chunks.size(); ++i) {
+            ::operator delete(_chunks[i].data, _chunks[i].size, std::align_val_t{ alignof(std::max_align_t) });
+        }
+        _chunks.resize(1);
+        _top   = _chunks.front().data;
+        _limit = _top + _chunks.front().size;
+        _used  = 0;
+    }
+
+    inline std::size_t Arena::bytes_used() const noexcept {
+        return _used;
+    }
+
+    inline std::size_t Arena::bytes_reserved() const noexcept {
+        std::size_t bytes = 0;
+        for (const auto& chunk : _chunks) {
+            bytes += chunk.size;
+        }
+        return bytes;
+    }
+
+    inline void Arena::grow(std::size_t bytes, std::size_t align) {
+        const auto size = std::max(_chunk_bytes, bytes + align);
+        _chunks.reserve(_chunks.size() + 1);
+        auto data = static_cast<std::byte*>(::operator new(size, std::align_val_t{ alignof(std::max_align_t) }));
+        _chunks.push_back(Chunk{ data, size });
+        _top   = data;
+        _limit = data + size;
+        if (_chunk_bytes < (std::size_t{ 1 } << 26)) {
+            _chunk_bytes *= 2;
+        }
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                      Arena Scope
+    //
+    /*****************************************************************************************/
+
+    inline ArenaScope::ArenaScope(std::size_t chunk_bytes) : _owned(chunk_bytes), _arena(&_owned), _previous(Arena::current()) {
+        _arena->_outer   = _previous;
+        Arena::current() = _arena;
+    }
+
+    inline ArenaScope::ArenaScope(Arena& arena) : _owned(), _arena(&arena), _previous(Arena::current()) {
+        _arena->_outer   = _previous;
+        Arena::current() = _arena;
+    }
+
+    inline ArenaScope::~ArenaScope() {
+        Arena::current() = _previous;
+        _arena->_outer   = nullptr;
+        _arena->reset();
+    }
+
+    inline Arena& ArenaScope::arena() noexcept {
+        return *_arena;
+    }
+}
@@ -0,0 +1,456 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "Expression_Template.h"
+#include "Parallel.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                     BLAS Level One
+    //
+    //          axpy(a, x, y)   y = a * x + y
+    //          scal(a, x)      x = a * x
+    //          dot(x, y)       the sum of x[i] * y[i]
+    //          nrm2(x)         the euclidean norm of x
+    //          asum(x)         the sum of |x[i]|
+    //          iamax(x)        the index of the first element of largest |x[i]|
+    //
+    //          The kernels work on raw pointers of contiguous floating point
+    //          sequences, (a SeqContainer over a std::vector or std::array), with no
+    //          bounds checks, and split large inputs into blocks run in parallel.
+    //          Reductions keep 'blas_lanes' independent accumulators per block, so the
+    //          loops vectorize, and the partial results are combined in block order,
+    //          making the result independent of scheduling for a given thread count.
+    //
+    //          A 'Scalar' is an expression leaf holding a single value, so that the
+    //          usual operators spell the level one operations:
+    //
+    //              y += scalar(a) * x;     // axpy
+    //              y -= x * scalar(a);     // axpy with -a
+    //              y *= scalar(a);         // scal
+    //
+    //          Blas.h specializes the CompoundAssign customization point of
+    //          SeqContainer, so that these patterns dispatch to the kernels below
+    //          when every operand is a contiguous floating point sequence of the
+    //          same size.  Any other expression, or sizes which differ, take the
+    //          generic element wise path.
+    //
+    /********************************************************************************************/
+
+    constexpr std::size_t blas_lanes = 8;
+    constexpr std::size_t blas_tile  = 4096;
+
+    template <typename T>
+    concept BlasValue = std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+    /*****************************************************************************************/
+    //
+    //                                     'Scalar' class
+    //
+    //          Reads as 'value' at every index.  Its size is zero, so the size of an
+    //          expression holding it is that of its other operand.  An operator of
+    //          a Scalar converts it to the value type of the other operand, so that
+    //          scalar(2) * x is a sequence of double when x is.
+    //
+    /*****************************************************************************************/
+
+    template <typename T>
+    class Scalar {
+
+    public:
+        using value_type = T;
+
+        explicit Scalar(T value) : _value(value) {
+        }
+
+        T value() const noexcept {
+            return _value;
+        }
+
+        T operator [](std::size_t) const noexcept {
+            return _value;
+        }
+
+        std::size_t size() const noexcept {
+            return 0;
+        }
+
+        template <typename RE> auto operator +(RE&& re) const -> ExprTemplate<Scalar<expr_value_type<RE>>, Add_Op<expr_value_type<RE>>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator -(RE&& re) const -> ExprTemplate<Scalar<expr_value_type<RE>>, Sub_Op<expr_value_type<RE>>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator *(RE&& re) const -> ExprTemplate<Scalar<expr_value_type<RE>>, Mul_Op<expr_value_type<RE>>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator /(RE&& re) const -> ExprTemplate<Scalar<expr_value_type<RE>>, Div_Op<expr_value_type<RE>>, decltype(std::forward<RE>(re))>;
+
+    private:
+        T _value;
+    };
+
+    template <typename T>
+    struct is_scalar : std::false_type {};
+
+    template <typename T>
+    struct is_scalar<Scalar<T>> : std::true_type {};
+
+    template <typename T>
+    auto scalar(T value) -> Scalar<T> {
+        return Scalar<T>(value);
+    }
+
+    template <typename T>
+    template <typename RE>
+    inline auto Scalar<T>::operator +(RE&& re) const -> ExprTemplate<Scalar<expr_value_type<RE>>, Add_Op<expr_value_type<RE>>, decltype(std::forward<RE>(re))> {
+        using V = expr_value_type<RE>;
+        return ExprTemplate<Scalar<V>, Add_Op<V>, decltype(std::forward<RE>(re))>(Scalar<V>(static_cast<V>(_value)), std::forward<RE>(re));
+    }
+
+    template <typename T>
+    template <typename RE>
+    inline auto Scalar<T>::operator -(RE&& re) const -> ExprTemplate<Scalar<expr_value_type<RE>>, Sub_Op<expr_value_type<RE>>, decltype(std::forward<RE>(re))> {
+        using V = expr_value_type<RE>;
+        return ExprTemplate<Scalar<V>, Sub_Op<V>, decltype(std::forward<RE>(re))>(Scalar<V>(static_cast<V>(_value)), std::forward<RE>(re));
+    }
+
+    template <typename T>
+    template <typename RE>
+    inline auto Scalar<T>::operator *(RE&& re) const -> ExprTemplate<Scalar<expr_value_type<RE>>, Mul_Op<expr_value_type<RE>>, decltype(std::forward<RE>(re))> {
+        using V = expr_value_type<RE>;
+        return ExprTemplate<Scalar<V>, Mul_Op<V>, decltype(std::forward<RE>(re))>(Scalar<V>(static_cast<V>(_value)), std::forward<RE>(re));
+    }
+
+    template <typename T>
+    template <typename RE>
+    inline auto Scalar<T>::operator /(RE&& re) const -> ExprTemplate<Scalar<expr_value_type<RE>>, Div_Op<expr_value_type<RE>>, decltype(std::forward<RE>(re))> {
+        using V = expr_value_type<RE>;
+        return ExprTemplate<Scalar<V>, Div_Op<V>, decltype(std::forward<RE>(re))>(Scalar<V>(static_cast<V>(_value)), std::forward<RE>(re));
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                        Kernels
+    //
+    /*****************************************************************************************/
+
+    /*
+        Calls func(first, last) for every block of [0, count) and returns the
+        results combined with 'combine', in block order.
+    */
+    template <typename R, typename Func, typename Combine>
+    R blas_reduce(std::size_t count, std::size_t grain, R identity, Func&& func, Combine&& combine) {
+        const auto blocks = block_count(count, grain);
+        std::vector<R> partial(blocks, identity);
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [first, last] = block_range(count, blocks, block);
+            partial[block] = func(first, last);
+        });
+        R total = identity;
+        for (const auto& value : partial) {
+            total = combine(total, value);
+        }
+        return total;
+    }
+
+    template <typename T>
+    T blas_lane_sum(const std::array<T, blas_lanes>& lanes) {
+        return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+
+    template <typename T>
+    void blas_axpy(std::size_t count, T alpha, const T* x, T* y, std::size_t grain = default_grain) {
+        if (alpha == T{ 0 }) {
+            return;
+        }
+        parallel_for(count, grain, [&](std::size_t first, std::size_t last, std::size_t) {
+            for (std::size_t i = first; i < last; ++i) {
+                y[i] += alpha * x[i];
+            }
+        });
+    }
+
+    template <typename T>
+    void blas_scal(std::size_t count, T alpha, T* x, std::size_t grain = default_grain) {
+        parallel_for(count, grain, [&](std::size_t first, std::size_t last, std::size_t) {
+            for (std::size_t i = first; i < last; ++i) {
+                x[i] *= alpha;
+            }
+        });
+    }
+
+    template <typename T>
+    T blas_dot(std::size_t count, const T* x, const T* y, std::size_t grain = default_grain) {
+        return blas_reduce(count, grain, T{ 0 }, [&](std::size_t first, std::size_t last) {
+            std::array<T, blas_lanes> lanes{};
+            std::size_t i = first;
+            for (; i + blas_lanes <= last; i += blas_lanes) {
+                for (std::size_t l = 0; l < blas_lanes; ++l) {
+                    lanes[l] += x[i + l] * y[i + l];
+                }
+            }
+            for (; i < last; ++i) {
+                lanes[0] += x[i] * y[i];
+            }
+            return blas_lane_sum(lanes);
+        }, [](T a, T b) { return a + b; });
+    }
+
+    template <typename T>
+    T blas_asum(std::size_t count, const T* x, std::size_t grain = default_grain) {
+        return blas_reduce(count, grain, T{ 0 }, [&](std::size_t first, std::size_t last) {
+            std::array<T, blas_lanes> lanes{};
+            std::size_t i = first;
+            for (; i + blas_lanes <= last; i += blas_lanes) {
+                for (std::size_t l = 0; l < blas_lanes; ++l) {
+                    lanes[l] += std::abs(x[i + l]);
+                }
+            }
+            for (; i < last; ++i) {
+                lanes[0] += std::abs(x[i]);
+            }
+            return blas_lane_sum(lanes);
+        }, [](T a, T b) { return a + b; });
+    }
+
+    template <typename T>
+    T blas_amax(std::size_t first, std::size_t last, const T* x) {
+        std::array<T, blas_lanes> lanes{};
+        std::size_t i = first;
+        for (; i + blas_lanes <= last; i += blas_lanes) {
+            for (std::size_t l = 0; l < blas_lanes; ++l) {
+                const T value = std::abs(x[i + l]);
+                lanes[l] = value > lanes[l] ? value : lanes[l];
+            }
+        }
+        for (; i < last; ++i) {
+            const T value = std::abs(x[i]);
+            lanes[0] = value > lanes[0] ? value : lanes[0];
+        }
+        return *std::max_element(lanes.begin(), lanes.end());
+    }
+
+    /*
+        Sums the squares in a single pass, which is exact enough unless the
+        sum overflows or falls below the normal range, in which case the sum
+        is taken again with every element scaled by the largest |x[i]|.
+    */
+    template <typename T>
+    T blas_nrm2(std::size_t count, const T* x, std::size_t grain = default_grain) {
+        const T squares = blas_dot(count, x, x, grain);
+        const T tiny    = std::numeric_limits<T>::min() / std::numeric_limits<T>::epsilon();
+        if (!std::isinf(squares) && !(squares < tiny)) {
+            return std::sqrt(squares);
+        }
+        const T scale = blas_reduce(count, grain, T{ 0 }, [&](std::size_t first, std::size_t last) {
+            return blas_amax(first, last, x);
+        }, [](T a, T b) { return std::max(a, b); });
+        if (scale == T{ 0 } || std::isinf(scale)) {
+            return scale;
+        }
+        const T inverse = T{ 1 } / scale;
+        const T scaled  = blas_reduce(count, grain, T{ 0 }, [&](std::size_t first, std::size_t last) {
+            std::array<T, blas_lanes> lanes{};
+            std::size_t i = first;
+            for (; i + blas_lanes <= last; i += blas_lanes) {
+                for (std::size_t l = 0; l < blas_lanes; ++l) {
+                    const T value = x[i + l] * inverse;
+                    lanes[l] += value * value;
+                }
+            }
+            for (; i < last; ++i) {
+                const T value = x[i] * inverse;
+                lanes[0] += value * value;
+            }
+            return blas_lane_sum(lanes);
+        }, [](T a, T b) { return a + b; });
+        return scale * std::sqrt(scaled);
+    }
+
+    /*
+        Each block is scanned one tile at a time.  The largest |x[i]| of a tile
+        is a vectorized max, and only a tile which beats the best so far is
+        searched again, (from cache), for the index.  NaNs are ignored, and an
+        empty sequence gives 0.
+    */
+    template <typename T>
+    std::size_t blas_iamax(std::size_t count, const T* x, std::size_t grain = default_grain) {
+        struct Best {
+            T           value;
+            std::size_t index;
+        };
+        const auto best = blas_reduce(count, grain, Best{ T{ -1 }, 0 }, [&](std::size_t first, std::size_t last) {
+            Best best{ T{ -1 }, first };
+            for (auto at = first; at < last; at += blas_tile) {
+                const auto end = std::min(at + blas_tile, last);
+                const T    max = blas_amax(at, end, x);
+                if (max > best.value) {
+                    auto i = at;
+                    while (i + 1 < end && !(std::abs(x[i]) == max)) {
+                        ++i;
+                    }
+                    best = Best{ max, i };
+                }
+            }
+            return best;
+        }, [](const Best& a, const Best& b) { return b.value > a.value ? b : a; });
+        return best.index;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                    Sequence Functions
+    //
+    //          'x' and 'y' are contiguous sequences, (with data() and size()), of
+    //          the same floating point type.  axpy and dot use the shorter of the
+    //          two sizes.
+    //
+    /*****************************************************************************************/
+
+    template <typename T, typename SeqX, typename SeqY>
+    void axpy(T alpha, const SeqX& x, SeqY& y, std::size_t grain = default_grain) {
+        blas_axpy(std::min(x.size(), y.size()), static_cast<typename SeqY::value_type>(alpha), x.data(), y.data(), grain);
+    }
+
+    template <typename T, typename Seq>
+    void scal(T alpha, Seq& x, std::size_t grain = default_grain) {
+        blas_scal(x.size(), static_cast<typename Seq::value_type>(alpha), x.data(), grain);
+    }
+
+    template <typename SeqX, typename SeqY>
+    auto dot(const SeqX& x, const SeqY& y, std::size_t grain = default_grain) -> SeqX::value_type {
+        return blas_dot(std::min(x.size(), y.size()), x.data(), y.data(), grain);
+    }
+
+    template <typename Seq>
+    auto nrm2(const Seq& x, std::size_t grain = default_grain) -> Seq::value_type {
+        return blas_nrm2(x.size(), x.data(), grain);
+    }
+
+    template <typename Seq>
+    auto asum(const Seq& x, std::size_t grain = default_grain) -> Seq::value_type {
+        return blas_asum(x.size(), x.data(), grain);
+    }
+
+    template <typename Seq>
+    std::size_t iamax(const Seq& x, std::size_t grain = default_grain) {
+        return blas_iamax(x.size(), x.data(), grain);
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                    Pattern Matching
+    //
+    /*****************************************************************************************/
+
+    /*
+        'scalar(a) * x' or 'x * scalar(a)', where 'a' is a T.
+    */
+    template <typename T, typename Expr>
+    struct is_scaled_product : std::false_type {};
+
+    template <typename T, typename LeftExpr, typename RightExpr>
+    struct is_scaled_product<T, ExprTemplate<LeftExpr, Mul_Op<T>, RightExpr>> {
+        static constexpr bool value = std::is_same_v<std::remove_cvref_t<LeftExpr>, Scalar<T>> != std::is_same_v<std::remove_cvref_t<RightExpr>, Scalar<T>>;
+    };
+
+    template <typename T, typename Seq>
+    concept ContiguousOperand = requires(const Seq& seq) {
+        { seq.data() } -> std::same_as<const T*>;
+        { seq.size() } -> std::convertible_to<std::size_t>;
+    };
+
+    template <typename T>
+    struct ScaledOperand {
+        T           scale = T{ 0 };
+        const T*    data  = nullptr;
+        std::size_t size  = 0;
+    };
+
+    /*
+        Matches 'scalar(a) * x' or 'x * scalar(a)', where 'a' is a T and 'x' is a
+        contiguous sequence of T.  Otherwise the data pointer is null.
+    */
+    template <typename T, typename Expr>
+    auto match_scaled(const Expr& expr) -> ScaledOperand<T> {
+        if constexpr (is_scaled_product<T, Expr>::value) {
+            using Left  = std::remove_cvref_t<decltype(expr.left_expr())>;
+            using Right = std::remove_cvref_t<decltype(expr.right_expr())>;
+            if constexpr (std::is_same_v<Left, Scalar<T>> && ContiguousOperand<T, Right>) {
+                return ScaledOperand<T>{ expr.left_expr().value(), expr.right_expr().data(), expr.right_expr().size() };
+            }
+            else if constexpr (std::is_same_v<Right, Scalar<T>> && ContiguousOperand<T, Left>) {
+                return ScaledOperand<T>{ expr.right_expr().value(), expr.left_expr().data(), expr.left_expr().size() };
+            }
+        }
+        return ScaledOperand<T>{};
+    }
+
+    /*****************************************************************************************/
+    //
+    //                              SeqContainer Compound Assignment
+    //
+    /*****************************************************************************************/
+
+    template <typename T, typename Expr> requires BlasValue<T> && is_scaled_product<T, Expr>::value
+    struct CompoundAssign<Add_Op<T>, T, Expr> {
+        static bool apply(T* y, std::size_t size, const Expr& re) {
+            const auto x = match_scaled<T>(re);
+            if (x.data == nullptr || x.size != size) {
+                return false;
+            }
+            blas_axpy(size, x.scale, x.data, y);
+            return true;
+        }
+    };
+
+    template <typename T, typename Expr> requires BlasValue<T> && is_scaled_product<T, Expr>::value
+    struct CompoundAssign<Sub_Op<T>, T, Expr> {
+        static bool apply(T* y, std::size_t size, const Expr& re) {
+            const auto x = match_scaled<T>(re);
+            if (x.data == nullptr || x.size != size) {
+                return false;
+            }
+            blas_axpy(size, -x.scale, x.data, y);
+            return true;
+        }
+    };
+
+    template <typename T> requires BlasValue<T>
+    struct CompoundAssign<Mul_Op<T>, T, Scalar<T>> {
+        static bool apply(T* x, std::size_t size, const Scalar<T>& re) {
+            blas_scal(size, re.value(), x);
+            return true;
+        }
+    };
+}
@@ -0,0 +1,411 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                   'BufferPool' class
+    //
+    //          The BufferPool caches released buffers by size class so that repeated
+    //          evaluation of same sized expressions reuses memory which is already
+    //          mapped and warm, instead of returning it to the system allocator.
+    //
+    //          Size classes are the powers of two from 64 bytes upwards, and every
+    //          buffer is aligned to a cache line.  Each thread owns a small cache
+    //          which is consulted first and needs no locking.  When a thread cache
+    //          is full, buffers spill into a shared cache guarded by a mutex, and
+    //          when that is full they are released to the system.  When a thread
+    //          exits its cache is handed to the shared cache.
+    //
+    //          Both caches hold at most a fixed number of bytes.  trim() empties the
+    //          shared cache and the cache of the calling thread only: the cache of
+    //          another thread is emptied only when that thread calls trim() or
+    //          trim_thread_cache(), or handed to the shared cache when it exits.
+    //
+    /********************************************************************************************/
+
+    class BufferPool {
+
+    public:
+        static constexpr std::size_t alignment       = 64;
+        static constexpr std::size_t min_class_bytes = 64;
+        static constexpr std::size_t class_count     = 48;
+
+        static BufferPool& shared();
+
+        BufferPool();
+        ~BufferPool();
+
+        BufferPool(BufferPool&&)                  = delete;
+        BufferPool(const BufferPool&)             = delete;
+        BufferPool& operator =(BufferPool&&)      = delete;
+        BufferPool& operator =(const BufferPool&) = delete;
+
+        void*   allocate(std::size_t bytes);
+        void  deallocate(void* buffer, std::size_t bytes) noexcept;
+
+        void trim() noexcept;
+        void trim_thread_cache() noexcept;
+
+        void   set_shared_limit(std::size_t bytes) noexcept;
+        void   set_thread_limit(std::size_t bytes) noexcept;
+        std::size_t shared_bytes() const noexcept;
+
+        static std::size_t size_class(std::size_t bytes) noexcept;
+        static std::size_t class_bytes(std::size_t size_class) noexcept;
+
+    private:
+        using free_list = std::vector<void*>;
+
+        class ThreadCache;
+
+        mutable std::mutex                   _mutex;
+        std::array<free_list, class_count>   _lists;
+        std::size_t                          _bytes;
+        std::size_t                          _shared_limit;
+        std::atomic<std::size_t>             _thread_limit;
+
+        ThreadCache* thread_cache() noexcept;
+
+        bool  give(std::size_t size_class, void* buffer) noexcept;
+        void* take(std::size_t size_class) noexcept;
+
+        static void* system_allocate(std::size_t size_class);
+        static void  system_release(std::size_t size_class, void* buffer) noexcept;
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                  'ThreadCache' class
+    //
+    //          The per thread cache of a BufferPool.  The 'alive' flag guards against
+    //          buffers being released by static objects after the thread cache has
+    //          already been destroyed.
+    //
+    /*****************************************************************************************/
+
+    class BufferPool::ThreadCache {
+
+    public:
+        ThreadCache(BufferPool& pool) : _pool(pool), _lists(), _bytes(0) {
+            alive() = true;
+        }
+
+        ~ThreadCache() {
+            alive() = false;
+            for (std::size_t c = 0; c < class_count; ++c) {
+                for (void* buffer : _lists[c]) {
+                    if (!_pool.give(c, buffer)) {
+                        system_release(c, buffer);
+                    }
+                }
+            }
+        }
+
+        static bool& alive() noexcept {
+            thread_local bool is_alive = false;
+            return is_alive;
+        }
+
+        void* take(std::size_t size_class) noexcept {
+            auto& list = _lists[size_class];
+            if (list.empty()) {
+                return nullptr;
+            }
+            void* buffer = list.back();
+            list.pop_back();
+            _bytes -= class_bytes(size_class);
+            return buffer;
+        }
+
+        bool give(std::size_t size_class, void* buffer) noexcept {
+            const auto bytes = class_bytes(size_class);
+            if (_bytes + bytes > _pool._thread_limit.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            try {
+                _lists[size_class].push_back(buffer);
+            }
+            catch (...) {
+                return false;
+            }
+            _bytes += bytes;
+            return true;
+        }
+
+        void trim() noexcept {
+            for (std::size_t c = 0; c < class_count; ++c) {
+                for (void* buffer : _lists[c]) {
+                    system_release(c, buffer);
+                }
+                _lists[c] = free_list{};
+            }
+            _bytes = 0;
+        }
+
+    private:
+        BufferPool&                        _pool;
+        std::array<free_list, class_count> _lists;
+        std::size_t                        _bytes;
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                 Construction & Access
+    //
+    /*****************************************************************************************/
+
+    /*
+        The shared pool is intentionally never destroyed, so that containers with
+        static storage duration may still release their buffers during exit.
+    */
+    inline BufferPool& BufferPool::shared() {
+        static BufferPool* pool = new BufferPool();
+        return *pool;
+    }
+
+    inline BufferPool::BufferPool() : _mutex(), _lists(), _bytes(0), _shared_limit(std::size_t{ 1 } << 30), _thread_limit(std::size_t{ 1 } << 28) {
+    }
+
+    inline BufferPool::~BufferPool() {
+        trim();
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                Allocation & Release
+    //
+    /*****************************************************************************************/
+
+    inline void* BufferPool::allocate(std::size_t bytes) {
+        const auto c = size_class(bytes);
+        if (c >= class_count) {
+            throw std::bad_alloc();
+        }
+        if (auto cache = thread_cache()) {
+            if (void* buffer = cache->take(c)) {
+                return buffer;
+            }
+        }
+        if (void* buffer = take(c)) {
+            return buffer;
+        }
+        return system_allocate(c);
+    }
+
+    inline void BufferPool::deallocate(void* buffer, std::size_t bytes) noexcept {
+        if (buffer == nullptr) {
+            return;
+        }
+        const auto c = size_class(bytes);
+        if (auto cache = thread_cache()) {
+            if (cache->give(c, buffer)) {
+                return;
+            }
+        }
+        if (!give(c, buffer)) {
+            system_release(c, buffer);
+        }
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                 Trimming & Limits
+    //
+    /*****************************************************************************************/
+
+    inline void BufferPool::trim() noexcept {
+        trim_thread_cache();
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (std::size_t c = 0; c < class_count; ++c) {
+            for (void* buffer : _lists[c]) {
+                system_release(c, buffer);
+            }
+            _lists[c] = free_list{};
+        }
+        _bytes = 0;
+    }
+
+    inline void BufferPool::trim_thread_cache() noexcept {
+        if (auto cache = thread_cache()) {
+            cache->trim();
+        }
+    }
+
+    inline void BufferPool::set_shared_limit(std::size_t bytes) noexcept {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _shared_limit = bytes;
+    }
+
+    inline void BufferPool::set_thread_limit(std::size_t bytes) noexcept {
+        _thread_limit.store(bytes, std::memory_order_relaxed);
+    }
+
+    inline std::size_t BufferPool::shared_bytes() const noexcept {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _bytes;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                    Size Classes
+    //
+    /*****************************************************************************************/
+
+    inline std::size_t BufferPool::size_class(std::size_t bytes) noexcept {
+        if (bytes <= min_class_bytes) {
+            return 0;
+        }
+        if (bytes > (std::numeric_limits<std::size_t>::max() >> 1)) {
+            return class_count;
+        }
+        return std::bit_width(bytes - 1) - std::bit_width(min_class_bytes - 1);
+    }
+
+    inline std::size_t BufferPool::class_bytes(std::size_t size_class) noexcept {
+        return min_class_bytes << size_class;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                     Private Methods
+    //
+    /*****************************************************************************************/
+
+    /*
+        Only the shared pool owns thread caches.  Any other pool, and a thread
+        whose cache has already been destroyed, goes straight to the shared lists.
+    */
+    inline BufferPool::ThreadCache* BufferPool::thread_cache() noexcept {
+        if (this != &shared()) {
+            return nullptr;
+        }
+        if (!ThreadCache::alive()) {
+            thread_local bool constructed = false;
+            if (constructed) {
+                return nullptr;
+            }
+            constructed = true;
+        }
+        thread_local ThreadCache cache(*this);
+        return &cache;
+    }
+
+    inline bool BufferPool::give(std::size_t size_class, void* buffer) noexcept {
+        const auto bytes = class_bytes(size_class);
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_bytes + bytes > _shared_limit) {
+            return false;
+        }
+        try {
+            _lists[size_class].push_back(buffer);
+        }
+        catch (...) {
+            return false;
+        }
+        _bytes += bytes;
+        return true;
+    }
+
+    inline void* BufferPool::take(std::size_t size_class) noexcept {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto& list = _lists[size_class];
+        if (list.empty()) {
+            return nullptr;
+        }
+        void* buffer = list.back();
+        list.pop_back();
+        _bytes -= class_bytes(size_class);
+        return buffer;
+    }
+
+    inline void* BufferPool::system_allocate(std::size_t size_class) {
+        return ::operator new(class_bytes(size_class), std::align_val_t{ alignment });
+    }
+
+    inline void BufferPool::system_release(std::size_t size_class, void* buffer) noexcept {
+        ::operator delete(buffer, class_bytes(size_class), std::align_val_t{ alignment });
+    }
+
+    /********************************************************************************************/
+    //
+    //                                  'PoolAllocator' class
+    //
+    //          A stateless allocator drawing from the shared BufferPool, which allows
+    //          the pool to be used as the allocator of the IMPL of a SeqContainer.
+    //
+    /********************************************************************************************/
+
+    template <typename T>
+    class PoolAllocator {
+
+    public:
+        using value_type      = T;
+        using size_type       = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        using is_always_equal                        = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+
+        constexpr PoolAllocator() noexcept = default;
+
+        template <typename U>
+        constexpr PoolAllocator(const PoolAllocator<U>&) noexcept {
+        }
+
+        T* allocate(std::size_t n) {
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+                throw std::bad_array_new_length();
+            }
+            return static_cast<T*>(BufferPool::shared().allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* buffer, std::size_t n) noexcept {
+            BufferPool::shared().deallocate(buffer, n * sizeof(T));
+        }
+
+        template <typename U>
+        constexpr bool operator ==(const PoolAllocator<U>&) const noexcept {
+            return true;
+        }
+    };
+
+    template <typename VALUE = intmax_t>
+    using PooledSeqContainer = SeqContainer<VALUE, std::vector<VALUE, PoolAllocator<VALUE>>>;
+}
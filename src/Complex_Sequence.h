@@ -0,0 +1,760 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <iostream>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Parallel.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                 'ComplexSequence' class
+    //
+    //          A sequence of complex numbers stored as two planes, a SeqContainer of
+    //          the real parts and one of the imaginary parts, rather than as
+    //          interleaved std::complex pairs.  The planes are read and written with
+    //          plain loads and stores, so an element wise expression of complex
+    //          sequences is a loop over independent lanes of T, free of the shuffles
+    //          interleaved storage needs, and of the NaN recovery of std::complex
+    //          multiplication.
+    //
+    //          Complex sequences and complex expressions combine with the usual
+    //          operators, and conj() conjugates an operand.  The right operand may
+    //          also be a real SeqContainer, (whose imaginary part is zero), or a
+    //          scalar, (std::complex<T> or T), and a scalar may be the left operand:
+    //
+    //              ComplexSequence<double> z = a * conj(b) + c * 0.5;
+    //              ComplexSequence<double> w = 1.0 / z + r;
+    //
+    //          A real SeqContainer cannot be the left operand, since its own
+    //          operators take any right operand.  Write z * r rather than r * z,
+    //          and build a ComplexSequence from r to divide by z.
+    //
+    //          A ComplexExpr holds sequences by reference and sub expressions and
+    //          scalars by value, so it must be evaluated within the full expression
+    //          it was built in.  Division is the textbook formula, without the range
+    //          scaling of std::complex.
+    //
+    /********************************************************************************************/
+
+    template <typename T>
+    struct ComplexValue {
+        T re;
+        T im;
+    };
+
+    template <typename T>
+    struct ComplexAdd_Op {
+        static ComplexValue<T> apply(const ComplexValue<T>& a, const ComplexValue<T>& b) {
+            return { a.re + b.re, a.im + b.im };
+        }
+    };
+
+    template <typename T>
+    struct ComplexSub_Op {
+        static ComplexValue<T> apply(const ComplexValue<T>& a, const ComplexValue<T>& b) {
+            return { a.re - b.re, a.im - b.im };
+        }
+    };
+
+    template <typename T>
+    struct ComplexMul_Op {
+        static ComplexValue<T> apply(const ComplexValue<T>& a, const ComplexValue<T>& b) {
+            return { a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re };
+        }
+    };
+
+    template <typename T>
+    struct ComplexDiv_Op {
+        static ComplexValue<T> apply(const ComplexValue<T>& a, const ComplexValue<T>& b) {
+            const T inverse = T{ 1 } / (b.re * b.re + b.im * b.im);
+            return { (a.re * b.re + a.im * b.im) * inverse, (a.im * b.re - a.re * b.im) * inverse };
+        }
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                       Readers
+    //
+    //          An expression is evaluated through a reader, a copy of its tree which
+    //          holds the planes of each sequence as raw pointers, (for contiguous
+    //          sequences), by value.  So the evaluation loop keeps every pointer in a
+    //          register, rather than reloading it through the SeqContainers on every
+    //          element.
+    //
+    /*****************************************************************************************/
+
+    template <typename T, typename RealReader, typename ImagReader>
+    struct ComplexPlaneReader {
+        RealReader re;
+        ImagReader im;
+
+        ComplexValue<T> element(std::size_t index) const {
+            return { re[index], im[index] };
+        }
+    };
+
+    template <typename T, typename RealReader>
+    struct ComplexRealReader {
+        RealReader re;
+
+        ComplexValue<T> element(std::size_t index) const {
+            return { re[index], T{ 0 } };
+        }
+    };
+
+    template <typename BinaryOp, typename LeftReader, typename RightReader>
+    struct ComplexBinaryReader {
+        LeftReader  left;
+        RightReader right;
+
+        auto element(std::size_t index) const {
+            return BinaryOp::apply(left.element(index), right.element(index));
+        }
+    };
+
+    template <typename Reader>
+    struct ComplexConjReader {
+        Reader reader;
+
+        auto element(std::size_t index) const {
+            auto z = reader.element(index);
+            z.im = -z.im;
+            return z;
+        }
+    };
+
+    /*
+        Writes the elements [first, last) of a reader to the planes.  The reader
+        is taken by value, so its pointers are local to the loop.
+    */
+    template <typename Reader, typename T>
+    void complex_fill(const Reader in, T* re, T* im, std::size_t first, std::size_t last) {
+        for (auto i = first; i < last; ++i) {
+            const ComplexValue<T> z = in.element(i);
+            re[i] = z.re;
+            im[i] = z.im;
+        }
+    }
+
+    template <typename T, typename IMPL>
+    class ComplexSequence;
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    class ComplexExpr;
+
+    template <typename Expr>
+    class ComplexConj;
+
+    template <typename T>
+    class ComplexScalar;
+
+    template <typename Seq>
+    class ComplexReal;
+
+    template <typename Expr>
+    struct is_complex_expr : std::false_type {};
+
+    template <typename T, typename IMPL>
+    struct is_complex_expr<ComplexSequence<T, IMPL>> : std::true_type {};
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    struct is_complex_expr<ComplexExpr<LeftExpr, BinaryOp, RightExpr>> : std::true_type {};
+
+    template <typename Expr>
+    struct is_complex_expr<ComplexConj<Expr>> : std::true_type {};
+
+    template <typename T>
+    struct is_complex_expr<ComplexScalar<T>> : std::true_type {};
+
+    template <typename Seq>
+    struct is_complex_expr<ComplexReal<Seq>> : std::true_type {};
+
+    /*****************************************************************************************/
+    //
+    //                                       Operands
+    //
+    //          Every operand provides value_type, (the real type T), size(), and
+    //          reader(), whose element(i) returns the ComplexValue at index i.  A
+    //          scalar has a size of zero, and every other operand of an expression
+    //          must have the size of the expression.
+    //
+    /*****************************************************************************************/
+
+    template <typename T>
+    class ComplexScalar {
+
+    public:
+        using value_type = T;
+
+        explicit ComplexScalar(std::complex<T> value) : _value{ value.real(), value.imag() } {
+        }
+
+        std::size_t size() const noexcept {
+            return 0;
+        }
+
+        bool sized(std::size_t) const noexcept {
+            return true;
+        }
+
+        ComplexValue<T> element(std::size_t) const noexcept {
+            return _value;
+        }
+
+        ComplexScalar reader() const noexcept {
+            return *this;
+        }
+
+    private:
+        ComplexValue<T> _value;
+    };
+
+    template <typename Seq>
+    class ComplexReal {
+
+    public:
+        using value_type = Seq::value_type;
+
+        explicit ComplexReal(const Seq& seq) : _seq(seq) {
+        }
+
+        std::size_t size() const {
+            return _seq.size();
+        }
+
+        bool sized(std::size_t count) const {
+            return _seq.size() == count;
+        }
+
+        auto reader() const {
+            return ComplexRealReader<value_type, decltype(element_reader(_seq))>{ element_reader(_seq) };
+        }
+
+    private:
+        const Seq& _seq;
+    };
+
+    /*
+        Returns the form in which an operand is held by a ComplexExpr: a
+        reference to a ComplexSequence, a real SeqContainer as a ComplexReal,
+        a scalar as a ComplexScalar of T, and any other expression by value.
+    */
+    template <typename T, typename Expr>
+    decltype(auto) complex_operand(const Expr& expr) {
+        if constexpr (is_seq_container<Expr>::value) {
+            return ComplexReal<Expr>(expr);
+        }
+        else if constexpr (is_complex_expr<Expr>::value) {
+            if constexpr (requires { expr.real(); }) {
+                return static_cast<const Expr&>(expr);
+            }
+            else {
+                return Expr(expr);
+            }
+        }
+        else {
+            return ComplexScalar<T>(std::complex<T>(expr));
+        }
+    }
+
+    template <typename T, typename Expr>
+    using complex_operand_t = decltype(complex_operand<T>(std::declval<const Expr&>()));
+
+    /*****************************************************************************************/
+    //
+    //                                  'ComplexExpr' class
+    //
+    /*****************************************************************************************/
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    class ComplexExpr {
+
+    public:
+        using value_type = std::remove_cvref_t<LeftExpr>::value_type;
+
+        ComplexExpr(LeftExpr l, RightExpr r) : _left_expr(std::forward<LeftExpr>(l)), _right_expr(std::forward<RightExpr>(r)) {
+        }
+
+        std::size_t size() const {
+            return std::max(_left_expr.size(), _right_expr.size());
+        }
+
+        bool sized(std::size_t count) const {
+            return _left_expr.sized(count) && _right_expr.sized(count);
+        }
+
+        auto reader() const {
+            auto left  = _left_expr.reader();
+            auto right = _right_expr.reader();
+            return ComplexBinaryReader<BinaryOp, decltype(left), decltype(right)>{ left, right };
+        }
+
+        std::complex<value_type> operator [](std::size_t index) const {
+            const auto z = reader().element(index);
+            return { z.re, z.im };
+        }
+
+        template <typename RE> auto operator +(const RE& re) const -> ComplexExpr<ComplexExpr, ComplexAdd_Op<value_type>, complex_operand_t<value_type, RE>>;
+        template <typename RE> auto operator -(const RE& re) const -> ComplexExpr<ComplexExpr, ComplexSub_Op<value_type>, complex_operand_t<value_type, RE>>;
+        template <typename RE> auto operator *(const RE& re) const -> ComplexExpr<ComplexExpr, ComplexMul_Op<value_type>, complex_operand_t<value_type, RE>>;
+        template <typename RE> auto operator /(const RE& re) const -> ComplexExpr<ComplexExpr, ComplexDiv_Op<value_type>, complex_operand_t<value_type, RE>>;
+
+    private:
+        LeftExpr  _left_expr;
+        RightExpr _right_expr;
+    };
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    template <typename RE>
+    inline auto ComplexExpr<LeftExpr, BinaryOp, RightExpr>::operator +(const RE& re) const -> ComplexExpr<ComplexExpr, ComplexAdd_Op<value_type>, complex_operand_t<value_type, RE>> {
+        return ComplexExpr<ComplexExpr, ComplexAdd_Op<value_type>, complex_operand_t<value_type, RE>>(ComplexExpr(*this), complex_operand<value_type>(re));
+    }
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    template <typename RE>
+    inline auto ComplexExpr<LeftExpr, BinaryOp, RightExpr>::operator -(const RE& re) const -> ComplexExpr<ComplexExpr, ComplexSub_Op<value_type>, complex_operand_t<value_type, RE>> {
+        return ComplexExpr<ComplexExpr, ComplexSub_Op<value_type>, complex_operand_t<value_type, RE>>(ComplexExpr(*this), complex_operand<value_type>(re));
+    }
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    template <typename RE>
+    inline auto ComplexExpr<LeftExpr, BinaryOp, RightExpr>::operator *(const RE& re) const -> ComplexExpr<ComplexExpr, ComplexMul_Op<value_type>, complex_operand_t<value_type, RE>> {
+        return ComplexExpr<ComplexExpr, ComplexMul_Op<value_type>, complex_operand_t<value_type, RE>>(ComplexExpr(*this), complex_operand<value_type>(re));
+    }
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    template <typename RE>
+    inline auto ComplexExpr<LeftExpr, BinaryOp, RightExpr>::operator /(const RE& re) const -> ComplexExpr<ComplexExpr, ComplexDiv_Op<value_type>, complex_operand_t<value_type, RE>> {
+        return ComplexExpr<ComplexExpr, ComplexDiv_Op<value_type>, complex_operand_t<value_type, RE>>(ComplexExpr(*this), complex_operand<value_type>(re));
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                  'ComplexConj' class
+    //
+    /*****************************************************************************************/
+
+    template <typename Expr>
+    class ComplexConj {
+
+    public:
+        using value_type = std::remove_cvref_t<Expr>::value_type;
+
+        explicit ComplexConj(Expr expr) : _expr(std::forward<Expr>(expr)) {
+        }
+
+        std::size_t size() const {
+            return _expr.size();
+        }
+
+        bool sized(std::size_t count) const {
+            return _expr.sized(count);
+        }
+
+        auto reader() const {
+            auto inner = _expr.reader();
+            return ComplexConjReader<decltype(inner)>{ inner };
+        }
+
+        template <typename RE> auto operator +(const RE& re) const -> ComplexExpr<ComplexConj, ComplexAdd_Op<value_type>, complex_operand_t<value_type, RE>> {
+            return ComplexExpr<ComplexConj, ComplexAdd_Op<value_type>, complex_operand_t<value_type, RE>>(ComplexConj(*this), complex_operand<value_type>(re));
+        }
+
+        template <typename RE> auto operator -(const RE& re) const -> ComplexExpr<ComplexConj, ComplexSub_Op<value_type>, complex_operand_t<value_type, RE>> {
+            return ComplexExpr<ComplexConj, ComplexSub_Op<value_type>, complex_operand_t<value_type, RE>>(ComplexConj(*this), complex_operand<value_type>(re));
+        }
+
+        template <typename RE> auto operator *(const RE& re) const -> ComplexExpr<ComplexConj, ComplexMul_Op<value_type>, complex_operand_t<value_type, RE>> {
+            return ComplexExpr<ComplexConj, ComplexMul_Op<value_type>, complex_operand_t<value_type, RE>>(ComplexConj(*this), complex_operand<value_type>(re));
+        }
+
+        template <typename RE> auto operator /(const RE& re) const -> ComplexExpr<ComplexConj, ComplexDiv_Op<value_type>, complex_operand_t<value_type, RE>> {
+            return ComplexExpr<ComplexConj, ComplexDiv_Op<value_type>, complex_operand_t<value_type, RE>>(ComplexConj(*this), complex_operand<value_type>(re));
+        }
+
+    private:
+        Expr _expr;
+    };
+
+    template <typename Expr> requires is_complex_expr<Expr>::value
+    auto conj(const Expr& expr) -> ComplexConj<complex_operand_t<typename Expr::value_type, Expr>> {
+        return ComplexConj<complex_operand_t<typename Expr::value_type, Expr>>(complex_operand<typename Expr::value_type>(expr));
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                'ComplexSequence' class
+    //
+    /*****************************************************************************************/
+
+    template <typename T = double, typename IMPL = std::vector<T>>
+    class ComplexSequence {
+
+    public:
+        using value_type    = T;
+        using sequence_type = SeqContainer<T, IMPL>;
+
+        ComplexSequence();
+        explicit ComplexSequence(std::size_t size, std::complex<T> value = {});
+        ComplexSequence(sequence_type real, sequence_type imag);
+
+        template <typename Expr> requires is_complex_expr<Expr>::value
+        ComplexSequence(const Expr& expr);
+
+        ComplexSequence(ComplexSequence&&)                  noexcept = default;
+        ComplexSequence(const ComplexSequence&)                      = default;
+        ComplexSequence& operator =(ComplexSequence&&)      noexcept = default;
+        ComplexSequence& operator =(const ComplexSequence&)          = default;
+
+        template <typename Expr> requires is_complex_expr<Expr>::value
+        ComplexSequence& operator =(const Expr& expr);
+
+        template <typename RE> ComplexSequence& operator +=(const RE& re);
+        template <typename RE> ComplexSequence& operator -=(const RE& re);
+        template <typename RE> ComplexSequence& operator *=(const RE& re);
+        template <typename RE> ComplexSequence& operator /=(const RE& re);
+
+        template <typename SEQ_IMPL>
+        static ComplexSequence from_interleaved(const SeqContainer<std::complex<T>, SEQ_IMPL>& seq);
+        SeqContainer<std::complex<T>> to_interleaved() const;
+
+        std::size_t      size() const;
+        bool             sized(std::size_t count) const;
+        ComplexSequence& resize(std::size_t size);
+
+        sequence_type&       real() noexcept;
+        const sequence_type& real() const noexcept;
+        sequence_type&       imag() noexcept;
+        const sequence_type& imag() const noexcept;
+
+        std::complex<T> operator [](std::size_t index) const;
+        ComplexSequence& set(std::size_t index, std::complex<T> value);
+
+        auto reader() const;
+
+        template <typename RE> auto operator +(const RE& re) const& -> ComplexExpr<const ComplexSequence&, ComplexAdd_Op<T>, complex_operand_t<T, RE>>;
+        template <typename RE> auto operator -(const RE& re) const& -> ComplexExpr<const ComplexSequence&, ComplexSub_Op<T>, complex_operand_t<T, RE>>;
+        template <typename RE> auto operator *(const RE& re) const& -> ComplexExpr<const ComplexSequence&, ComplexMul_Op<T>, complex_operand_t<T, RE>>;
+        template <typename RE> auto operator /(const RE& re) const& -> ComplexExpr<const ComplexSequence&, ComplexDiv_Op<T>, complex_operand_t<T, RE>>;
+
+    private:
+        sequence_type _real;
+        sequence_type _imag;
+
+        template <typename Func>
+        void fill_planes(std::size_t count, Func&& func);
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                     Construction
+    //
+    /*****************************************************************************************/
+
+    template <typename T, typename IMPL>
+    inline ComplexSequence<T, IMPL>::ComplexSequence() : _real(), _imag() {
+    }
+
+    template <typename T, typename IMPL>
+    inline ComplexSequence<T, IMPL>::ComplexSequence(std::size_t size, std::complex<T> value) : _real(), _imag() {
+        _real.resize(size, value.real());
+        _imag.resize(size, value.imag());
+    }
+
+    /*
+        The shorter plane is padded with zeros to the length of the longer.
+    */
+    template <typename T, typename IMPL>
+    inline ComplexSequence<T, IMPL>::ComplexSequence(sequence_type real, sequence_type imag) : _real(std::move(real)), _imag(std::move(imag)) {
+        const auto size = std::max(_real.size(), _imag.size());
+        _real.resize(size);
+        _imag.resize(size);
+    }
+
+    template <typename T, typename IMPL>
+    template <typename Expr> requires is_complex_expr<Expr>::value
+    inline ComplexSequence<T, IMPL>::ComplexSequence(const Expr& expr) : _real(), _imag() {
+        *this = expr;
+    }
+
+    template <typename T, typename IMPL>
+    template <typename SEQ_IMPL>
+    inline ComplexSequence<T, IMPL> ComplexSequence<T, IMPL>::from_interleaved(const SeqContainer<std::complex<T>, SEQ_IMPL>& seq) {
+        ComplexSequence result(seq.size());
+        const auto& in = seq.impl();
+        auto& re = result._real.impl();
+        auto& im = result._imag.impl();
+        for (std::size_t i = 0; i < seq.size(); ++i) {
+            re[i] = in[i].real();
+            im[i] = in[i].imag();
+        }
+        return result;
+    }
+
+    template <typename T, typename IMPL>
+    inline SeqContainer<std::complex<T>> ComplexSequence<T, IMPL>::to_interleaved() const {
+        SeqContainer<std::complex<T>> result;
+        result.resize(size());
+        auto& out = result.impl();
+        for (std::size_t i = 0; i < size(); ++i) {
+            out[i] = std::complex<T>(_real.impl()[i], _imag.impl()[i]);
+        }
+        return result;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                      Assignment
+    //
+    //          The destination is resized to the size of the expression, and the
+    //          planes are written in blocks run in parallel.  Index i of the result
+    //          only reads index i of each operand, so the destination may itself
+    //          be an operand.  An operand of another size, (other than a scalar),
+    //          throws std::invalid_argument.
+    //
+    /*****************************************************************************************/
+
+    template <typename T, typename IMPL>
+    template <typename Expr> requires is_complex_expr<Expr>::value
+    inline ComplexSequence<T, IMPL>& ComplexSequence<T, IMPL>::operator =(const Expr& expr) {
+        const auto count = expr.size();
+        if (!expr.sized(count)) {
+            throw std::invalid_argument("ComplexSequence: the operands of the expression differ in size");
+        }
+        if (size() != count) {
+            resize(count);
+        }
+        const auto reader = expr.reader();
+        fill_planes(count, [&](T* re, T* im, std::size_t first, std::size_t last) {
+            complex_fill(reader, re, im, first, last);
+        });
+        return *this;
+    }
+
+    /*
+        Calls func(re, im, first, last) with pointers to the planes over blocks
+        of [0, count).  Planes which are not contiguous are written through
+        temporary buffers which are then copied into them.
+    */
+    template <typename T, typename IMPL>
+    template <typename Func>
+    inline void ComplexSequence<T, IMPL>::fill_planes(std::size_t count, Func&& func) {
+        if constexpr (std::ranges::contiguous_range<IMPL>) {
+            T* re = _real.data();
+            T* im = _imag.data();
+            parallel_for(count, default_grain, [&](std::size_t first, std::size_t last, std::size_t) {
+                func(re, im, first, last);
+            });
+        }
+        else {
+            std::vector<T> re(count);
+            std::vector<T> im(count);
+            func(re.data(), im.data(), 0, count);
+            for (std::size_t i = 0; i < count; ++i) {
+                _real.impl()[i] = re[i];
+                _imag.impl()[i] = im[i];
+            }
+        }
+    }
+
+    template <typename T, typename IMPL>
+    template <typename RE>
+    inline ComplexSequence<T, IMPL>& ComplexSequence<T, IMPL>::operator +=(const RE& re) {
+        return *this = *this + re;
+    }
+
+    template <typename T, typename IMPL>
+    template <typename RE>
+    inline ComplexSequence<T, IMPL>& ComplexSequence<T, IMPL>::operator -=(const RE& re) {
+        return *this = *this - re;
+    }
+
+    template <typename T, typename IMPL>
+    template <typename RE>
+    inline ComplexSequence<T, IMPL>& ComplexSequence<T, IMPL>::operator *=(const RE& re) {
+        return *this = *this * re;
+    }
+
+    template <typename T, typename IMPL>
+    template <typename RE>
+    inline ComplexSequence<T, IMPL>& ComplexSequence<T, IMPL>::operator /=(const RE& re) {
+        return *this = *this / re;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                       Access
+    //
+    /*****************************************************************************************/
+
+    template <typename T, typename IMPL>
+    inline std::size_t ComplexSequence<T, IMPL>::size() const {
+        return _real.size();
+    }
+
+    template <typename T, typename IMPL>
+    inline bool ComplexSequence<T, IMPL>::sized(std::size_t count) const {
+        return size() == count;
+    }
+
+    template <typename T, typename IMPL>
+    inline ComplexSequence<T, IMPL>& ComplexSequence<T, IMPL>::resize(std::size_t size) {
+        _real.resize(size);
+        _imag.resize(size);
+        return *this;
+    }
+
+    template <typename T, typename IMPL>
+    inline ComplexSequence<T, IMPL>::sequence_type& ComplexSequence<T, IMPL>::real() noexcept {
+        return _real;
+    }
+
+    template <typename T, typename IMPL>
+    inline const ComplexSequence<T, IMPL>::sequence_type& ComplexSequence<T, IMPL>::real() const noexcept {
+        return _real;
+    }
+
+    template <typename T, typename IMPL>
+    inline ComplexSequence<T, IMPL>::sequence_type& ComplexSequence<T, IMPL>::imag() noexcept {
+        return _imag;
+    }
+
+    template <typename T, typename IMPL>
+    inline const ComplexSequence<T, IMPL>::sequence_type& ComplexSequence<T, IMPL>::imag() const noexcept {
+        return _imag;
+    }
+
+    /*
+        Reads past the end as zero, as SeqContainer does.
+    */
+    template <typename T, typename IMPL>
+    inline std::complex<T> ComplexSequence<T, IMPL>::operator [](std::size_t index) const {
+        return { _real[index], _imag[index] };
+    }
+
+    template <typename T, typename IMPL>
+    inline ComplexSequence<T, IMPL>& ComplexSequence<T, IMPL>::set(std::size_t index, std::complex<T> value) {
+        if (index >= size()) {
+            resize(index + 1);
+        }
+        _real.impl()[index] = value.real();
+        _imag.impl()[index] = value.imag();
+        return *this;
+    }
+
+    template <typename T, typename IMPL>
+    inline auto ComplexSequence<T, IMPL>::reader() const {
+        return ComplexPlaneReader<T, decltype(element_reader(_real)), decltype(element_reader(_imag))>{ element_reader(_real), element_reader(_imag) };
+    }
+
+    /*****************************************************************************************/
+    //
+    //                               Element Wise Expressions
+    //
+    /*****************************************************************************************/
+
+    template <typename T, typename IMPL>
+    template <typename RE>
+    inline auto ComplexSequence<T, IMPL>::operator +(const RE& re) const& -> ComplexExpr<const ComplexSequence&, ComplexAdd_Op<T>, complex_operand_t<T, RE>> {
+        return ComplexExpr<const ComplexSequence&, ComplexAdd_Op<T>, complex_operand_t<T, RE>>(*this, complex_operand<T>(re));
+    }
+
+    template <typename T, typename IMPL>
+    template <typename RE>
+    inline auto ComplexSequence<T, IMPL>::operator -(const RE& re) const& -> ComplexExpr<const ComplexSequence&, ComplexSub_Op<T>, complex_operand_t<T, RE>> {
+        return ComplexExpr<const ComplexSequence&, ComplexSub_Op<T>, complex_operand_t<T, RE>>(*this, complex_operand<T>(re));
+    }
+
+    template <typename T, typename IMPL>
+    template <typename RE>
+    inline auto ComplexSequence<T, IMPL>::operator *(const RE& re) const& -> ComplexExpr<const ComplexSequence&, ComplexMul_Op<T>, complex_operand_t<T, RE>> {
+        return ComplexExpr<const ComplexSequence&, ComplexMul_Op<T>, complex_operand_t<T, RE>>(*this, complex_operand<T>(re));
+    }
+
+    template <typename T, typename IMPL>
+    template <typename RE>
+    inline auto ComplexSequence<T, IMPL>::operator /(const RE& re) const& -> ComplexExpr<const ComplexSequence&, ComplexDiv_Op<T>, complex_operand_t<T, RE>> {
+        return ComplexExpr<const ComplexSequence&, ComplexDiv_Op<T>, complex_operand_t<T, RE>>(*this, complex_operand<T>(re));
+    }
+
+    /*
+        A scalar, (T or std::complex<T>), on the left of a complex expression.
+    */
+    template <typename S, typename T>
+    concept ComplexScalarOperand = std::is_arithmetic_v<S> || std::is_same_v<S, std::complex<T>>;
+
+    template <typename S, typename Expr> requires is_complex_expr<Expr>::value && ComplexScalarOperand<S, typename Expr::value_type>
+    auto operator +(const S& s, const Expr& expr) -> ComplexExpr<ComplexScalar<typename Expr::value_type>, ComplexAdd_Op<typename Expr::value_type>, complex_operand_t<typename Expr::value_type, Expr>> {
+        using T = Expr::value_type;
+        return ComplexExpr<ComplexScalar<T>, ComplexAdd_Op<T>, complex_operand_t<T, Expr>>(complex_operand<T>(s), complex_operand<T>(expr));
+    }
+
+    template <typename S, typename Expr> requires is_complex_expr<Expr>::value && ComplexScalarOperand<S, typename Expr::value_type>
+    auto operator -(const S& s, const Expr& expr) -> ComplexExpr<ComplexScalar<typename Expr::value_type>, ComplexSub_Op<typename Expr::value_type>, complex_operand_t<typename Expr::value_type, Expr>> {
+        using T = Expr::value_type;
+        return ComplexExpr<ComplexScalar<T>, ComplexSub_Op<T>, complex_operand_t<T, Expr>>(complex_operand<T>(s), complex_operand<T>(expr));
+    }
+
+    template <typename S, typename Expr> requires is_complex_expr<Expr>::value && ComplexScalarOperand<S, typename Expr::value_type>
+    auto operator *(const S& s, const Expr& expr) -> ComplexExpr<ComplexScalar<typename Expr::value_type>, ComplexMul_Op<typename Expr::value_type>, complex_operand_t<typename Expr::value_type, Expr>> {
+        using T = Expr::value_type;
+        return ComplexExpr<ComplexScalar<T>, ComplexMul_Op<T>, complex_operand_t<T, Expr>>(complex_operand<T>(s), complex_operand<T>(expr));
+    }
+
+    template <typename S, typename Expr> requires is_complex_expr<Expr>::value && ComplexScalarOperand<S, typename Expr::value_type>
+    auto operator /(const S& s, const Expr& expr) -> ComplexExpr<ComplexScalar<typename Expr::value_type>, ComplexDiv_Op<typename Expr::value_type>, complex_operand_t<typename Expr::value_type, Expr>> {
+        using T = Expr::value_type;
+        return ComplexExpr<ComplexScalar<T>, ComplexDiv_Op<T>, complex_operand_t<T, Expr>>(complex_operand<T>(s), complex_operand<T>(expr));
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                  IO Stream Overload
+    //
+    /*****************************************************************************************/
+
+    template <typename T, typename IMPL>
+    std::ostream& operator <<(std::ostream& os, const ComplexSequence<T, IMPL>& z) {
+        if (z.size() > 0) {
+            os << "(";
+            for (std::size_t i = 0; i < z.size(); ++i) {
+                os << z[i] << ((i + 1 != z.size()) ? ',' : ')');
+            }
+        }
+        return os;
+    }
+}
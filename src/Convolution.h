@@ -0,0 +1,553 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <complex>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include <vector>
+
+#include "Blas.h"
+#include "FFT.h"
+#include "Parallel.h"
+#include "Polynomial.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                   1-D Convolution
+    //
+    //          convolve(x, h, mode) is a lazy expression template leaf whose element
+    //          i is element i of the convolution of the signal x with the kernel h,
+    //          y[j] = sum over k of h[k] x[j - k], over the range given by 'mode':
+    //
+    //              full        every j with a term, x.size() + h.size() - 1 elements
+    //              same        x.size() elements, centered on the full convolution
+    //              valid       the j at which h lies entirely within x
+    //              causal      the first x.size() elements, a FIR filter of x
+    //                          from a zero initial state, (also fir(x, h))
+    //
+    //          It combines with other sequences like any leaf, so a filter stage
+    //          and its pointwise post processing are a single expression:
+    //
+    //              convolve_assign(y, fir(x, h) * scalar(gain) + bias);
+    //
+    //          convolve_assign() evaluates the expression in parallel, one tile of
+    //          output indices at a time: every convolution of the expression first
+    //          computes its elements of the tile into scratch of the thread, and
+    //          the expression is then run over the tile reading them while they
+    //          are still in cache.  So there is no shifted copy of x per tap, no
+    //          buffer of the length of the output besides y, and the convolution
+    //          and the post processing are a single pass over memory.  A signal
+    //          which is not a contiguous sequence, (an expression), is read into
+    //          the scratch of the tile as well, over the inputs the tile depends
+    //          on.  A convolution nested within such a signal is not tiled, and
+    //          computes each element it is read for directly.
+    //
+    //          A convolution computes a tile by one of two methods, chosen by the
+    //          length of the kernel:
+    //
+    //              direct      for every tap, y[i] += h[k] x[i - k] over the tile
+    //              FFT         for floating point kernels of at least
+    //                          convolution_fft_cutoff taps, overlap-save: a block
+    //                          of L outputs is the tail of the circular convolution
+    //                          of the L + h.size() - 1 inputs it depends on with h,
+    //                          at a length of several kernel sizes, with the
+    //                          transform of h computed once
+    //
+    //          Since h is real, two blocks are convolved with one complex transform
+    //          pair, one block as the real part of the input and the other as the
+    //          imaginary part, which come back as the real and imaginary parts of
+    //          the result.
+    //
+    //          Overlap-save is used rather than overlap-add since every block of
+    //          outputs then depends only on its own inputs, so the tiles of any
+    //          thread are computed independently.
+    //
+    //          Elsewhere, (in a plain assignment, or an element read by index), an
+    //          element is computed directly as a dot product.  The signal and
+    //          kernel are held by reference, so a convolution must be evaluated
+    //          within the full expression it was built in.
+    //
+    //          Element i of a convolution reads other elements of the signal, so it
+    //          is not element wise, (see is_element_wise).  Assigning it to its own
+    //          signal or kernel, (x = fir(x, h)), evaluates it into a fresh buffer
+    //          first, it never reuses the buffer of an rvalue operand, and it
+    //          cannot be fused.
+    //
+    /********************************************************************************************/
+
+    constexpr std::size_t convolution_tile_size   = 2048;
+    constexpr std::size_t convolution_fft_cutoff  = 96;
+    constexpr std::size_t convolution_fft_minimum = 4096;
+
+    enum class ConvolutionMode {
+        full,
+        same,
+        valid,
+        causal
+    };
+
+    /*
+        Whether a signal is a SeqContainer read in place through its data().
+    */
+    template <typename Signal>
+    constexpr bool convolution_contiguous() {
+        if constexpr (is_seq_container<Signal>::value) {
+            return std::ranges::contiguous_range<const typename Signal::impl_type>;
+        }
+        else {
+            return false;
+        }
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                  'Convolution' class
+    //
+    /*****************************************************************************************/
+
+    template <typename Signal, typename Kernel>
+    class Convolution {
+
+    public:
+        using value_type = expr_value_type<Signal>;
+
+        Convolution(const Signal& x, const Kernel& h, ConvolutionMode mode);
+
+        auto operator [](std::size_t index) const -> value_type;
+        auto size() const -> std::size_t;
+
+        /*
+            Evaluation by tiles, driven by convolve_assign() over 'count' output
+            indices split into 'blocks' as by parallel_for: prepare() sets up the
+            kernel, its cached transform and a scratch tile per block, evaluate()
+            computes the elements in [first, last) into the tile of 'block', from
+            which operator[] then reads them, and release() returns to computing
+            elements directly.
+        */
+        void        prepare(std::size_t count, std::size_t blocks, std::size_t grain) const;
+        void        evaluate(std::size_t block, std::size_t first, std::size_t last) const;
+        void        release() const;
+        std::size_t tile_size() const noexcept;
+
+        bool refers_to(const void* object) const noexcept;
+
+        template <typename RE> auto operator +(RE&& re) const& -> ExprTemplate<const Convolution&, Add_Op<value_type>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator -(RE&& re) const& -> ExprTemplate<const Convolution&, Sub_Op<value_type>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator *(RE&& re) const& -> ExprTemplate<const Convolution&, Mul_Op<value_type>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator /(RE&& re) const& -> ExprTemplate<const Convolution&, Div_Op<value_type>, decltype(std::forward<RE>(re))>;
+
+    private:
+        /*
+            The scratch of one block, holding the elements of its current tile,
+            [first, last), the signal they read, and the transform buffer.
+        */
+        struct Tile {
+            std::size_t                           first = 0;
+            std::size_t                           last  = 0;
+            std::vector<value_type>               values;
+            std::vector<value_type>               signal;
+            std::vector<std::complex<value_type>> transform;
+        };
+
+        /*
+            The elements of the signal in [first, last), element 'at' being
+            data[at - first].  The signal is zero elsewhere.
+        */
+        struct Window {
+            const value_type* data;
+            std::ptrdiff_t    first;
+            std::ptrdiff_t    last;
+        };
+
+        const Signal&   _x;
+        const Kernel&   _h;
+        ConvolutionMode _mode;
+
+        mutable bool                                       _ready      = false;
+        mutable std::size_t                                _count      = 0;
+        mutable std::size_t                                _blocks     = 1;
+        mutable std::vector<Tile>                          _tiles;
+        mutable std::vector<value_type>                    _kernel;
+        mutable std::vector<std::complex<value_type>>      _spectrum;
+        mutable std::shared_ptr<const FFTPlan<value_type>> _plan;
+        mutable std::size_t                                _fft_length = 0;
+
+        auto offset() const -> std::size_t;
+        auto window(Tile& tile, std::ptrdiff_t first, std::ptrdiff_t last) const -> Window;
+        void evaluate_direct(Tile& tile, const Window& in) const;
+        void evaluate_fft(Tile& tile, const Window& in) const;
+    };
+
+    template <typename Signal, typename Kernel>
+    inline Convolution<Signal, Kernel>::Convolution(const Signal& x, const Kernel& h, ConvolutionMode mode) : _x(x), _h(h), _mode(mode) {
+    }
+
+    template <typename Signal, typename Kernel>
+    struct is_element_wise<Convolution<Signal, Kernel>> : std::false_type {};
+
+    template <typename Signal, typename Kernel>
+    inline bool Convolution<Signal, Kernel>::refers_to(const void* object) const noexcept {
+        return expr_refers_to(_x, object) || expr_refers_to(_h, object);
+    }
+
+    template <typename Signal, typename Kernel>
+    inline auto Convolution<Signal, Kernel>::size() const -> std::size_t {
+        const auto nx = _x.size();
+        const auto nh = _h.size();
+        if (nx == 0 || nh == 0) {
+            return 0;
+        }
+        switch (_mode) {
+        case ConvolutionMode::full:
+            return nx + nh - 1;
+        case ConvolutionMode::valid:
+            return nx >= nh ? nx - nh + 1 : 0;
+        default:
+            return nx;
+        }
+    }
+
+    /*
+        The index within the full convolution of element 0.
+    */
+    template <typename Signal, typename Kernel>
+    inline auto Convolution<Signal, Kernel>::offset() const -> std::size_t {
+        switch (_mode) {
+        case ConvolutionMode::same:
+            return (_h.size() - 1) / 2;
+        case ConvolutionMode::valid:
+            return _h.size() - 1;
+        default:
+            return 0;
+        }
+    }
+
+    template <typename Signal, typename Kernel>
+    inline auto Convolution<Signal, Kernel>::operator [](std::size_t index) const -> value_type {
+        if (_ready) {
+            const auto& tile = _tiles[block_index(_count, _blocks, index)];
+            if (index >= tile.first && index < tile.last) {
+                return tile.values[index - tile.first];
+            }
+        }
+        if (index >= size()) {
+            return value_type{};
+        }
+        const auto nx    = _x.size();
+        const auto j     = index + offset();
+        const auto first = j >= nx ? j - nx + 1 : 0;
+        const auto last  = std::min(_h.size() - 1, j);
+        const auto x     = element_reader(_x);
+        const auto h     = element_reader(_h);
+        value_type sum{};
+        for (auto k = first; k <= last; ++k) {
+            sum += h[k] * x[j - k];
+        }
+        return sum;
+    }
+
+    template <typename Signal, typename Kernel>
+    inline void Convolution<Signal, Kernel>::prepare(std::size_t count, std::size_t blocks, std::size_t grain) const {
+        _count  = count;
+        _blocks = std::max<std::size_t>(blocks, 1);
+        _tiles.assign(_blocks, Tile{});
+        const auto nh = _h.size();
+        const auto h  = element_reader(_h);
+        _kernel.resize(nh);
+        for (std::size_t k = 0; k < nh; ++k) {
+            _kernel[k] = h[k];
+        }
+        _fft_length = 0;
+        if constexpr (std::floating_point<value_type>) {
+            if (nh >= convolution_fft_cutoff) {
+                _fft_length = poly_fft_length(std::max(convolution_fft_minimum, 8 * nh));
+                _plan       = fft_plan<value_type>(_fft_length);
+                _spectrum.assign(_fft_length, std::complex<value_type>{});
+                std::copy(_kernel.begin(), _kernel.end(), _spectrum.begin());
+                _plan->template execute<false>(_spectrum.data(), grain);
+                const auto scale = value_type{ 1 } / static_cast<value_type>(_fft_length);
+                for (auto& value : _spectrum) {
+                    value *= scale;
+                }
+            }
+        }
+        _ready = true;
+    }
+
+    template <typename Signal, typename Kernel>
+    inline void Convolution<Signal, Kernel>::release() const {
+        _ready      = false;
+        _count      = 0;
+        _blocks     = 1;
+        _tiles      = std::vector<Tile>();
+        _spectrum   = std::vector<std::complex<value_type>>();
+        _plan       = nullptr;
+        _fft_length = 0;
+    }
+
+    /*
+        Whole pairs of blocks of the FFT method, or the default tile of the
+        direct one.
+    */
+    template <typename Signal, typename Kernel>
+    inline std::size_t Convolution<Signal, Kernel>::tile_size() const noexcept {
+        if (_fft_length == 0) {
+            return convolution_tile_size;
+        }
+        const auto pair = 2 * (_fft_length - _kernel.size() + 1);
+        return std::max<std::size_t>(convolution_tile_size / pair, 1) * pair;
+    }
+
+    /*
+        Element i of the tile reads the inputs in [i + offset - nh + 1, i + offset].
+    */
+    template <typename Signal, typename Kernel>
+    inline void Convolution<Signal, Kernel>::evaluate(std::size_t block, std::size_t first, std::size_t last) const {
+        auto& tile = _tiles[block];
+        last       = std::max(first, std::min(last, size()));
+        tile.first = first;
+        tile.last  = last;
+        if (first == last) {
+            return;
+        }
+        tile.values.resize(last - first);
+        const auto shift = static_cast<std::ptrdiff_t>(offset());
+        const auto reach = static_cast<std::ptrdiff_t>(_kernel.size()) - 1;
+        const auto in    = window(tile, static_cast<std::ptrdiff_t>(first) + shift - reach, static_cast<std::ptrdiff_t>(last) + shift);
+        if (_fft_length != 0) {
+            evaluate_fft(tile, in);
+        }
+        else {
+            evaluate_direct(tile, in);
+        }
+    }
+
+    /*
+        A contiguous signal is read in place, and any other one is read into
+        the scratch of the tile.
+    */
+    template <typename Signal, typename Kernel>
+    inline auto Convolution<Signal, Kernel>::window(Tile& tile, std::ptrdiff_t first, std::ptrdiff_t last) const -> Window {
+        first = std::max<std::ptrdiff_t>(first, 0);
+        last  = std::max(first, std::min(last, static_cast<std::ptrdiff_t>(_x.size())));
+        if constexpr (convolution_contiguous<Signal>()) {
+            return { _x.data() + first, first, last };
+        }
+        else {
+            const auto x = element_reader(_x);
+            tile.signal.resize(static_cast<std::size_t>(last - first));
+            for (auto at = first; at < last; ++at) {
+                tile.signal[static_cast<std::size_t>(at - first)] = x[static_cast<std::size_t>(at)];
+            }
+            return { tile.signal.data(), first, last };
+        }
+    }
+
+    /*
+        Element i reads x[i + offset - k] for tap k, so the tap contributes to
+        the elements i in [in.first + k - offset, in.last + k - offset) of the
+        tile.
+    */
+    template <typename Signal, typename Kernel>
+    inline void Convolution<Signal, Kernel>::evaluate_direct(Tile& tile, const Window& in) const {
+        const auto first = static_cast<std::ptrdiff_t>(tile.first);
+        const auto last  = static_cast<std::ptrdiff_t>(tile.last);
+        const auto shift = static_cast<std::ptrdiff_t>(offset());
+        value_type* out  = tile.values.data();
+        std::fill(tile.values.begin(), tile.values.end(), value_type{});
+        for (std::size_t k = 0; k < _kernel.size(); ++k) {
+            const auto tap = static_cast<std::ptrdiff_t>(k);
+            const auto lo  = std::max(first, in.first + tap - shift);
+            const auto hi  = std::min(last, in.last + tap - shift);
+            if (lo >= hi) {
+                continue;
+            }
+            const value_type  weight = _kernel[k];
+            const value_type* src    = in.data + (lo + shift - tap - in.first);
+            value_type*       dst    = out + (lo - first);
+            const auto        count  = static_cast<std::size_t>(hi - lo);
+            for (std::size_t n = 0; n < count; ++n) {
+                dst[n] += weight * src[n];
+            }
+        }
+    }
+
+    /*
+        The block of L outputs at full index j0 depends on x[j0 - nh + 1, j0 + L),
+        and element t + nh - 1 of the circular convolution of those inputs with
+        h is the output at j0 + t.  Blocks are taken in pairs, the second one
+        as the imaginary part.
+    */
+    template <typename Signal, typename Kernel>
+    inline void Convolution<Signal, Kernel>::evaluate_fft(Tile& tile, const Window& in) const {
+        if constexpr (std::floating_point<value_type>) {
+            using complex_type = std::complex<value_type>;
+            constexpr auto serial = std::numeric_limits<std::size_t>::max();
+            const auto first  = tile.first;
+            const auto last   = tile.last;
+            const auto nh     = _kernel.size();
+            const auto length = _fft_length;
+            const auto block  = length - nh + 1;
+            const auto shift  = offset();
+            auto input = [&](std::ptrdiff_t at) {
+                return at >= in.first && at < in.last ? in.data[at - in.first] : value_type{};
+            };
+            auto& z = tile.transform;
+            z.resize(length);
+            for (auto start = first; start < last; start += 2 * block) {
+                const auto second = std::min(start + block, last);
+                const auto stop   = std::min(second + block, last);
+                const auto begin  = static_cast<std::ptrdiff_t>(start + shift) - static_cast<std::ptrdiff_t>(nh - 1);
+                const auto next   = begin + static_cast<std::ptrdiff_t>(block);
+                for (std::size_t n = 0; n < length; ++n) {
+                    const auto at = static_cast<std::ptrdiff_t>(n);
+                    z[n] = complex_type(input(begin + at), second < stop ? input(next + at) : value_type{});
+                }
+                _plan->template execute<false>(z.data(), serial);
+                for (std::size_t k = 0; k < length; ++k) {
+                    z[k] = fft_mul(z[k], _spectrum[k]);
+                }
+                _plan->template execute<true>(z.data(), serial);
+                for (auto i = start; i < second; ++i) {
+                    tile.values[i - first] = z[i - start + nh - 1].real();
+                }
+                for (auto i = second; i < stop; ++i) {
+                    tile.values[i - first] = z[i - second + nh - 1].imag();
+                }
+            }
+        }
+    }
+
+    template <typename Signal, typename Kernel>
+    template <typename RE>
+    inline auto Convolution<Signal, Kernel>::operator +(RE&& re) const& -> ExprTemplate<const Convolution&, Add_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const Convolution&, Add_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    template <typename Signal, typename Kernel>
+    template <typename RE>
+    inline auto Convolution<Signal, Kernel>::operator -(RE&& re) const& -> ExprTemplate<const Convolution&, Sub_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const Convolution&, Sub_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    template <typename Signal, typename Kernel>
+    template <typename RE>
+    inline auto Convolution<Signal, Kernel>::operator *(RE&& re) const& -> ExprTemplate<const Convolution&, Mul_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const Convolution&, Mul_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    template <typename Signal, typename Kernel>
+    template <typename RE>
+    inline auto Convolution<Signal, Kernel>::operator /(RE&& re) const& -> ExprTemplate<const Convolution&, Div_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const Convolution&, Div_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    template <typename Signal, typename Kernel> requires std::same_as<expr_value_type<Signal>, expr_value_type<Kernel>>
+    auto convolve(const Signal& x, const Kernel& h, ConvolutionMode mode = ConvolutionMode::full) -> Convolution<Signal, Kernel> {
+        return Convolution<Signal, Kernel>(x, h, mode);
+    }
+
+    template <typename Signal, typename Kernel> requires std::same_as<expr_value_type<Signal>, expr_value_type<Kernel>>
+    auto fir(const Signal& x, const Kernel& h) -> Convolution<Signal, Kernel> {
+        return Convolution<Signal, Kernel>(x, h, ConvolutionMode::causal);
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                  Tiled Evaluation
+    //
+    /*****************************************************************************************/
+
+    template <typename Expr>
+    struct is_convolution : std::false_type {};
+
+    template <typename Signal, typename Kernel>
+    struct is_convolution<Convolution<Signal, Kernel>> : std::true_type {};
+
+    /*
+        Calls func(node) for every convolution within an expression.
+    */
+    template <typename Expr, typename Func>
+    void for_each_convolution(const Expr& expr, Func&& func) {
+        if constexpr (is_convolution<Expr>::value) {
+            func(expr);
+        }
+        else if constexpr (is_expr_template<Expr>::value) {
+            for_each_convolution(expr.left_expr(), func);
+            for_each_convolution(expr.right_expr(), func);
+        }
+    }
+
+    /*
+        Evaluates an expression holding convolutions into 'y', resized to the
+        size of the expression, in parallel over tiles of output indices.  When
+        the expression reads y, (as the signal or kernel of a convolution, or
+        otherwise), it is evaluated into a fresh sequence which is then moved
+        into y.
+    */
+    template <typename Seq, typename Expr>
+    Seq& convolve_assign(Seq& y, const Expr& expr, std::size_t grain = default_grain) {
+        using value_type = Seq::value_type;
+        if (!is_element_wise<Expr>::value && expr_refers_to(expr, &y)) {
+            Seq fresh;
+            convolve_assign(fresh, expr, grain);
+            y = std::move(fresh);
+            return y;
+        }
+        const auto count  = expr.size();
+        const auto blocks = block_count(count, grain);
+        std::size_t tile  = convolution_tile_size;
+        for_each_convolution(expr, [&](const auto& node) {
+            node.prepare(count, blocks, grain);
+            tile = std::max(tile, node.tile_size());
+        });
+        fill_sequence(y, count, [&](value_type* out) {
+            parallel_for(count, grain, [&](std::size_t first, std::size_t last, std::size_t block) {
+                for (auto start = first; start < last; start += tile) {
+                    const auto stop = std::min(start + tile, last);
+                    for_each_convolution(expr, [&](const auto& node) {
+                        node.evaluate(block, start, stop);
+                    });
+                    for (auto i = start; i < stop; ++i) {
+                        out[i] = expr[i];
+                    }
+                }
+            });
+        });
+        for_each_convolution(expr, [](const auto& node) {
+            node.release();
+        });
+        return y;
+    }
+}
@@ -44,6 +44,47 @@ namespace Oliver {
     //
     /********************************************************************************************/
 
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    class ExprTemplate;
+
+    template <typename Expr>
+    struct is_expr_template : std::false_type {};
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    struct is_expr_template<ExprTemplate<LeftExpr, BinaryOp, RightExpr>> : std::true_type {};
+
+    /*
+        An expression is element wise when its element i only reads element i of
+        each of its operands, as every operation of an ExprTemplate does.  A leaf
+        whose element i reads other elements of an operand, such as a sparse
+        product or a convolution, specializes is_element_wise to false.  Such an
+        expression is never written in place over a sequence it reads, never
+        reuses the buffer of an rvalue operand, and cannot be fused.
+    */
+    template <typename Expr>
+    struct is_element_wise : std::true_type {};
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    struct is_element_wise<ExprTemplate<LeftExpr, BinaryOp, RightExpr>>
+        : std::bool_constant<is_element_wise<std::remove_cvref_t<LeftExpr>>::value && is_element_wise<std::remove_cvref_t<RightExpr>>::value> {};
+
+    /*
+        Whether 'object' is a leaf of the expression, or is read by one of its
+        leaves.  A leaf which reads another sequence provides refers_to().
+    */
+    template <typename Expr>
+    bool expr_refers_to(const Expr& expr, const void* object) noexcept {
+        if constexpr (is_expr_template<Expr>::value) {
+            return expr_refers_to(expr.left_expr(), object) || expr_refers_to(expr.right_expr(), object);
+        }
+        else if constexpr (requires { expr.refers_to(object); }) {
+            return expr.refers_to(object);
+        }
+        else {
+            return static_cast<const void*>(&expr) == object;
+        }
+    }
+
     template <typename LeftExpr, typename BinaryOp, typename RightExpr>
     class ExprTemplate {
 
@@ -131,7 +172,7 @@ namespace Oliver {
             return _left_expr;
         }
 
-        auto left_expr() const -> typename std::add_lvalue_reference<typename std::add_const<LeftExpr>::type>::type {
+        auto left_expr() const -> typename std::add_lvalue_reference<typename std::add_const<typename std::remove_reference<LeftExpr>::type>::type>::type {
             return _left_expr;
         }
 
@@ -139,7 +180,7 @@ namespace Oliver {
             return _right_expr;
         }
 
-        auto right_expr() const -> typename std::add_lvalue_reference<typename std::add_const<RightExpr>::type >::type {
+        auto right_expr() const -> typename std::add_lvalue_reference<typename std::add_const<typename std::remove_reference<RightExpr>::type>::type>::type {
             return _right_expr;
         }
 
@@ -151,8 +192,44 @@ namespace Oliver {
             return left_expr().size() != 0 ? left_expr().size() : right_expr().size();
         }
 
+        /*
+            Returns the first operand of the expression tree held by rvalue
+            reference of type 'Seq' whose size is exactly 'size', or nullptr.
+
+            When every leaf of the expression is element wise, index i of the
+            result only reads index i of each operand.  So the buffer of such a
+            temporary can safely be written to in place while the expression
+            is evaluated, and then be moved into the destination.  Otherwise
+            there is no such operand, and nullptr is returned.
+        */
+        template <typename Seq>
+        auto rvalue_leaf(std::size_t size) const -> Seq* {
+            if constexpr (!is_element_wise<ExprTemplate>::value) {
+                return nullptr;
+            }
+            else {
+                if (auto leaf = rvalue_leaf_of<Seq, LeftExpr>(_left_expr, size)) {
+                    return leaf;
+                }
+                return rvalue_leaf_of<Seq, RightExpr>(_right_expr, size);
+            }
+        }
+
     private:
         LeftExpr  _left_expr;
         RightExpr _right_expr;
+
+        template <typename Seq, typename Expr, typename Operand>
+        static auto rvalue_leaf_of(Operand& operand, std::size_t size) -> Seq* {
+            if constexpr (std::is_same<Expr, Seq&&>::value) {
+                if (operand.size() == size) {
+                    return &operand;
+                }
+            }
+            else if constexpr (is_expr_template<typename std::remove_cvref<Expr>::type>::value) {
+                return operand.template rvalue_leaf<Seq>(size);
+            }
+            return nullptr;
+        }
     };
 }
@@ -0,0 +1,488 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <ranges>
+#include <vector>
+
+#include "Parallel.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                 Fast Fourier Transforms
+    //
+    //          fft(x)          in place forward transform of a complex sequence
+    //          ifft(x)         in place inverse transform, scaled by 1 / n
+    //          rfft(x)         the n / 2 + 1 non redundant bins of a real sequence
+    //          irfft(X, n)     the real sequence of n elements with spectrum X
+    //
+    //          The transforms are mixed radix Stockham FFTs, (self sorting, so no bit
+    //          reversal pass), which ping-pong between the sequence and a scratch
+    //          buffer kept per thread.  A length is factored into radices of 4, 2, 3
+    //          and then any remaining primes, with radices 2, 3 and 4 as dedicated
+    //          butterflies and any other prime as a direct DFT of that radix, so a
+    //          length with a large prime factor p costs O(n p) for that stage.
+    //
+    //          Each stage runs its butterflies along the dimension of unit stride,
+    //          and complex products are written out so they do not go through the
+    //          NaN recovery of std::complex.  Stages of large transforms are split
+    //          into blocks run in parallel.
+    //
+    //          The twiddle factors of a length are computed once and cached in an
+    //          FFTPlan shared by every later transform of that length.
+    //
+    //          The real transforms read and write the SeqContainers directly: a real
+    //          sequence of even length n is viewed as n / 2 complex elements, (as
+    //          std::complex allows), transformed as such, and then split into the
+    //          spectrum of the real sequence.
+    //
+    /********************************************************************************************/
+
+    /*
+        a * b, without the special cases of std::complex for infinities and NaNs.
+    */
+    template <typename T>
+    inline std::complex<T> fft_mul(const std::complex<T>& a, const std::complex<T>& b) {
+        return { a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real() };
+    }
+
+    /*
+        z * -i for the forward transform, and z * i for the inverse.
+    */
+    template <bool Inverse, typename T>
+    inline std::complex<T> fft_rotate(const std::complex<T>& z) {
+        if constexpr (Inverse) {
+            return { -z.imag(), z.real() };
+        }
+        else {
+            return { z.imag(), -z.real() };
+        }
+    }
+
+    template <bool Inverse, typename T>
+    inline std::complex<T> fft_twiddle(const std::complex<T>& w) {
+        if constexpr (Inverse) {
+            return std::conj(w);
+        }
+        else {
+            return w;
+        }
+    }
+
+    /*
+        exp(-2 pi i k / n), evaluated in long double.
+    */
+    template <typename T>
+    std::complex<T> fft_root(std::size_t k, std::size_t n) {
+        const long double angle = -2.0L * std::numbers::pi_v<long double> * static_cast<long double>(k % n) / static_cast<long double>(n);
+        return { static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle)) };
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                      'FFTPlan' class
+    //
+    //          A stage of radix p over sub transforms of 'length' elements, at a
+    //          stride of s = n / length, maps x[q + s * (i + r * m)], (m = length / p),
+    //          to y[q + s * (p * i + k)], multiplied by twiddles[i * (p - 1) + k - 1].
+    //
+    /*****************************************************************************************/
+
+    template <typename T>
+    struct FFTStage {
+        std::size_t                  radix;
+        std::size_t                  length;
+        std::vector<std::complex<T>> twiddles;
+        std::vector<std::complex<T>> roots;
+    };
+
+    template <typename T>
+    class FFTPlan {
+
+    public:
+        using complex_type = std::complex<T>;
+
+        explicit FFTPlan(std::size_t size);
+
+        std::size_t size() const noexcept;
+
+        template <bool Inverse>
+        void execute(complex_type* data, std::size_t grain = default_grain) const;
+
+    private:
+        std::size_t              _size;
+        std::vector<FFTStage<T>> _stages;
+
+        template <bool Inverse>
+        static void run_stage(const FFTStage<T>& stage, std::size_t stride, const complex_type* x, complex_type* y, std::size_t grain);
+
+        template <bool Inverse>
+        static void butterflies(const FFTStage<T>& stage, std::size_t stride, const complex_type* x, complex_type* y, std::size_t i0, std::size_t i1, std::size_t q0, std::size_t q1);
+    };
+
+    template <typename T>
+    inline FFTPlan<T>::FFTPlan(std::size_t size) : _size(size), _stages() {
+        std::vector<std::size_t> radices;
+        auto rest = size;
+        for (const std::size_t radix : { 4, 2, 3 }) {
+            while (rest > 1 && rest % radix == 0) {
+                radices.push_back(radix);
+                rest /= radix;
+            }
+        }
+        for (std::size_t radix = 5; radix * radix <= rest; radix += 2) {
+            while (rest % radix == 0) {
+                radices.push_back(radix);
+                rest /= radix;
+            }
+        }
+        if (rest > 1) {
+            radices.push_back(rest);
+        }
+        auto length = size;
+        for (const auto radix : radices) {
+            FFTStage<T> stage{ radix, length, {}, {} };
+            const auto m = length / radix;
+            stage.twiddles.resize(m * (radix - 1));
+            for (std::size_t i = 0; i < m; ++i) {
+                for (std::size_t k = 1; k < radix; ++k) {
+                    stage.twiddles[i * (radix - 1) + k - 1] = fft_root<T>(i * k, length);
+                }
+            }
+            if (radix > 4) {
+                stage.roots.resize(radix);
+                for (std::size_t j = 0; j < radix; ++j) {
+                    stage.roots[j] = fft_root<T>(j, radix);
+                }
+            }
+            _stages.push_back(std::move(stage));
+            length = m;
+        }
+    }
+
+    template <typename T>
+    inline std::size_t FFTPlan<T>::size() const noexcept {
+        return _size;
+    }
+
+    template <typename T>
+    template <bool Inverse>
+    void FFTPlan<T>::butterflies(const FFTStage<T>& stage, std::size_t s, const complex_type* x, complex_type* y, std::size_t i0, std::size_t i1, std::size_t q0, std::size_t q1) {
+        const auto p = stage.radix;
+        const auto m = stage.length / p;
+        for (auto i = i0; i < i1; ++i) {
+            const complex_type* w   = stage.twiddles.data() + i * (p - 1);
+            const complex_type* in  = x + s * i;
+            complex_type*       out = y + s * p * i;
+            if (p == 2) {
+                const auto w1 = fft_twiddle<Inverse>(w[0]);
+                for (auto q = q0; q < q1; ++q) {
+                    const auto a0 = in[q];
+                    const auto a1 = in[q + s * m];
+                    out[q]     = a0 + a1;
+                    out[q + s] = fft_mul(a0 - a1, w1);
+                }
+            }
+            else if (p == 3) {
+                const T    half = T{ 0.5 };
+                const T    sine = static_cast<T>(std::numbers::sqrt3_v<long double> / 2);
+                const auto w1   = fft_twiddle<Inverse>(w[0]);
+                const auto w2   = fft_twiddle<Inverse>(w[1]);
+                for (auto q = q0; q < q1; ++q) {
+                    const auto a0 = in[q];
+                    const auto a1 = in[q + s * m];
+                    const auto a2 = in[q + 2 * s * m];
+                    const auto t  = a1 + a2;
+                    const auto u  = a0 - half * t;
+                    const auto v  = fft_rotate<Inverse>(a1 - a2) * sine;
+                    out[q]         = a0 + t;
+                    out[q + s]     = fft_mul(u + v, w1);
+                    out[q + 2 * s] = fft_mul(u - v, w2);
+                }
+            }
+            else if (p == 4) {
+                const auto w1 = fft_twiddle<Inverse>(w[0]);
+                const auto w2 = fft_twiddle<Inverse>(w[1]);
+                const auto w3 = fft_twiddle<Inverse>(w[2]);
+                for (auto q = q0; q < q1; ++q) {
+                    const auto a0 = in[q];
+                    const auto a1 = in[q + s * m];
+                    const auto a2 = in[q + 2 * s * m];
+                    const auto a3 = in[q + 3 * s * m];
+                    const auto t0 = a0 + a2;
+                    const auto t1 = a0 - a2;
+                    const auto t2 = a1 + a3;
+                    const auto t3 = fft_rotate<Inverse>(a1 - a3);
+                    out[q]         = t0 + t2;
+                    out[q + s]     = fft_mul(t1 + t3, w1);
+                    out[q + 2 * s] = fft_mul(t0 - t2, w2);
+                    out[q + 3 * s] = fft_mul(t1 - t3, w3);
+                }
+            }
+            else {
+                for (auto q = q0; q < q1; ++q) {
+                    for (std::size_t k = 0; k < p; ++k) {
+                        complex_type sum = in[q];
+                        for (std::size_t r = 1; r < p; ++r) {
+                            sum += fft_mul(in[q + r * s * m], fft_twiddle<Inverse>(stage.roots[(r * k) % p]));
+                        }
+                        out[q + k * s] = k == 0 ? sum : fft_mul(sum, fft_twiddle<Inverse>(w[k - 1]));
+                    }
+                }
+            }
+        }
+    }
+
+    /*
+        Splits the stage along whichever of its two dimensions is the longer.
+    */
+    template <typename T>
+    template <bool Inverse>
+    void FFTPlan<T>::run_stage(const FFTStage<T>& stage, std::size_t s, const complex_type* x, complex_type* y, std::size_t grain) {
+        const auto m    = stage.length / stage.radix;
+        const auto work = s * stage.radix;
+        if (m >= s) {
+            parallel_for(m, std::max<std::size_t>(grain / work, 1), [&](std::size_t first, std::size_t last, std::size_t) {
+                butterflies<Inverse>(stage, s, x, y, first, last, 0, s);
+            });
+        }
+        else {
+            parallel_for(s, std::max<std::size_t>(grain / (m * stage.radix), 1), [&](std::size_t first, std::size_t last, std::size_t) {
+                butterflies<Inverse>(stage, s, x, y, 0, m, first, last);
+            });
+        }
+    }
+
+    template <typename T>
+    template <bool Inverse>
+    void FFTPlan<T>::execute(complex_type* data, std::size_t grain) const {
+        if (_size <= 1) {
+            return;
+        }
+        thread_local std::vector<complex_type> scratch;
+        if (scratch.size() < _size) {
+            scratch.resize(_size);
+        }
+        complex_type* x = data;
+        complex_type* y = scratch.data();
+        std::size_t   s = 1;
+        for (const auto& stage : _stages) {
+            run_stage<Inverse>(stage, s, x, y, grain);
+            s *= stage.radix;
+            std::swap(x, y);
+        }
+        if (x != data) {
+            std::copy_n(x, _size, data);
+        }
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                      Plan Cache
+    //
+    /*****************************************************************************************/
+
+    template <typename Plan>
+    std::shared_ptr<const Plan> cached_plan(std::size_t size) {
+        static std::mutex                                         mutex;
+        static std::map<std::size_t, std::shared_ptr<const Plan>> plans;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& plan = plans[size];
+        if (!plan) {
+            plan = std::make_shared<const Plan>(size);
+        }
+        return plan;
+    }
+
+    template <typename T>
+    std::shared_ptr<const FFTPlan<T>> fft_plan(std::size_t size) {
+        return cached_plan<FFTPlan<T>>(size);
+    }
+
+    /*
+        The plan of a real transform of even length n: the complex plan of
+        n / 2, and the factors exp(-2 pi i k / n) splitting its output.
+    */
+    template <typename T>
+    struct RealFFTPlan {
+        std::shared_ptr<const FFTPlan<T>> half;
+        std::vector<std::complex<T>>      twiddles;
+
+        explicit RealFFTPlan(std::size_t size) : half(fft_plan<T>(size / 2)), twiddles(size / 2) {
+            for (std::size_t k = 0; k < size / 2; ++k) {
+                twiddles[k] = fft_root<T>(k, size);
+            }
+        }
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                   Complex Transforms
+    //
+    /*****************************************************************************************/
+
+    template <typename T, typename IMPL> requires std::ranges::contiguous_range<IMPL>
+    SeqContainer<std::complex<T>, IMPL>& fft(SeqContainer<std::complex<T>, IMPL>& x, std::size_t grain = default_grain) {
+        fft_plan<T>(x.size())->template execute<false>(x.data(), grain);
+        return x;
+    }
+
+    template <typename T, typename IMPL> requires std::ranges::contiguous_range<IMPL>
+    SeqContainer<std::complex<T>, IMPL>& ifft(SeqContainer<std::complex<T>, IMPL>& x, std::size_t grain = default_grain) {
+        const auto size = x.size();
+        auto*      data = x.data();
+        fft_plan<T>(size)->template execute<true>(data, grain);
+        if (size > 0) {
+            const T scale = T{ 1 } / static_cast<T>(size);
+            parallel_for(size, grain, [&](std::size_t first, std::size_t last, std::size_t) {
+                for (auto i = first; i < last; ++i) {
+                    data[i] *= scale;
+                }
+            });
+        }
+        return x;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                    Real Transforms
+    //
+    //          With z[k] = x[2k] + i x[2k + 1] and Z its transform of h = n / 2 points,
+    //          E[k] = (Z[k] + conj(Z[h - k])) / 2 and O[k] = (Z[k] - conj(Z[h - k])) / 2i
+    //          are the transforms of the even and odd elements of x, and
+    //
+    //              X[k]     = E[k] + w^k O[k]
+    //              X[h - k] = conj(E[k] - w^k O[k])
+    //
+    //          with w = exp(-2 pi i / n), so each pair k, h - k is computed in place
+    //          from the same two elements of Z.  An odd length is transformed as a
+    //          complex sequence.
+    //
+    /*****************************************************************************************/
+
+    template <typename T, typename IMPL> requires std::ranges::contiguous_range<const IMPL>
+    auto rfft(const SeqContainer<T, IMPL>& x, std::size_t grain = default_grain) -> SeqContainer<std::complex<T>> {
+        using complex_type = std::complex<T>;
+        const auto size = x.size();
+        SeqContainer<complex_type> out;
+        if (size == 0) {
+            return out;
+        }
+        if (size % 2 != 0) {
+            out.resize(size);
+            std::copy_n(x.data(), size, out.data());
+            fft(out, grain);
+            out.resize(size / 2 + 1);
+            return out;
+        }
+        const auto half = size / 2;
+        const auto plan = cached_plan<RealFFTPlan<T>>(size);
+        out.resize(half + 1);
+        auto* z = out.data();
+        std::copy_n(x.data(), size, reinterpret_cast<T*>(z));
+        plan->half->template execute<false>(z, grain);
+
+        const auto z0 = z[0];
+        z[0]    = complex_type(z0.real() + z0.imag(), T{ 0 });
+        z[half] = complex_type(z0.real() - z0.imag(), T{ 0 });
+        parallel_for(half / 2, grain, [&](std::size_t first, std::size_t last, std::size_t) {
+            for (auto k = first + 1; k <= last; ++k) {
+                const auto a  = z[k];
+                const auto b  = std::conj(z[half - k]);
+                const auto e  = (a + b) * T{ 0.5 };
+                const auto o  = fft_rotate<false>(a - b) * T{ 0.5 };
+                const auto wo = fft_mul(plan->twiddles[k], o);
+                z[k]        = e + wo;
+                z[half - k] = std::conj(e - wo);
+            }
+        });
+        return out;
+    }
+
+    template <typename T, typename IMPL> requires std::ranges::contiguous_range<const IMPL>
+    auto irfft(const SeqContainer<std::complex<T>, IMPL>& spectrum, std::size_t size, std::size_t grain = default_grain) -> SeqContainer<T> {
+        using complex_type = std::complex<T>;
+        SeqContainer<T> out;
+        if (size == 0) {
+            return out;
+        }
+        auto bin = [&](std::size_t k) {
+            return k < spectrum.size() ? spectrum.data()[k] : complex_type{};
+        };
+        if (size % 2 != 0) {
+            SeqContainer<complex_type> full;
+            full.resize(size);
+            for (std::size_t k = 0; k <= size / 2; ++k) {
+                full.data()[k] = bin(k);
+                if (k != 0) {
+                    full.data()[size - k] = std::conj(bin(k));
+                }
+            }
+            ifft(full, grain);
+            out.resize(size);
+            for (std::size_t i = 0; i < size; ++i) {
+                out.data()[i] = full.data()[i].real();
+            }
+            return out;
+        }
+        const auto half = size / 2;
+        const auto plan = cached_plan<RealFFTPlan<T>>(size);
+        out.resize(size);
+        auto* z = reinterpret_cast<complex_type*>(out.data());
+
+        const T x0 = bin(0).real();
+        const T xh = bin(half).real();
+        z[0] = complex_type((x0 + xh) * T{ 0.5 }, (x0 - xh) * T{ 0.5 });
+        parallel_for(half / 2, grain, [&](std::size_t first, std::size_t last, std::size_t) {
+            for (auto k = first + 1; k <= last; ++k) {
+                const auto a = bin(k);
+                const auto b = std::conj(bin(half - k));
+                const auto e = (a + b) * T{ 0.5 };
+                const auto o = fft_mul(a - b, std::conj(plan->twiddles[k])) * T{ 0.5 };
+                z[k]        = e + fft_rotate<true>(o);
+                z[half - k] = std::conj(e) + fft_rotate<true>(std::conj(o));
+            }
+        });
+        plan->half->template execute<true>(z, grain);
+        const T scale = T{ 1 } / static_cast<T>(half);
+        parallel_for(half, grain, [&](std::size_t first, std::size_t last, std::size_t) {
+            for (auto k = first; k < last; ++k) {
+                z[k] *= scale;
+            }
+        });
+        return out;
+    }
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "Parallel.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                 Histograms & Counting
+    //
+    //          histogram(x, bins, low, high)   'bins' equal width bins over [low, high]
+    //          histogram(x, edges)             the bins between consecutive sorted edges
+    //          bincount(x, length)             the count of every integer value
+    //
+    //          As with NumPy, every bin is half open except the last, which also
+    //          holds its right edge, and values outside of the bins are not counted.
+    //
+    //          Each block of the input is counted by its own thread into its own
+    //          histogram, and the histograms are summed at the end.  Within a block,
+    //          the bins of a tile of elements are computed first, in a loop with no
+    //          stores to the histogram, (and no branches for out of range values,
+    //          which go to an extra discarded bin).  The tile is then counted into
+    //          several interleaved sub-histograms, so consecutive elements falling
+    //          in the same bin increment different counters, and do not wait on
+    //          each other's stores.
+    //
+    /********************************************************************************************/
+
+    constexpr std::size_t histogram_tile  = 256;
+    constexpr std::size_t histogram_lanes = 4;
+
+    /*
+        Sub-histograms beyond this many bins would no longer fit in the cache
+        together, so larger histograms are counted in a single lane.
+    */
+    constexpr std::size_t histogram_lane_bins = std::size_t{ 1 } << 14;
+
+    /*
+        Counts the first 'count' elements of 'in' into 'bins' bins, where
+        bin_of(value) returns the bin of a value, or 'bins' to discard it.
+    */
+    template <typename T, typename Reader, typename BinOf>
+    std::vector<std::size_t> histogram_into(const Reader& in, std::size_t count, std::size_t bins, const BinOf& bin_of, std::size_t grain) {
+        const auto blocks = block_count(count, grain);
+        const auto lanes  = bins <= histogram_lane_bins ? histogram_lanes : 1;
+        const auto stride = bins + 1;
+        std::vector<std::vector<std::size_t>> partial(blocks);
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [first, last] = block_range(count, blocks, block);
+            auto& counts = partial[block];
+            counts.assign(lanes * stride, 0);
+            std::array<std::size_t, histogram_tile> tile;
+            for (auto at = first; at < last; at += histogram_tile) {
+                const auto width = std::min(histogram_tile, last - at);
+                for (std::size_t t = 0; t < width; ++t) {
+                    const T value = in[at + t];
+                    tile[t] = bin_of(value);
+                }
+                std::size_t t = 0;
+                if (lanes == histogram_lanes) {
+                    for (; t + histogram_lanes <= width; t += histogram_lanes) {
+                        for (std::size_t l = 0; l < histogram_lanes; ++l) {
+                            ++counts[l * stride + tile[t + l]];
+                        }
+                    }
+                }
+                for (; t < width; ++t) {
+                    ++counts[tile[t]];
+                }
+            }
+        });
+        std::vector<std::size_t> result(bins, 0);
+        for (const auto& counts : partial) {
+            for (std::size_t l = 0; l < lanes; ++l) {
+                for (std::size_t b = 0; b < bins; ++b) {
+                    result[b] += counts[l * stride + b];
+                }
+            }
+        }
+        return result;
+    }
+
+    inline SeqContainer<std::size_t> to_counts(const std::vector<std::size_t>& counts) {
+        SeqContainer<std::size_t> out;
+        fill_sequence(out, counts.size(), [&](std::size_t* data) {
+            std::copy(counts.begin(), counts.end(), data);
+        });
+        return out;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                   Histogram Kernels
+    //
+    /*****************************************************************************************/
+
+    template <typename Expr>
+    auto histogram(const Expr& expr, std::size_t bins, double low, double high, std::size_t grain = default_grain) -> SeqContainer<std::size_t> {
+        using value_type = expr_value_type<Expr>;
+        if (bins == 0 || !(low < high)) {
+            return to_counts(std::vector<std::size_t>(bins, 0));
+        }
+        const double scale = static_cast<double>(bins) / (high - low);
+        const auto   limit = static_cast<double>(bins - 1);
+        const auto bin_of = [=](const value_type& value) -> std::size_t {
+            const auto x      = static_cast<double>(value);
+            const bool inside = x >= low && x <= high;
+            const auto offset = x == x ? (x - low) * scale : 0.0;
+            const auto bin    = static_cast<std::size_t>(std::min(std::max(offset, 0.0), limit));
+            return inside ? bin : bins;
+        };
+        return to_counts(histogram_into<value_type>(element_reader(expr), expr.size(), bins, bin_of, grain));
+    }
+
+    /*
+        Counts the values between each pair of consecutive 'edges', which must be
+        sorted in ascending order.  The bin of a value is found with a binary
+        search of fixed length, without data dependent branches.
+    */
+    template <typename Expr, typename Edges>
+        requires requires (const Edges& edges) { edges.size(); edges[0]; }
+    auto histogram(const Expr& expr, const Edges& edges, std::size_t grain = default_grain) -> SeqContainer<std::size_t> {
+        using value_type = expr_value_type<Expr>;
+        using edge_type  = expr_value_type<Edges>;
+        const auto count = edges.size();
+        if (count < 2) {
+            return to_counts(std::vector<std::size_t>());
+        }
+        std::vector<edge_type> bounds(count);
+        for (std::size_t e = 0; e < count; ++e) {
+            bounds[e] = edges[e];
+        }
+        const auto bins   = count - 1;
+        const auto bin_of = [&bounds, bins](const value_type& value) -> std::size_t {
+            const edge_type x = static_cast<edge_type>(value);
+            const auto* base  = bounds.data();
+            auto length = bounds.size();
+            while (length > 1) {
+                const auto half = length / 2;
+                base    = (base[half] <= x) ? base + half : base;
+                length -= half;
+            }
+            const auto bin    = static_cast<std::size_t>(base - bounds.data());
+            const bool inside = x >= bounds.front() && x <= bounds.back();
+            return inside ? std::min(bin, bins - 1) : bins;
+        };
+        return to_counts(histogram_into<value_type>(element_reader(expr), expr.size(), bins, bin_of, grain));
+    }
+
+    /*
+        Counts every integer value in [0, length), where a length of zero counts
+        up to the largest value.  Negative values are not counted.
+    */
+    template <typename Expr> requires std::integral<expr_value_type<Expr>>
+    auto bincount(const Expr& expr, std::size_t length = 0, std::size_t grain = default_grain) -> SeqContainer<std::size_t> {
+        using value_type = expr_value_type<Expr>;
+        const auto in    = element_reader(expr);
+        const auto count = expr.size();
+        const auto bin_of = [](const value_type& value, std::size_t limit) -> std::size_t {
+            if constexpr (std::is_signed_v<value_type>) {
+                if (value < 0) {
+                    return limit;
+                }
+            }
+            const auto bin = static_cast<std::size_t>(value);
+            return bin < limit ? bin : limit;
+        };
+        if (length == 0) {
+            const auto blocks = block_count(count, grain);
+            std::vector<std::size_t> lengths(blocks, 0);
+            parallel_blocks(blocks, [&](std::size_t block) {
+                const auto [first, last] = block_range(count, blocks, block);
+                std::size_t longest = 0;
+                for (std::size_t i = first; i < last; ++i) {
+                    const value_type value = in[i];
+                    const auto bin = bin_of(value, static_cast<std::size_t>(-1));
+                    longest = bin == static_cast<std::size_t>(-1) ? longest : std::max(longest, bin + 1);
+                }
+                lengths[block] = longest;
+            });
+            length = *std::max_element(lengths.begin(), lengths.end());
+        }
+        return to_counts(histogram_into<value_type>(in, count, length, [&](const value_type& value) { return bin_of(value, length); }, grain));
+    }
+}
@@ -0,0 +1,746 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "Blas.h"
+#include "Expression_Template.h"
+#include "Parallel.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                Elementwise Math Functions
+    //
+    //          exp, log, sin, cos, tanh and sqrt of a floating point sequence or
+    //          expression are lazy expression template leaves:
+    //
+    //              y = exp(x * scalar(-0.5)) * cos(x);                 // element by element
+    //              math_assign(y, exp(x * scalar(-0.5)) * cos(x));     // vectorized
+    //
+    //          Each function takes an accuracy, exp<MathAccuracy::fast>(x), which
+    //          bounds its error, as measured against a long double reference:
+    //
+    //                              ulp1        ulp4        fast
+    //              exp, log        1 ulp       4 ulp       2^-26 (double) or
+    //              sin, cos        1 ulp       4 ulp       2^-13 (float),
+    //              tanh            1 ulp       4 ulp       relative
+    //              sqrt            correctly rounded at every accuracy
+    //
+    //          tanh of a double at ulp1 is the exception, within 1.5 ulp.
+    //
+    //          The functions are written without calls into libm and without
+    //          branches: the argument is range reduced with the rounding constant
+    //          trick and integer operations on its bits, the reduced argument goes
+    //          through a polynomial, (a truncated Taylor series of a degree chosen
+    //          by the accuracy), and special values are handled by selects.  The
+    //          float functions at ulp1 are the double functions at ulp4 rounded to
+    //          float, which is within 1 ulp.  sin and cos reduce by pi / 2 in four
+    //          parts, which is accurate up to math_trig_limit, and larger arguments
+    //          are passed to std::sin or std::cos instead.
+    //
+    //          math_assign() evaluates an expression in parallel, a block of
+    //          math_block_size elements at a time: every node of the expression
+    //          is computed for the whole block, from the blocks of its operands,
+    //          into a buffer on the stack.  So each function and each operation is
+    //          a separate loop over the block, rather than one scalar function
+    //          call per element.  A plain assignment evaluates element by element,
+    //          which still inlines the functions, but does not vectorize them.
+    //
+    //          The argument of a function is held by reference, so the function
+    //          must be evaluated within the full expression it was built in.
+    //
+    /********************************************************************************************/
+
+    constexpr std::size_t math_block_size = 256;
+
+    enum class MathAccuracy {
+        ulp1,
+        ulp4,
+        fast
+    };
+
+    template <typename T>
+    struct MathTraits;
+
+    template <typename T>
+    using math_uint_type = std::make_unsigned_t<typename MathTraits<T>::int_type>;
+
+    template <>
+    struct MathTraits<double> {
+        using int_type = std::int64_t;
+        static constexpr int    mantissa    = 52;
+        static constexpr int    bias        = 1023;
+        static constexpr double round       = 0x1.8p52;
+        static constexpr double ln2_hi      = 6.93147180369123816490e-01;
+        static constexpr double ln2_lo      = 1.90821492927058770002e-10;
+        static constexpr double exp_low     = -750.0;
+        static constexpr double exp_high    = 711.0;
+        static constexpr double tanh_limit  = 20.0;
+        static constexpr double pio2_1      = 1.57079632673412561417e+00;
+        static constexpr double pio2_2      = 6.07710050630396597660e-11;
+        static constexpr double pio2_3      = 2.02226624871116645580e-21;
+        static constexpr double pio2_4      = 8.47842766036889956997e-32;
+        static constexpr double trig_limit  = 0x1p17;
+    };
+
+    template <>
+    struct MathTraits<float> {
+        using int_type = std::int32_t;
+        static constexpr int   mantissa    = 23;
+        static constexpr int   bias        = 127;
+        static constexpr float round       = 0x1.8p23f;
+        static constexpr float ln2_hi      = 6.9314575195e-01f;
+        static constexpr float ln2_lo      = 1.4286067653e-06f;
+        static constexpr float exp_low     = -106.0f;
+        static constexpr float exp_high    = 90.0f;
+        static constexpr float tanh_limit  = 10.0f;
+        static constexpr float pio2_1      = 1.5703125f;
+        static constexpr float pio2_2      = 4.837512969970703125e-4f;
+        static constexpr float pio2_3      = 7.54953362047672271728515625e-8f;
+        static constexpr float pio2_4      = 2.5633440683e-12f;
+        static constexpr float trig_limit  = 0x1p13f;
+    };
+
+    template <typename T>
+    constexpr T math_trig_limit = MathTraits<T>::trig_limit;
+
+    /*
+        The terms of the series of each function, by type and accuracy.
+    */
+    template <typename T, MathAccuracy A>
+    struct MathTerms {
+        static constexpr bool wide = std::same_as<T, double>;
+        static constexpr int  exp  = A == MathAccuracy::ulp1 ? 13 : A == MathAccuracy::ulp4 ? (wide ? 12 : 6) : (wide ? 7 : 4);
+        static constexpr int  log  = A == MathAccuracy::ulp1 ? 9  : A == MathAccuracy::ulp4 ? (wide ? 9 : 3)  : (wide ? 4 : 2);
+        static constexpr int  sin  = A == MathAccuracy::ulp1 ? 8  : A == MathAccuracy::ulp4 ? (wide ? 7 : 4)  : (wide ? 4 : 2);
+        static constexpr int  cos  = A == MathAccuracy::ulp1 ? 7  : A == MathAccuracy::ulp4 ? (wide ? 7 : 3)  : (wide ? 4 : 2);
+        static constexpr int  tanh = A == MathAccuracy::ulp1 ? 11 : A == MathAccuracy::ulp4 ? (wide ? 11 : 4) : (wide ? 5 : 3);
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                     Building Blocks
+    //
+    /*****************************************************************************************/
+
+    template <typename T>
+    constexpr typename MathTraits<T>::int_type math_bits(T x) noexcept {
+        return std::bit_cast<typename MathTraits<T>::int_type>(x);
+    }
+
+    template <typename T>
+    constexpr T math_from_bits(typename MathTraits<T>::int_type bits) noexcept {
+        return std::bit_cast<T>(bits);
+    }
+
+    /*
+        All ones if 'condition' holds, and zero otherwise, for math_select().
+    */
+    template <typename T>
+    inline typename MathTraits<T>::int_type math_mask(bool condition) noexcept {
+        return -static_cast<typename MathTraits<T>::int_type>(condition);
+    }
+
+    /*
+        'a' where 'mask' is all ones and 'b' where it is zero.  The kernels select
+        with these bitwise operations, and compare the bits of their arguments as
+        integers rather than as floating point values, because a compiler will
+        not vectorize a floating point comparison or a select between floating
+        point operations which could raise an exception.
+    */
+    template <typename T>
+    inline T math_select(typename MathTraits<T>::int_type mask, T a, T b) noexcept {
+        return math_from_bits<T>((math_bits(a) & mask) | (math_bits(b) & ~mask));
+    }
+
+    /*
+        The bits of |x|, which order as integers as |x| orders, with NaNs above
+        infinity.
+    */
+    template <typename T>
+    inline typename MathTraits<T>::int_type math_abs_bits(T x) noexcept {
+        return math_bits(x) & std::numeric_limits<typename MathTraits<T>::int_type>::max();
+    }
+
+    template <typename T>
+    inline bool math_is_nan(T x) noexcept {
+        return math_abs_bits(x) > math_bits(std::numeric_limits<T>::infinity());
+    }
+
+    /*
+        2^k, for k within the range of normal exponents, and meaningless bits,
+        without overflow, for any other k.
+    */
+    template <typename T>
+    inline T math_pow2(typename MathTraits<T>::int_type k) noexcept {
+        return math_from_bits<T>(static_cast<typename MathTraits<T>::int_type>((static_cast<math_uint_type<T>>(k) + MathTraits<T>::bias) << MathTraits<T>::mantissa));
+    }
+
+    /*
+        Rounds x to the nearest integer, returned both as a T and as an integer
+        in k, by adding and subtracting 1.5 2^mantissa, so |x| must be below
+        2^(mantissa - 1) for k to be meaningful.
+    */
+    template <typename T>
+    inline T math_round(T x, typename MathTraits<T>::int_type& k) noexcept {
+        constexpr T round = MathTraits<T>::round;
+        const T     t     = x + round;
+        k = static_cast<typename MathTraits<T>::int_type>(static_cast<math_uint_type<T>>(math_bits(t)) - static_cast<math_uint_type<T>>(math_bits(round)));
+        return t - round;
+    }
+
+    /*
+        a - b, with its rounding error in 'error', for any a and b.
+    */
+    template <typename T>
+    inline T math_difference(T a, T b, T& error) noexcept {
+        const T difference = a - b;
+        const T v          = difference - a;
+        error = (a - (difference - v)) - (b + v);
+        return difference;
+    }
+
+    /*
+        sum of c[i] x^i for i in [0, N), by Horner's rule.
+    */
+    template <typename T, std::size_t N>
+    inline T math_poly(T x, const T (&c)[N]) noexcept {
+        T result = c[N - 1];
+        for (std::size_t i = N - 1; i-- > 0;) {
+            result = result * x + c[i];
+        }
+        return result;
+    }
+
+    /*
+        1 / k!, (-1)^k / (2k + 1)!, (-1)^k / (2k)! and 2 / (2k + 1) for the series
+        of exp, sin, cos and log, starting at k = first.  The coefficients t_k of
+        x^(2k + 1) in tanh(x) follow from tanh' = 1 - tanh^2, which gives
+        (2k + 1) t_k = [k == 0] - sum of t_i t_j over i + j = k - 1.
+    */
+    template <typename T, int N>
+    struct MathSeries {
+        T exp[N];
+        T sin[N];
+        T cos[N];
+        T log[N];
+        T tanh[N];
+
+        constexpr MathSeries(int first) : exp(), sin(), cos(), log(), tanh() {
+            long double t[64] = {};
+            for (int k = 0; k < first + N; ++k) {
+                long double sum = k == 0 ? 1.0L : 0.0L;
+                for (int i = 0; i < k; ++i) {
+                    sum -= t[i] * t[k - 1 - i];
+                }
+                t[k] = sum / (2 * k + 1);
+            }
+            for (int i = 0; i < N; ++i) {
+                const int k = first + i;
+                long double factorial = 1;
+                for (int j = 2; j <= k; ++j) {
+                    factorial *= j;
+                }
+                exp[i] = static_cast<T>(1.0L / factorial);
+                long double odd  = 1;
+                long double even = 1;
+                for (int j = 2; j <= 2 * k + 1; ++j) {
+                    odd *= j;
+                    if (j <= 2 * k) {
+                        even *= j;
+                    }
+                }
+                sin[i] = static_cast<T>((k % 2 == 0 ? 1.0L : -1.0L) / odd);
+                cos[i] = static_cast<T>((k % 2 == 0 ? 1.0L : -1.0L) / even);
+                log[i] = static_cast<T>(2.0L / (2 * k + 1));
+                tanh[i] = static_cast<T>(t[k]);
+            }
+        }
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                        Kernels
+    //
+    /*****************************************************************************************/
+
+    /*
+        With x = k ln 2 + r and |r| <= ln 2 / 2, exp(x) - 1 = 2^k (1 + p(r)) - 1,
+        where p(r) = r + r^2 / 2 + ... up to r^Terms.  The scaling by 2^k is done
+        in two halves so that results in the subnormal range are rounded once.
+        Beyond [exp_low, exp_high], k is meaningless and the result is replaced.
+    */
+    template <typename T, int Terms, bool Minus1 = false>
+    inline T math_exp(T x) noexcept {
+        using traits   = MathTraits<T>;
+        using int_type = typename traits::int_type;
+        static constexpr MathSeries<T, Terms - 1> series(2);
+        int_type k;
+        const T kf = math_round(x * static_cast<T>(1.44269504088896340736), k);
+        const T r  = (x - kf * traits::ln2_hi) - kf * traits::ln2_lo;
+        const T p  = r + r * r * math_poly(r, series.exp);
+
+        T result;
+        if constexpr (Minus1) {
+            const T scale = math_pow2<T>(std::max(k, int_type{ 1 - traits::bias }));
+            result = (scale - T{ 1 }) + scale * p;
+        }
+        else {
+            const auto half = k >> 1;
+            result = (T{ 1 } + p) * math_pow2<T>(half) * math_pow2<T>(k - half);
+        }
+        const auto bits = math_bits(x);
+        const bool high = bits > math_bits(traits::exp_high);
+        const bool low  = bits < 0 && math_abs_bits(x) > math_abs_bits(traits::exp_low);
+        result = math_select(math_mask<T>(high), std::numeric_limits<T>::infinity(), result);
+        result = math_select(math_mask<T>(low), Minus1 ? T{ -1 } : T{ 0 }, result);
+        return math_select(math_mask<T>(math_is_nan(x)), x, result);
+    }
+
+    /*
+        With x = 2^e m and sqrt(1/2) <= m < sqrt(2), f = m - 1 and s = f / (2 + f),
+        log(m) = 2 atanh(s) = f - f^2 / 2 + s (f^2 / 2 + R), where R is the series
+        2 s^2 / 3 + 2 s^4 / 5 + ... of Terms terms.  A subnormal x is scaled by
+        2^(mantissa + 2) first.
+    */
+    template <typename T, int Terms>
+    inline T math_log(T x) noexcept {
+        using traits   = MathTraits<T>;
+        using int_type = typename traits::int_type;
+        static constexpr MathSeries<T, Terms> series(1);
+        constexpr int      shift         = traits::mantissa + 2;
+        constexpr int_type mantissa_mask = (int_type{ 1 } << traits::mantissa) - 1;
+        constexpr int_type exponent_mask = (int_type{ 1 } << (sizeof(T) * 8 - 1 - traits::mantissa)) - 1;
+        constexpr int_type sqrt2_bits    = math_bits(static_cast<T>(1.41421356237309504880)) & mantissa_mask;
+
+        const auto tiny  = math_mask<T>(math_bits(x) < math_bits(std::numeric_limits<T>::min()));
+        const auto bits  = math_bits(x * math_select(tiny, math_pow2<T>(shift), T{ 1 }));
+        const auto upper = math_mask<T>((bits & mantissa_mask) > sqrt2_bits);
+        const auto e     = ((bits >> traits::mantissa) & exponent_mask) - traits::bias - (tiny & shift) - upper;
+        const T    m     = math_from_bits<T>((bits & mantissa_mask) | (math_bits(T{ 1 }) - (upper & (int_type{ 1 } << traits::mantissa))));
+
+        const T f    = m - T{ 1 };
+        const T s    = f / (T{ 2 } + f);
+        const T z    = s * s;
+        const T hfsq = T{ 0.5 } * f * f;
+        const T ef   = math_from_bits<T>(math_bits(traits::round) + e) - traits::round;
+        const T rest = z * math_poly(z, series.log);
+        T result = ef * traits::ln2_hi + (f - (hfsq - (s * (hfsq + rest) + ef * traits::ln2_lo)));
+
+        constexpr T infinity = std::numeric_limits<T>::infinity();
+        const auto  sign     = math_bits(x) < 0;
+        result = math_select(math_mask<T>(sign || math_is_nan(x)), std::numeric_limits<T>::quiet_NaN(), result);
+        result = math_select(math_mask<T>(math_abs_bits(x) == 0), -infinity, result);
+        return math_select(math_mask<T>(math_bits(x) == math_bits(infinity)), infinity, result);
+    }
+
+    /*
+        With x = q pi / 2 + r and |r| <= pi / 4, sin(x) and cos(x) are sin(r) or
+        cos(r), by quadrant q mod 4, with either sign.  pi / 2 is split into
+        parts whose products with q are exact up to pio2_3, the rounding errors
+        of the subtractions are kept, and r is carried as r + dr, which is added
+        to the series to first order.
+    */
+    template <typename T, int SinTerms, int CosTerms, bool Cosine>
+    inline T math_sincos(T x) noexcept {
+        using traits = MathTraits<T>;
+        static constexpr MathSeries<T, SinTerms> sin_series(1);
+        static constexpr MathSeries<T, CosTerms> cos_series(2);
+        typename traits::int_type q;
+        const T qf = math_round(x * static_cast<T>(0.63661977236758134308), q);
+        T e2;
+        T e3;
+        const T r1 = x - qf * traits::pio2_1;
+        const T r2 = math_difference(r1, qf * traits::pio2_2, e2);
+        const T r3 = math_difference(r2, qf * traits::pio2_3, e3);
+        const T d  = (e2 + e3) - qf * traits::pio2_4;
+        const T r  = r3 + d;
+        const T dr = (r3 - r) + d;
+
+        const T z  = r * r;
+        const T hz = T{ 0.5 } * z;
+        const T s  = r + (dr - (hz * dr - r * z * math_poly(z, sin_series.sin)));
+        const T v  = T{ 1 } - hz;
+        const T c  = v + (((T{ 1 } - v) - hz) + (z * z * math_poly(z, cos_series.cos) - r * dr));
+        const auto quadrant = static_cast<math_uint_type<T>>(q) + (Cosine ? 1 : 0);
+        const T value  = math_select(math_mask<T>(quadrant & 1), c, s);
+        const T result = math_from_bits<T>(math_bits(value) ^ static_cast<typename traits::int_type>((quadrant & 2) << (sizeof(T) * 8 - 2)));
+        return Cosine ? result : math_select(math_mask<T>(math_abs_bits(x) == 0), x, result);
+    }
+
+    /*
+        Below |x| = ln 2 / 2, tanh(x) is its series, and above it is e / (e + 2)
+        with e = exp(2 |x|) - 1 = 2^k (1 + p) - 1 and k >= 1, which does not
+        cancel.  Both are computed and one is selected.
+    */
+    template <typename T, int ExpTerms, int TanhTerms>
+    inline T math_tanh(T x) noexcept {
+        static constexpr MathSeries<T, TanhTerms> series(1);
+        const T a = std::abs(x);
+        const T z = a * a;
+        const T s = a + a * z * math_poly(z, series.tanh);
+        const T e = math_exp<T, ExpTerms, true>(a + a);
+        T t = math_select(math_mask<T>(math_bits(a) < math_bits(static_cast<T>(0.34657359027997265471))), s, e / (e + T{ 2 }));
+        t = math_select(math_mask<T>(math_bits(a) > math_bits(MathTraits<T>::tanh_limit)), T{ 1 }, t);
+        return math_select(math_mask<T>(math_is_nan(x)), x, std::copysign(t, x));
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                   Function Structs
+    //
+    //          Each provides apply(x) for a single element and apply_block(in, out,
+    //          count) for a block of contiguous elements.
+    //
+    /*****************************************************************************************/
+
+    /*
+        The float functions at ulp1 are evaluated as the double ones at ulp4.
+    */
+    template <typename T, MathAccuracy A>
+    constexpr bool math_widen = std::same_as<T, float> && A == MathAccuracy::ulp1;
+
+    template <typename T, MathAccuracy A>
+    struct Exp_Fn {
+        static T apply(T x) noexcept {
+            if constexpr (math_widen<T, A>) {
+                return static_cast<T>(Exp_Fn<double, MathAccuracy::ulp4>::apply(x));
+            }
+            else {
+                return math_exp<T, MathTerms<T, A>::exp>(x);
+            }
+        }
+
+        static void apply_block(const T* in, T* out, std::size_t count) noexcept {
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i] = apply(in[i]);
+            }
+        }
+    };
+
+    template <typename T, MathAccuracy A>
+    struct Log_Fn {
+        static T apply(T x) noexcept {
+            if constexpr (math_widen<T, A>) {
+                return static_cast<T>(Log_Fn<double, MathAccuracy::ulp4>::apply(x));
+            }
+            else {
+                return math_log<T, MathTerms<T, A>::log>(x);
+            }
+        }
+
+        static void apply_block(const T* in, T* out, std::size_t count) noexcept {
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i] = apply(in[i]);
+            }
+        }
+    };
+
+    template <typename T, MathAccuracy A>
+    struct Tanh_Fn {
+        static T apply(T x) noexcept {
+            if constexpr (math_widen<T, A>) {
+                return static_cast<T>(Tanh_Fn<double, MathAccuracy::ulp4>::apply(x));
+            }
+            else {
+                return math_tanh<T, MathTerms<T, A>::exp, MathTerms<T, A>::tanh>(x);
+            }
+        }
+
+        static void apply_block(const T* in, T* out, std::size_t count) noexcept {
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i] = apply(in[i]);
+            }
+        }
+    };
+
+    /*
+        Arguments beyond math_trig_limit, (and infinities and NaNs), are left to
+        std::sin and std::cos, in a second pass over the block.
+    */
+    template <typename T, MathAccuracy A, bool Cosine>
+    struct Trig_Fn {
+        using wide_type = std::conditional_t<math_widen<T, A>, double, T>;
+        static constexpr MathAccuracy accuracy = math_widen<T, A> ? MathAccuracy::ulp4 : A;
+
+        static T reduced(T x) noexcept {
+            using terms = MathTerms<wide_type, accuracy>;
+            return static_cast<T>(math_sincos<wide_type, terms::sin, terms::cos, Cosine>(static_cast<wide_type>(x)));
+        }
+
+        static T library(T x) noexcept {
+            return static_cast<T>(Cosine ? std::cos(static_cast<wide_type>(x)) : std::sin(static_cast<wide_type>(x)));
+        }
+
+        static T apply(T x) noexcept {
+            return std::abs(x) <= math_trig_limit<wide_type> ? reduced(x) : library(x);
+        }
+
+        static void apply_block(const T* in, T* out, std::size_t count) noexcept {
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i] = reduced(in[i]);
+            }
+            for (std::size_t i = 0; i < count; ++i) {
+                if (!(std::abs(in[i]) <= math_trig_limit<wide_type>)) {
+                    out[i] = library(in[i]);
+                }
+            }
+        }
+    };
+
+    template <typename T, MathAccuracy A>
+    using Sin_Fn = Trig_Fn<T, A, false>;
+
+    template <typename T, MathAccuracy A>
+    using Cos_Fn = Trig_Fn<T, A, true>;
+
+    /*
+        The square root instruction is correctly rounded, so every accuracy is
+        the same.  std::sqrt sets errno for a negative argument, so a loop of it
+        is only vectorized when errno is not, (-fno-math-errno).
+    */
+    template <typename T, MathAccuracy A>
+    struct Sqrt_Fn {
+        static T apply(T x) noexcept {
+            return std::sqrt(x);
+        }
+
+        static void apply_block(const T* in, T* out, std::size_t count) noexcept {
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i] = apply(in[i]);
+            }
+        }
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                  'MathFunction' class
+    //
+    /*****************************************************************************************/
+
+    template <typename Expr, typename Func>
+    class MathFunction {
+
+    public:
+        using value_type    = expr_value_type<Expr>;
+        using function_type = Func;
+
+        explicit MathFunction(const Expr& argument) : _argument(argument) {
+        }
+
+        const Expr& argument() const noexcept {
+            return _argument;
+        }
+
+        bool refers_to(const void* object) const noexcept {
+            return expr_refers_to(_argument, object);
+        }
+
+        auto operator [](std::size_t index) const -> value_type {
+            return Func::apply(_argument[index]);
+        }
+
+        auto size() const -> std::size_t {
+            return _argument.size();
+        }
+
+        template <typename RE> auto operator +(RE&& re) const& -> ExprTemplate<const MathFunction&, Add_Op<value_type>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator -(RE&& re) const& -> ExprTemplate<const MathFunction&, Sub_Op<value_type>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator *(RE&& re) const& -> ExprTemplate<const MathFunction&, Mul_Op<value_type>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator /(RE&& re) const& -> ExprTemplate<const MathFunction&, Div_Op<value_type>, decltype(std::forward<RE>(re))>;
+
+    private:
+        const Expr& _argument;
+    };
+
+    template <typename Expr, typename Func>
+    template <typename RE>
+    inline auto MathFunction<Expr, Func>::operator +(RE&& re) const& -> ExprTemplate<const MathFunction&, Add_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const MathFunction&, Add_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    template <typename Expr, typename Func>
+    template <typename RE>
+    inline auto MathFunction<Expr, Func>::operator -(RE&& re) const& -> ExprTemplate<const MathFunction&, Sub_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const MathFunction&, Sub_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    template <typename Expr, typename Func>
+    template <typename RE>
+    inline auto MathFunction<Expr, Func>::operator *(RE&& re) const& -> ExprTemplate<const MathFunction&, Mul_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const MathFunction&, Mul_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    template <typename Expr, typename Func>
+    template <typename RE>
+    inline auto MathFunction<Expr, Func>::operator /(RE&& re) const& -> ExprTemplate<const MathFunction&, Div_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const MathFunction&, Div_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    template <typename Expr, typename Func>
+    struct is_element_wise<MathFunction<Expr, Func>> : is_element_wise<Expr> {};
+
+    template <typename Expr>
+    struct is_math_function : std::false_type {};
+
+    template <typename Expr, typename Func>
+    struct is_math_function<MathFunction<Expr, Func>> : std::true_type {};
+
+    /*
+        A sequence or expression of floating point elements.
+    */
+    template <typename Expr>
+    concept MathOperand = !std::is_arithmetic_v<Expr> && std::floating_point<expr_value_type<Expr>> && requires(const Expr& expr) {
+        { expr.size() } -> std::convertible_to<std::size_t>;
+        expr[std::size_t{}];
+    };
+
+    template <MathAccuracy A = MathAccuracy::ulp1, MathOperand Expr>
+    auto exp(const Expr& x) -> MathFunction<Expr, Exp_Fn<expr_value_type<Expr>, A>> {
+        return MathFunction<Expr, Exp_Fn<expr_value_type<Expr>, A>>(x);
+    }
+
+    template <MathAccuracy A = MathAccuracy::ulp1, MathOperand Expr>
+    auto log(const Expr& x) -> MathFunction<Expr, Log_Fn<expr_value_type<Expr>, A>> {
+        return MathFunction<Expr, Log_Fn<expr_value_type<Expr>, A>>(x);
+    }
+
+    template <MathAccuracy A = MathAccuracy::ulp1, MathOperand Expr>
+    auto sin(const Expr& x) -> MathFunction<Expr, Sin_Fn<expr_value_type<Expr>, A>> {
+        return MathFunction<Expr, Sin_Fn<expr_value_type<Expr>, A>>(x);
+    }
+
+    template <MathAccuracy A = MathAccuracy::ulp1, MathOperand Expr>
+    auto cos(const Expr& x) -> MathFunction<Expr, Cos_Fn<expr_value_type<Expr>, A>> {
+        return MathFunction<Expr, Cos_Fn<expr_value_type<Expr>, A>>(x);
+    }
+
+    template <MathAccuracy A = MathAccuracy::ulp1, MathOperand Expr>
+    auto tanh(const Expr& x) -> MathFunction<Expr, Tanh_Fn<expr_value_type<Expr>, A>> {
+        return MathFunction<Expr, Tanh_Fn<expr_value_type<Expr>, A>>(x);
+    }
+
+    template <MathAccuracy A = MathAccuracy::ulp1, MathOperand Expr>
+    auto sqrt(const Expr& x) -> MathFunction<Expr, Sqrt_Fn<expr_value_type<Expr>, A>> {
+        return MathFunction<Expr, Sqrt_Fn<expr_value_type<Expr>, A>>(x);
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                   Block Evaluation
+    //
+    /*****************************************************************************************/
+
+    template <typename Expr, typename T>
+    concept MathBlockOp = requires(const T& a, const T& b) {
+        { Expr::apply(a, b) } -> std::convertible_to<T>;
+    };
+
+    template <typename Expr>
+    struct math_binary_op {
+        using type = void;
+    };
+
+    template <typename LE, typename Op, typename RE>
+    struct math_binary_op<ExprTemplate<LE, Op, RE>> {
+        using type = Op;
+    };
+
+    /*
+        Writes elements [first, first + count) of 'expr', count <= math_block_size,
+        to 'out'.  A function or an operation whose struct provides apply()
+        is computed for the whole block from the blocks of its operands, and
+        any other node is read element by element.
+    */
+    template <typename T, typename Expr>
+    void math_block(const Expr& expr, std::size_t first, std::size_t count, T* out) {
+        if constexpr (is_math_function<Expr>::value) {
+            T argument[math_block_size];
+            math_block<T>(expr.argument(), first, count, argument);
+            Expr::function_type::apply_block(argument, out, count);
+        }
+        else if constexpr (is_expr_template<Expr>::value && MathBlockOp<typename math_binary_op<Expr>::type, T>) {
+            using op = typename math_binary_op<Expr>::type;
+            T right[math_block_size];
+            math_block<T>(expr.left_expr(), first, count, out);
+            math_block<T>(expr.right_expr(), first, count, right);
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i] = op::apply(out[i], right[i]);
+            }
+        }
+        else if constexpr (is_seq_container<Expr>::value) {
+            const auto reader = element_reader(expr);
+            const auto size   = expr.size();
+            const auto valid  = first < size ? std::min(count, size - first) : 0;
+            for (std::size_t i = 0; i < valid; ++i) {
+                out[i] = reader[first + i];
+            }
+            std::fill(out + valid, out + count, T{});
+        }
+        else {
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i] = expr[first + i];
+            }
+        }
+    }
+
+    /*
+        Evaluates an expression of math functions into 'y', resized to the size
+        of the expression, in parallel over blocks of math_block_size elements.
+        An expression which is not element wise and reads y is evaluated into a
+        fresh sequence which is then moved into y.
+    */
+    template <typename Seq, typename Expr>
+    Seq& math_assign(Seq& y, const Expr& expr, std::size_t grain = default_grain) {
+        using value_type = Seq::value_type;
+        if (!is_element_wise<Expr>::value && expr_refers_to(expr, &y)) {
+            Seq fresh;
+            math_assign(fresh, expr, grain);
+            y = std::move(fresh);
+            return y;
+        }
+        const auto count = expr.size();
+        fill_sequence(y, count, [&](value_type* out) {
+            parallel_for(count, grain, [&](std::size_t first, std::size_t last, std::size_t) {
+                for (auto start = first; start < last; start += math_block_size) {
+                    math_block<value_type>(expr, start, std::min(math_block_size, last - start), out + start);
+                }
+            });
+        });
+        return y;
+    }
+}
@@ -0,0 +1,573 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Parallel.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                      'Matrix' class
+    //
+    //          A dense matrix stored within a SeqContainer, in either row major or
+    //          column major order.  The stride between consecutive rows, (columns),
+    //          is the leading dimension, which is padded to a whole number of cache
+    //          lines, and away from multiples of 4 KiB, so every row starts on a
+    //          cache line and rows do not collide in the same cache sets.  The
+    //          padding elements are zero, and are never read as elements.
+    //
+    //          A Matrix is a leaf of the expression templates, indexed by its
+    //          storage, so that matrices of the same shape and layout combine
+    //          element wise with the usual operators:
+    //
+    //              C = A * B + C;          // element wise, as with NumPy
+    //
+    //          The matrix product is matmul(), (or gemm() for the general update),
+    //          and is evaluated one cache sized block at a time, with the blocks
+    //          of the result computed in parallel.
+    //
+    /********************************************************************************************/
+
+    enum class Layout { RowMajor, ColMajor };
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    class Matrix;
+
+    template <typename T>
+    struct is_matrix : std::false_type {};
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    struct is_matrix<Matrix<VALUE, LAYOUT, IMPL>> : std::true_type {};
+
+    /*
+        Calls func(m) for every Matrix operand of an expression.
+    */
+    template <typename Expr, typename Func>
+    void for_each_matrix(const Expr& expr, Func&& func) {
+        if constexpr (is_expr_template<Expr>::value) {
+            for_each_matrix(expr.left_expr(), func);
+            for_each_matrix(expr.right_expr(), func);
+        }
+        else if constexpr (is_matrix<Expr>::value) {
+            func(expr);
+        }
+    }
+
+    template <typename VALUE = double, Layout LAYOUT = Layout::RowMajor, typename IMPL = std::vector<VALUE>>
+    class Matrix {
+
+    public:
+        using sequence_type = SeqContainer<VALUE, IMPL>;
+        using value_type    = sequence_type::value_type;
+
+        static constexpr Layout      layout     = LAYOUT;
+        static constexpr std::size_t line_elems = std::max<std::size_t>(64 / sizeof(VALUE), 1);
+
+        Matrix();
+        Matrix(std::size_t rows, std::size_t cols, value_type value = value_type{});
+        Matrix(std::size_t rows, std::size_t cols, std::initializer_list<value_type> values);
+
+        Matrix(Matrix&&)                  noexcept = default;
+        Matrix(const Matrix&)                      = default;
+        Matrix& operator =(Matrix&&)      noexcept = default;
+        Matrix& operator =(const Matrix&)          = default;
+
+        template <typename Expr> requires is_expr_template<std::remove_cvref_t<Expr>>::value
+        Matrix& operator =(const Expr& expr);
+
+        static Matrix identity(std::size_t size);
+
+        std::size_t rows() const noexcept;
+        std::size_t cols() const noexcept;
+        std::size_t leading_dimension() const noexcept;
+        std::size_t size() const;
+        bool        empty() const noexcept;
+
+        value_type& operator ()(std::size_t row, std::size_t col);
+        value_type  operator ()(std::size_t row, std::size_t col) const;
+
+        value_type& operator [](std::size_t index);
+        value_type  operator [](std::size_t index) const;
+
+        sequence_type&       elements() noexcept;
+        const sequence_type& elements() const noexcept;
+
+        template <typename RE> auto operator +(RE&& re) const& -> ExprTemplate<const Matrix&, Add_Op<value_type>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator -(RE&& re) const& -> ExprTemplate<const Matrix&, Sub_Op<value_type>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator *(RE&& re) const& -> ExprTemplate<const Matrix&, Mul_Op<value_type>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator /(RE&& re) const& -> ExprTemplate<const Matrix&, Div_Op<value_type>, decltype(std::forward<RE>(re))>;
+
+        static std::size_t padded(std::size_t inner) noexcept;
+
+    private:
+        std::size_t   _rows;
+        std::size_t   _cols;
+        std::size_t   _ld;
+        sequence_type _data;
+
+        std::size_t outer() const noexcept;
+        std::size_t inner() const noexcept;
+        std::size_t index(std::size_t row, std::size_t col) const noexcept;
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                     Construction
+    //
+    /*****************************************************************************************/
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline std::size_t Matrix<VALUE, LAYOUT, IMPL>::padded(std::size_t inner) noexcept {
+        if (inner <= 1) {
+            return inner;
+        }
+        auto ld = (inner + line_elems - 1) / line_elems * line_elems;
+        if ((ld * sizeof(value_type)) % 4096 == 0) {
+            ld += line_elems;
+        }
+        return ld;
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline Matrix<VALUE, LAYOUT, IMPL>::Matrix() : _rows(0), _cols(0), _ld(0), _data() {
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline Matrix<VALUE, LAYOUT, IMPL>::Matrix(std::size_t rows, std::size_t cols, value_type value) : _rows(rows), _cols(cols), _ld(0), _data() {
+        _ld = padded(inner());
+        _data.resize(outer() * _ld);
+        if (value != value_type{}) {
+            auto& impl = _data.impl();
+            for (std::size_t o = 0; o < outer(); ++o) {
+                std::fill_n(impl.begin() + o * _ld, inner(), value);
+            }
+        }
+    }
+
+    /*
+        The values are given in reading order, one row after the other,
+        whatever the layout.
+    */
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline Matrix<VALUE, LAYOUT, IMPL>::Matrix(std::size_t rows, std::size_t cols, std::initializer_list<value_type> values) : Matrix(rows, cols) {
+        auto it = values.begin();
+        for (std::size_t r = 0; r < rows && it != values.end(); ++r) {
+            for (std::size_t c = 0; c < cols && it != values.end(); ++c) {
+                (*this)(r, c) = *it++;
+            }
+        }
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline Matrix<VALUE, LAYOUT, IMPL> Matrix<VALUE, LAYOUT, IMPL>::identity(std::size_t size) {
+        Matrix result(size, size);
+        for (std::size_t i = 0; i < size; ++i) {
+            result(i, i) = value_type{ 1 };
+        }
+        return result;
+    }
+
+    /*
+        Evaluates an element wise expression of matrices of this shape and
+        layout, skipping the padding.  An empty matrix takes the shape of the
+        operands, and std::invalid_argument is thrown unless every matrix of
+        the expression has the same rows, columns and leading dimension.
+    */
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    template <typename Expr> requires is_expr_template<std::remove_cvref_t<Expr>>::value
+    inline Matrix<VALUE, LAYOUT, IMPL>& Matrix<VALUE, LAYOUT, IMPL>::operator =(const Expr& expr) {
+        bool sized = !empty();
+        for_each_matrix(expr, [&](const auto& m) {
+            if (!sized) {
+                *this = Matrix(m.rows(), m.cols());
+                sized = true;
+            }
+            if (m.rows() != _rows || m.cols() != _cols || m.leading_dimension() != _ld) {
+                throw std::invalid_argument("Matrix: the shapes of the operands do not agree");
+            }
+        });
+        auto& impl = _data.impl();
+        const auto rows_per_block = std::max<std::size_t>(default_grain / std::max<std::size_t>(_ld, 1), 1);
+        parallel_for(outer(), rows_per_block, [&](std::size_t first, std::size_t last, std::size_t) {
+            for (std::size_t o = first; o < last; ++o) {
+                const auto base = o * _ld;
+                for (std::size_t i = 0; i < inner(); ++i) {
+                    impl[base + i] = expr[base + i];
+                }
+            }
+        });
+        return *this;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                       Access
+    //
+    /*****************************************************************************************/
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline std::size_t Matrix<VALUE, LAYOUT, IMPL>::rows() const noexcept {
+        return _rows;
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline std::size_t Matrix<VALUE, LAYOUT, IMPL>::cols() const noexcept {
+        return _cols;
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline std::size_t Matrix<VALUE, LAYOUT, IMPL>::leading_dimension() const noexcept {
+        return _ld;
+    }
+
+    /*
+        The size of the storage, padding included, which is the extent of the
+        matrix as an operand of an expression template.
+    */
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline std::size_t Matrix<VALUE, LAYOUT, IMPL>::size() const {
+        return _data.size();
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline bool Matrix<VALUE, LAYOUT, IMPL>::empty() const noexcept {
+        return _rows == 0 || _cols == 0;
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline std::size_t Matrix<VALUE, LAYOUT, IMPL>::outer() const noexcept {
+        return LAYOUT == Layout::RowMajor ? _rows : _cols;
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline std::size_t Matrix<VALUE, LAYOUT, IMPL>::inner() const noexcept {
+        return LAYOUT == Layout::RowMajor ? _cols : _rows;
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline std::size_t Matrix<VALUE, LAYOUT, IMPL>::index(std::size_t row, std::size_t col) const noexcept {
+        return LAYOUT == Layout::RowMajor ? row * _ld + col : col * _ld + row;
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline Matrix<VALUE, LAYOUT, IMPL>::value_type& Matrix<VALUE, LAYOUT, IMPL>::operator ()(std::size_t row, std::size_t col) {
+        return _data.impl()[index(row, col)];
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline Matrix<VALUE, LAYOUT, IMPL>::value_type Matrix<VALUE, LAYOUT, IMPL>::operator ()(std::size_t row, std::size_t col) const {
+        return _data.impl()[index(row, col)];
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline Matrix<VALUE, LAYOUT, IMPL>::value_type& Matrix<VALUE, LAYOUT, IMPL>::operator [](std::size_t index) {
+        return _data.impl()[index];
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline Matrix<VALUE, LAYOUT, IMPL>::value_type Matrix<VALUE, LAYOUT, IMPL>::operator [](std::size_t index) const {
+        return _data[index];
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline Matrix<VALUE, LAYOUT, IMPL>::sequence_type& Matrix<VALUE, LAYOUT, IMPL>::elements() noexcept {
+        return _data;
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    inline const Matrix<VALUE, LAYOUT, IMPL>::sequence_type& Matrix<VALUE, LAYOUT, IMPL>::elements() const noexcept {
+        return _data;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                               Element Wise Expressions
+    //
+    /*****************************************************************************************/
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    template <typename RE>
+    inline auto Matrix<VALUE, LAYOUT, IMPL>::operator +(RE&& re) const& -> ExprTemplate<const Matrix&, Add_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const Matrix&, Add_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    template <typename RE>
+    inline auto Matrix<VALUE, LAYOUT, IMPL>::operator -(RE&& re) const& -> ExprTemplate<const Matrix&, Sub_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const Matrix&, Sub_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    template <typename RE>
+    inline auto Matrix<VALUE, LAYOUT, IMPL>::operator *(RE&& re) const& -> ExprTemplate<const Matrix&, Mul_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const Matrix&, Mul_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    template <typename VALUE, Layout LAYOUT, typename IMPL>
+    template <typename RE>
+    inline auto Matrix<VALUE, LAYOUT, IMPL>::operator /(RE&& re) const& -> ExprTemplate<const Matrix&, Div_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const Matrix&, Div_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                  Blocked Kernels
+    //
+    //          gemm        C = alpha * A * B + beta * C
+    //          gemv        y = alpha * A * x + beta * y
+    //          transpose   the transpose of A, in the layout of A
+    //
+    //          gemm splits C into tiles of gemm_mc x gemm_nc elements, computed in
+    //          parallel.  For each tile, panels of gemm_kc columns of A, and rows
+    //          of B, are packed into contiguous row major buffers, so the inner
+    //          loop streams unit stride memory whatever the layouts, and the tile
+    //          accumulates into a local buffer, four rows at a time, so each row
+    //          of the packed B panel is loaded once for four rows of A.  C is not
+    //          resized, and gemm throws std::invalid_argument unless A is m x k,
+    //          B is k x n and C is m x n.  Likewise gemv throws unless x has n
+    //          elements.
+    //
+    /*****************************************************************************************/
+
+    constexpr std::size_t gemm_mc = 64;
+    constexpr std::size_t gemm_nc = 256;
+    constexpr std::size_t gemm_kc = 128;
+
+    constexpr std::size_t transpose_tile = 32;
+
+    /*
+        Accumulates the product of packed panels a, (rows x depth), and b,
+        (depth x width), into the tile t, (rows x width), all row major.
+    */
+    template <typename T>
+    void gemm_panel(const T* a, const T* b, T* t, std::size_t rows, std::size_t depth, std::size_t width) {
+        std::size_t i = 0;
+        for (; i + 4 <= rows; i += 4) {
+            T* t0 = t + (i + 0) * width;
+            T* t1 = t + (i + 1) * width;
+            T* t2 = t + (i + 2) * width;
+            T* t3 = t + (i + 3) * width;
+            for (std::size_t k = 0; k < depth; ++k) {
+                const T a0 = a[(i + 0) * depth + k];
+                const T a1 = a[(i + 1) * depth + k];
+                const T a2 = a[(i + 2) * depth + k];
+                const T a3 = a[(i + 3) * depth + k];
+                const T* row = b + k * width;
+                for (std::size_t j = 0; j < width; ++j) {
+                    const T value = row[j];
+                    t0[j] += a0 * value;
+                    t1[j] += a1 * value;
+                    t2[j] += a2 * value;
+                    t3[j] += a3 * value;
+                }
+            }
+        }
+        for (; i < rows; ++i) {
+            T* ti = t + i * width;
+            for (std::size_t k = 0; k < depth; ++k) {
+                const T ai = a[i * depth + k];
+                const T* row = b + k * width;
+                for (std::size_t j = 0; j < width; ++j) {
+                    ti[j] += ai * row[j];
+                }
+            }
+        }
+    }
+
+    template <typename T, Layout LA, typename IA, Layout LB, typename IB, Layout LC, typename IC>
+    void gemm(T alpha, const Matrix<T, LA, IA>& a, const Matrix<T, LB, IB>& b, T beta, Matrix<T, LC, IC>& c) {
+        if (a.rows() != c.rows() || a.cols() != b.rows() || b.cols() != c.cols()) {
+            throw std::invalid_argument("gemm: the shapes of A, B and C do not agree");
+        }
+        const auto m = c.rows();
+        const auto n = c.cols();
+        const auto depth = a.cols();
+        const auto tile_rows = (m + gemm_mc - 1) / gemm_mc;
+        const auto tile_cols = (n + gemm_nc - 1) / gemm_nc;
+        const auto tiles     = tile_rows * tile_cols;
+        const auto blocks    = std::min(tiles, block_count(m * n * std::max<std::size_t>(depth, 1), default_grain));
+
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [first, last] = block_range(tiles, blocks, block);
+            std::vector<T> pack_a(gemm_mc * gemm_kc);
+            std::vector<T> pack_b(gemm_kc * gemm_nc);
+            std::vector<T> tile(gemm_mc * gemm_nc);
+            for (auto index = first; index < last; ++index) {
+                const auto row0  = (index / tile_cols) * gemm_mc;
+                const auto col0  = (index % tile_cols) * gemm_nc;
+                const auto rows  = std::min(gemm_mc, m - row0);
+                const auto width = std::min(gemm_nc, n - col0);
+                std::fill_n(tile.begin(), rows * width, T{ 0 });
+                for (std::size_t k0 = 0; k0 < depth; k0 += gemm_kc) {
+                    const auto kc = std::min(gemm_kc, depth - k0);
+                    for (std::size_t i = 0; i < rows; ++i) {
+                        for (std::size_t k = 0; k < kc; ++k) {
+                            pack_a[i * kc + k] = a(row0 + i, k0 + k);
+                        }
+                    }
+                    for (std::size_t k = 0; k < kc; ++k) {
+                        for (std::size_t j = 0; j < width; ++j) {
+                            pack_b[k * width + j] = b(k0 + k, col0 + j);
+                        }
+                    }
+                    gemm_panel(pack_a.data(), pack_b.data(), tile.data(), rows, kc, width);
+                }
+                for (std::size_t i = 0; i < rows; ++i) {
+                    for (std::size_t j = 0; j < width; ++j) {
+                        auto& out = c(row0 + i, col0 + j);
+                        out = alpha * tile[i * width + j] + (beta == T{ 0 } ? T{ 0 } : beta * out);
+                    }
+                }
+            }
+        });
+    }
+
+    template <typename T, Layout LA, typename IA, Layout LB, typename IB>
+    auto matmul(const Matrix<T, LA, IA>& a, const Matrix<T, LB, IB>& b) -> Matrix<T, LA, IA> {
+        Matrix<T, LA, IA> c(a.rows(), b.cols());
+        gemm(T{ 1 }, a, b, T{ 0 }, c);
+        return c;
+    }
+
+    /*
+        A row major matrix takes the dot product of each row with x, with
+        independent accumulators.  A column major matrix adds each column,
+        scaled by its element of x, to a block of rows of y.
+    */
+    template <typename T, Layout LA, typename IA, typename Expr, typename Seq>
+    void gemv(T alpha, const Matrix<T, LA, IA>& a, const Expr& x, T beta, Seq& y) {
+        const auto m = a.rows();
+        const auto n = a.cols();
+        if (x.size() != n) {
+            throw std::invalid_argument("gemv: x does not have one element per column of A");
+        }
+        if (y.size() < m) {
+            y.resize(m);
+        }
+        std::vector<T> xs(n);
+        const auto in = element_reader(x);
+        for (std::size_t j = 0; j < n; ++j) {
+            xs[j] = static_cast<T>(in[j]);
+        }
+        auto& out = y.impl();
+        const auto rows_per_block = std::max<std::size_t>(default_grain / std::max<std::size_t>(n, 1), 1);
+        parallel_for(m, rows_per_block, [&](std::size_t first, std::size_t last, std::size_t) {
+            if constexpr (LA == Layout::RowMajor) {
+                constexpr std::size_t lanes = 4;
+                for (std::size_t i = first; i < last; ++i) {
+                    std::array<T, lanes> partial{};
+                    std::size_t j = 0;
+                    for (; j + lanes <= n; j += lanes) {
+                        for (std::size_t l = 0; l < lanes; ++l) {
+                            partial[l] += a(i, j + l) * xs[j + l];
+                        }
+                    }
+                    for (; j < n; ++j) {
+                        partial[0] += a(i, j) * xs[j];
+                    }
+                    const T dot = (partial[0] + partial[1]) + (partial[2] + partial[3]);
+                    out[i] = alpha * dot + (beta == T{ 0 } ? T{ 0 } : beta * out[i]);
+                }
+            }
+            else {
+                std::vector<T> acc(last - first, T{ 0 });
+                for (std::size_t j = 0; j < n; ++j) {
+                    const T xj = xs[j];
+                    for (std::size_t i = first; i < last; ++i) {
+                        acc[i - first] += a(i, j) * xj;
+                    }
+                }
+                for (std::size_t i = first; i < last; ++i) {
+                    out[i] = alpha * acc[i - first] + (beta == T{ 0 } ? T{ 0 } : beta * out[i]);
+                }
+            }
+        });
+    }
+
+    template <typename T, Layout LA, typename IA, typename Expr>
+    auto matvec(const Matrix<T, LA, IA>& a, const Expr& x) -> SeqContainer<T> {
+        SeqContainer<T> y;
+        y.resize(a.rows());
+        gemv(T{ 1 }, a, x, T{ 0 }, y);
+        return y;
+    }
+
+    /*
+        Copies square tiles, so both the reads and the writes of a tile stay
+        within a few cache lines per row.
+    */
+    template <typename T, Layout LA, typename IA>
+    auto transpose(const Matrix<T, LA, IA>& a) -> Matrix<T, LA, IA> {
+        Matrix<T, LA, IA> result(a.cols(), a.rows());
+        const auto tile_rows = (a.rows() + transpose_tile - 1) / transpose_tile;
+        const auto rows_per_block = std::max<std::size_t>(default_grain / (transpose_tile * std::max<std::size_t>(a.cols(), 1)), 1);
+        parallel_for(tile_rows, rows_per_block, [&](std::size_t first, std::size_t last, std::size_t) {
+            for (auto tr = first; tr < last; ++tr) {
+                const auto r0 = tr * transpose_tile;
+                const auto r1 = std::min(r0 + transpose_tile, a.rows());
+                for (std::size_t c0 = 0; c0 < a.cols(); c0 += transpose_tile) {
+                    const auto c1 = std::min(c0 + transpose_tile, a.cols());
+                    for (auto r = r0; r < r1; ++r) {
+                        for (auto c = c0; c < c1; ++c) {
+                            result(c, r) = a(r, c);
+                        }
+                    }
+                }
+            }
+        });
+        return result;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                  IO Stream Overload
+    //
+    /*****************************************************************************************/
+
+    template <typename T, Layout LA, typename IA>
+    std::ostream& operator <<(std::ostream& os, const Matrix<T, LA, IA>& a) {
+        os << "[";
+        for (std::size_t r = 0; r < a.rows(); ++r) {
+            os << (r == 0 ? "[" : " [");
+            for (std::size_t c = 0; c < a.cols(); ++c) {
+                os << (c == 0 ? "" : ", ") << a(r, c);
+            }
+            os << (r + 1 == a.rows() ? "]" : "]\n");
+        }
+        return os << "]";
+    }
+}
@@ -36,6 +36,26 @@ namespace Oliver {
     //
     /********************************************************************************************/
 
+    template <typename T>
+    struct Assign_Op {
+
+        static T apply(T const&, T const& b) {
+            return b;
+        }
+
+        static T apply(T&&, T const& b) {
+            return b;
+        }
+
+        static T apply(T const&, T&& b) {
+            return std::move(b);
+        }
+
+        static T apply(T&&, T&& b) {
+            return std::move(b);
+        }
+    };
+
     template <typename T>
     struct Add_Op {
 
@@ -266,6 +286,46 @@ namespace Oliver {
         }
     };
 
+    template <typename T>
+    struct Min_Op {
+
+        static T apply(T const& a, T const& b) {
+            return b < a ? b : a;
+        }
+
+        static T apply(T&& a, T const& b) {
+            return b < a ? b : std::move(a);
+        }
+
+        static T apply(T const& a, T&& b) {
+            return b < a ? std::move(b) : a;
+        }
+
+        static T apply(T&& a, T&& b) {
+            return b < a ? std::move(b) : std::move(a);
+        }
+    };
+
+    template <typename T>
+    struct Max_Op {
+
+        static T apply(T const& a, T const& b) {
+            return a < b ? b : a;
+        }
+
+        static T apply(T&& a, T const& b) {
+            return a < b ? b : std::move(a);
+        }
+
+        static T apply(T const& a, T&& b) {
+            return a < b ? std::move(b) : a;
+        }
+
+        static T apply(T&& a, T&& b) {
+            return a < b ? std::move(b) : std::move(a);
+        }
+    };
+
     template <typename T>
     struct SubScript_Op {
 
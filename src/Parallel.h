@@ -0,0 +1,159 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                   Parallel Utilities
+    //
+    //          A range of 'count' elements is split into at most thread_count()
+    //          contiguous blocks of at least 'grain' elements each.  The split is a
+    //          pure function of the count and the number of blocks, so two pass
+    //          algorithms, (reduce then scan), see the same blocks on both passes.
+    //
+    //          Every block but the last runs on its own std::thread, and the last
+    //          runs on the calling thread.  An exception thrown by any block is
+    //          rethrown on the calling thread once every block has finished.
+    //
+    //          Within a block, the kernels built on these utilities arrange their
+    //          inner loops as plain loops over contiguous elements, free of calls,
+    //          of data dependent branches and of dependences between iterations,
+    //          so that the compiler vectorizes them.  Each header only describes
+    //          how its kernel is laid out into such loops.
+    //
+    /********************************************************************************************/
+
+    constexpr std::size_t default_grain = std::size_t{ 1 } << 15;
+
+    inline std::atomic<std::size_t>& thread_limit() noexcept {
+        static std::atomic<std::size_t> limit{ 0 };
+        return limit;
+    }
+
+    /*
+        A count of zero restores the default of one thread per hardware thread.
+    */
+    inline void set_thread_count(std::size_t count) noexcept {
+        thread_limit().store(count, std::memory_order_relaxed);
+    }
+
+    inline std::size_t thread_count() noexcept {
+        const auto limit = thread_limit().load(std::memory_order_relaxed);
+        if (limit != 0) {
+            return limit;
+        }
+        return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    inline std::size_t block_count(std::size_t count, std::size_t grain = default_grain) noexcept {
+        grain = std::max<std::size_t>(grain, 1);
+        return std::max<std::size_t>(std::min(thread_count(), count / grain), 1);
+    }
+
+    inline std::pair<std::size_t, std::size_t> block_range(std::size_t count, std::size_t blocks, std::size_t block) noexcept {
+        const auto base  = count / blocks;
+        const auto extra = count % blocks;
+        const auto first = block * base + std::min(block, extra);
+        return { first, first + base + (block < extra ? 1 : 0) };
+    }
+
+    /*
+        The block of block_range(count, blocks, block) holding 'index', (the last
+        block for an index past the end).
+    */
+    inline std::size_t block_index(std::size_t count, std::size_t blocks, std::size_t index) noexcept {
+        const auto base     = count / blocks;
+        const auto extra    = count % blocks;
+        const auto boundary = extra * (base + 1);
+        if (index < boundary) {
+            return index / (base + 1);
+        }
+        if (base == 0) {
+            return blocks - 1;
+        }
+        return std::min(extra + (index - boundary) / base, blocks - 1);
+    }
+
+    /*
+        Calls func(block) for every block in [0, blocks).
+    */
+    template <typename Func>
+    void parallel_blocks(std::size_t blocks, Func&& func) {
+        if (blocks <= 1) {
+            if (blocks == 1) {
+                func(std::size_t{ 0 });
+            }
+            return;
+        }
+        std::exception_ptr error;
+        std::mutex         error_mutex;
+        auto run = [&](std::size_t block) {
+            try {
+                func(block);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        threads.reserve(blocks - 1);
+        for (std::size_t block = 0; block + 1 < blocks; ++block) {
+            threads.emplace_back(run, block);
+        }
+        run(blocks - 1);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    /*
+        Calls func(first, last, block) over the blocks of [0, count).
+    */
+    template <typename Func>
+    void parallel_for(std::size_t count, std::size_t grain, Func&& func) {
+        const auto blocks = block_count(count, grain);
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [first, last] = block_range(count, blocks, block);
+            func(first, last, block);
+        });
+    }
+}
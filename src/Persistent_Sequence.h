@@ -0,0 +1,639 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                'PersistentSequence' class
+    //
+    //          The PersistentSequence is a persistent vector intended to be used as
+    //          the IMPL of a SeqContainer, for scripts which treat sequences as values.
+    //
+    //          The elements are stored in the leaves of a 32 way branching trie, and
+    //          nodes are shared between copies.  So a copy is O(1), and updating an
+    //          element only copies the O(log32 n) nodes on the path to its leaf,
+    //          (path copying).  Nodes which are not shared are updated in place.
+    //
+    //          A slice shares the trie of its source and only records an origin
+    //          offset and a size, so it is O(1).  When the end of the left operand
+    //          and the start of the right operand are both leaf aligned, concat
+    //          links the leaves of the right operand instead of copying elements.
+    //          Unaligned leaves are not rebalanced, (as an RRB tree would do), and
+    //          are concatenated element by element instead.
+    //
+    //          The leaves are contiguous, and for_each_chunk() allows expressions
+    //          to be evaluated one leaf at a time instead of one lookup per element.
+    //
+    /********************************************************************************************/
+
+    template<typename VALUE = intmax_t>
+    class PersistentSequence {
+
+        template <bool Const>
+        class Iterator;
+
+    public:
+        static constexpr std::size_t bits  = 5;
+        static constexpr std::size_t width = std::size_t{ 1 } << bits;
+        static constexpr std::size_t mask  = width - 1;
+
+        using value_type             = VALUE;
+        using iterator               = Iterator<false>;
+        using const_iterator         = Iterator<true>;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        PersistentSequence();
+        PersistentSequence(std::size_t size, value_type value);
+        PersistentSequence(std::initializer_list<value_type> list);
+
+        ~PersistentSequence() = default;
+
+        PersistentSequence(PersistentSequence&& seq)                  noexcept = default;
+        PersistentSequence(const PersistentSequence& seq)             noexcept = default;
+        PersistentSequence& operator =(PersistentSequence&& seq)      noexcept = default;
+        PersistentSequence& operator =(const PersistentSequence& seq) noexcept = default;
+
+        iterator        begin() noexcept;
+        const_iterator  begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+
+        iterator        end() noexcept;
+        const_iterator  end() const noexcept;
+        const_iterator cend() const noexcept;
+
+        reverse_iterator        rbegin() noexcept;
+        const_reverse_iterator  rbegin() const noexcept;
+        const_reverse_iterator crbegin() const noexcept;
+
+        reverse_iterator        rend() noexcept;
+        const_reverse_iterator  rend() const noexcept;
+        const_reverse_iterator crend() const noexcept;
+
+        std::size_t     size() const noexcept;
+        std::size_t max_size() const noexcept;
+        std::size_t capacity() const noexcept;
+
+        void resize(std::size_t size);
+        void resize(std::size_t size, value_type value);
+        void reserve(std::size_t size);
+        void clear() noexcept;
+
+        void  pop_back();
+        void push_back(value_type value);
+
+        template<typename InputIt>
+        iterator insert(const_iterator at, InputIt first, InputIt last);
+
+        PersistentSequence update(std::size_t index, value_type value) const;
+        PersistentSequence  slice(std::size_t first, std::size_t last) const;
+        PersistentSequence concat(const PersistentSequence& other) const;
+        PersistentSequence& append(const PersistentSequence& other);
+
+        std::size_t chunk_count() const noexcept;
+        std::span<const value_type> chunk(std::size_t index) const;
+
+        template <typename Func> void for_each_chunk(Func&& func) const;
+        template <typename Func> void for_each_chunk(Func&& func);
+
+        const value_type& operator [](std::size_t index) const;
+              value_type& operator [](std::size_t index);
+
+    private:
+        using node_ptr = std::shared_ptr<void>;
+
+        struct Leaf {
+            std::array<value_type, width> values{};
+        };
+
+        struct Branch {
+            std::array<node_ptr, width> children{};
+        };
+
+        node_ptr    _root;
+        std::size_t _shift;
+        std::size_t _origin;
+        std::size_t _size;
+
+        template <typename Node>
+        static Node* unique_node(node_ptr& node);
+
+        const Leaf* leaf_at(std::size_t position) const noexcept;
+        node_ptr    leaf_node_at(std::size_t position) const noexcept;
+        Leaf*       mutable_leaf_at(std::size_t position);
+
+        void ensure_capacity(std::size_t position);
+        void attach_leaf(node_ptr leaf, std::size_t count);
+    };
+
+    template <typename VALUE = intmax_t>
+    using PersistentSeqContainer = SeqContainer<VALUE, PersistentSequence<VALUE>>;
+
+    /*****************************************************************************************/
+    //
+    //                                    'Iterator' class
+    //
+    //          A random access iterator by index.  Dereferencing a mutable iterator
+    //          path copies the leaf holding the element, the same as operator[].
+    //
+    /*****************************************************************************************/
+
+    template<typename VALUE>
+    template<bool Const>
+    class PersistentSequence<VALUE>::Iterator {
+
+        using sequence = std::conditional_t<Const, const PersistentSequence, PersistentSequence>;
+
+    public:
+        using iterator_concept  = std::random_access_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = VALUE;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = std::conditional_t<Const, const VALUE*, VALUE*>;
+        using reference         = std::conditional_t<Const, const VALUE&, VALUE&>;
+
+        Iterator() noexcept : _seq(nullptr), _index(0) {
+        }
+
+        Iterator(sequence* seq, std::size_t index) noexcept : _seq(seq), _index(index) {
+        }
+
+        template <bool C = Const> requires C
+        Iterator(const Iterator<false>& other) noexcept : _seq(other._seq), _index(other._index) {
+        }
+
+        reference operator *() const {
+            return (*_seq)[_index];
+        }
+
+        pointer operator ->() const {
+            return &(*_seq)[_index];
+        }
+
+        reference operator [](difference_type n) const {
+            return (*_seq)[_index + n];
+        }
+
+        Iterator& operator ++() noexcept { ++_index; return *this; }
+        Iterator& operator --() noexcept { --_index; return *this; }
+
+        Iterator operator ++(int) noexcept { Iterator it = *this; ++_index; return it; }
+        Iterator operator --(int) noexcept { Iterator it = *this; --_index; return it; }
+
+        Iterator& operator +=(difference_type n) noexcept { _index += n; return *this; }
+        Iterator& operator -=(difference_type n) noexcept { _index -= n; return *this; }
+
+        friend Iterator operator +(Iterator it, difference_type n) noexcept { return it += n; }
+        friend Iterator operator +(difference_type n, Iterator it) noexcept { return it += n; }
+        friend Iterator operator -(Iterator it, difference_type n) noexcept { return it -= n; }
+
+        friend difference_type operator -(const Iterator& a, const Iterator& b) noexcept {
+            return static_cast<difference_type>(a._index) - static_cast<difference_type>(b._index);
+        }
+
+        friend bool operator ==(const Iterator& a, const Iterator& b) noexcept {
+            return a._index == b._index;
+        }
+
+        friend std::strong_ordering operator <=>(const Iterator& a, const Iterator& b) noexcept {
+            return a._index <=> b._index;
+        }
+
+        std::size_t index() const noexcept {
+            return _index;
+        }
+
+    private:
+        friend class Iterator<!Const>;
+
+        sequence*   _seq;
+        std::size_t _index;
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                       Constructors
+    //
+    /*****************************************************************************************/
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::PersistentSequence() : _root(), _shift(0), _origin(0), _size(0) {
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::PersistentSequence(std::size_t size, value_type value) : PersistentSequence() {
+        resize(size, value);
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::PersistentSequence(std::initializer_list<value_type> list) : PersistentSequence() {
+        for (const auto& value : list) {
+            push_back(value);
+        }
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                        Iterators
+    //
+    /*****************************************************************************************/
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::iterator PersistentSequence<VALUE>::begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::const_iterator PersistentSequence<VALUE>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::const_iterator PersistentSequence<VALUE>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::iterator PersistentSequence<VALUE>::end() noexcept {
+        return iterator(this, _size);
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::const_iterator PersistentSequence<VALUE>::end() const noexcept {
+        return const_iterator(this, _size);
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::const_iterator PersistentSequence<VALUE>::cend() const noexcept {
+        return const_iterator(this, _size);
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::reverse_iterator PersistentSequence<VALUE>::rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::const_reverse_iterator PersistentSequence<VALUE>::rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::const_reverse_iterator PersistentSequence<VALUE>::crbegin() const noexcept {
+        return const_reverse_iterator(cend());
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::reverse_iterator PersistentSequence<VALUE>::rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::const_reverse_iterator PersistentSequence<VALUE>::rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::const_reverse_iterator PersistentSequence<VALUE>::crend() const noexcept {
+        return const_reverse_iterator(cbegin());
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                 Size & Capacity Methods
+    //
+    /*****************************************************************************************/
+
+    template<typename VALUE>
+    inline std::size_t PersistentSequence<VALUE>::size() const noexcept {
+        return _size;
+    }
+
+    template<typename VALUE>
+    inline std::size_t PersistentSequence<VALUE>::max_size() const noexcept {
+        return std::numeric_limits<std::ptrdiff_t>::max() / sizeof(value_type);
+    }
+
+    template<typename VALUE>
+    inline std::size_t PersistentSequence<VALUE>::capacity() const noexcept {
+        if (!_root) {
+            return 0;
+        }
+        return (std::size_t{ 1 } << (_shift + bits)) - _origin;
+    }
+
+    template<typename VALUE>
+    inline void PersistentSequence<VALUE>::resize(std::size_t size) {
+        resize(size, value_type{});
+    }
+
+    template<typename VALUE>
+    inline void PersistentSequence<VALUE>::resize(std::size_t size, value_type value) {
+        if (size == 0) {
+            clear();
+            return;
+        }
+        while (_size < size) {
+            push_back(value);
+        }
+        _size = size;
+    }
+
+    /*
+        The trie grows one leaf at a time, so there is nothing to reserve.
+    */
+    template<typename VALUE>
+    inline void PersistentSequence<VALUE>::reserve(std::size_t) {
+    }
+
+    template<typename VALUE>
+    inline void PersistentSequence<VALUE>::clear() noexcept {
+        _root   = node_ptr();
+        _shift  = 0;
+        _origin = 0;
+        _size   = 0;
+    }
+
+    template<typename VALUE>
+    inline void PersistentSequence<VALUE>::pop_back() {
+        if (_size > 1) {
+            --_size;
+        }
+        else {
+            clear();
+        }
+    }
+
+    template<typename VALUE>
+    inline void PersistentSequence<VALUE>::push_back(value_type value) {
+        const auto position = _origin + _size;
+        ensure_capacity(position);
+        mutable_leaf_at(position)->values[position & mask] = std::move(value);
+        ++_size;
+    }
+
+    /*
+        The inserted range is buffered first, since it may alias this sequence.
+    */
+    template<typename VALUE>
+    template<typename InputIt>
+    inline PersistentSequence<VALUE>::iterator PersistentSequence<VALUE>::insert(const_iterator at, InputIt first, InputIt last) {
+        const auto index = at.index();
+        std::vector<value_type> inserted(first, last);
+        std::vector<value_type> trailing;
+        trailing.reserve(_size - index);
+        for (std::size_t i = index; i < _size; ++i) {
+            trailing.push_back((*this)[i]);
+        }
+        _size = index;
+        for (auto& value : inserted) {
+            push_back(std::move(value));
+        }
+        for (auto& value : trailing) {
+            push_back(std::move(value));
+        }
+        return iterator(this, index);
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                  Functional Updates
+    //
+    /*****************************************************************************************/
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE> PersistentSequence<VALUE>::update(std::size_t index, value_type value) const {
+        PersistentSequence seq = *this;
+        if (index >= seq._size) {
+            seq.resize(index + 1);
+        }
+        seq[index] = std::move(value);
+        return seq;
+    }
+
+    /*
+        The slice shares the trie of this sequence, and so keeps all of its
+        nodes alive, not only the ones within the slice.
+    */
+    template<typename VALUE>
+    inline PersistentSequence<VALUE> PersistentSequence<VALUE>::slice(std::size_t first, std::size_t last) const {
+        last  = std::min(last, _size);
+        first = std::min(first, last);
+        if (first == last) {
+            return PersistentSequence();
+        }
+        PersistentSequence seq = *this;
+        seq._origin += first;
+        seq._size    = last - first;
+        return seq;
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE> PersistentSequence<VALUE>::concat(const PersistentSequence& other) const {
+        PersistentSequence seq = *this;
+        seq.append(other);
+        return seq;
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>& PersistentSequence<VALUE>::append(const PersistentSequence& other) {
+        if (other._size == 0) {
+            return *this;
+        }
+        if (((_origin + _size) & mask) != 0 || (other._origin & mask) != 0) {
+            const PersistentSequence source = other;
+            for (std::size_t i = 0; i < source._size; ++i) {
+                push_back(source[i]);
+            }
+            return *this;
+        }
+        const PersistentSequence source = other;
+        for (std::size_t i = 0; i < source._size; i += width) {
+            attach_leaf(source.leaf_node_at(source._origin + i), std::min(width, source._size - i));
+        }
+        return *this;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                     Chunk Access
+    //
+    /*****************************************************************************************/
+
+    template<typename VALUE>
+    inline std::size_t PersistentSequence<VALUE>::chunk_count() const noexcept {
+        if (_size == 0) {
+            return 0;
+        }
+        return ((_origin + _size - 1) >> bits) - (_origin >> bits) + 1;
+    }
+
+    template<typename VALUE>
+    inline std::span<const typename PersistentSequence<VALUE>::value_type> PersistentSequence<VALUE>::chunk(std::size_t index) const {
+        const auto first = std::max(((_origin >> bits) + index) << bits, _origin);
+        const auto last  = std::min((((_origin >> bits) + index) + 1) << bits, _origin + _size);
+        const auto leaf  = leaf_at(first);
+        return std::span<const value_type>(leaf->values.data() + (first & mask), last - first);
+    }
+
+    /*
+        Calls func(data, count, index) once per leaf, where data points to the
+        count contiguous elements starting at 'index' of the sequence.
+    */
+    template<typename VALUE>
+    template<typename Func>
+    inline void PersistentSequence<VALUE>::for_each_chunk(Func&& func) const {
+        std::size_t index = 0;
+        while (index < _size) {
+            const auto position = _origin + index;
+            const auto count    = std::min(width - (position & mask), _size - index);
+            const auto leaf     = leaf_at(position);
+            func(leaf->values.data() + (position & mask), count, index);
+            index += count;
+        }
+    }
+
+    template<typename VALUE>
+    template<typename Func>
+    inline void PersistentSequence<VALUE>::for_each_chunk(Func&& func) {
+        std::size_t index = 0;
+        while (index < _size) {
+            const auto position = _origin + index;
+            const auto count    = std::min(width - (position & mask), _size - index);
+            const auto leaf     = mutable_leaf_at(position);
+            func(leaf->values.data() + (position & mask), count, index);
+            index += count;
+        }
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                     Element Access
+    //
+    /*****************************************************************************************/
+
+    template<typename VALUE>
+    inline const PersistentSequence<VALUE>::value_type& PersistentSequence<VALUE>::operator[](std::size_t index) const {
+        const auto position = _origin + index;
+        return leaf_at(position)->values[position & mask];
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::value_type& PersistentSequence<VALUE>::operator[](std::size_t index) {
+        const auto position = _origin + index;
+        return mutable_leaf_at(position)->values[position & mask];
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                     Private Methods
+    //
+    /*****************************************************************************************/
+
+    /*
+        Returns the node owned by 'node', creating it when it is missing and
+        copying it when it is shared with another sequence.
+    */
+    template<typename VALUE>
+    template<typename Node>
+    inline Node* PersistentSequence<VALUE>::unique_node(node_ptr& node) {
+        if (!node) {
+            node = std::make_shared<Node>();
+        }
+        else if (node.use_count() > 1) {
+            node = std::make_shared<Node>(*static_cast<const Node*>(node.get()));
+        }
+        return static_cast<Node*>(node.get());
+    }
+
+    template<typename VALUE>
+    inline const PersistentSequence<VALUE>::Leaf* PersistentSequence<VALUE>::leaf_at(std::size_t position) const noexcept {
+        const void* node = _root.get();
+        for (auto shift = _shift; shift > 0; shift -= bits) {
+            node = static_cast<const Branch*>(node)->children[(position >> shift) & mask].get();
+        }
+        return static_cast<const Leaf*>(node);
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::node_ptr PersistentSequence<VALUE>::leaf_node_at(std::size_t position) const noexcept {
+        const node_ptr* node = &_root;
+        for (auto shift = _shift; shift > 0; shift -= bits) {
+            node = &static_cast<const Branch*>(node->get())->children[(position >> shift) & mask];
+        }
+        return *node;
+    }
+
+    template<typename VALUE>
+    inline PersistentSequence<VALUE>::Leaf* PersistentSequence<VALUE>::mutable_leaf_at(std::size_t position) {
+        node_ptr* node = &_root;
+        for (auto shift = _shift; shift > 0; shift -= bits) {
+            node = &unique_node<Branch>(*node)->children[(position >> shift) & mask];
+        }
+        return unique_node<Leaf>(*node);
+    }
+
+    template<typename VALUE>
+    inline void PersistentSequence<VALUE>::ensure_capacity(std::size_t position) {
+        while (position >= (std::size_t{ 1 } << (_shift + bits))) {
+            auto root = std::make_shared<Branch>();
+            root->children[0] = std::move(_root);
+            _root   = std::move(root);
+            _shift += bits;
+        }
+    }
+
+    /*
+        Links a shared leaf in the next leaf aligned position of the sequence.
+    */
+    template<typename VALUE>
+    inline void PersistentSequence<VALUE>::attach_leaf(node_ptr leaf, std::size_t count) {
+        const auto position = _origin + _size;
+        ensure_capacity(position);
+        node_ptr* node = &_root;
+        for (auto shift = _shift; shift > 0; shift -= bits) {
+            node = &unique_node<Branch>(*node)->children[(position >> shift) & mask];
+        }
+        *node  = std::move(leaf);
+        _size += count;
+    }
+}
@@ -0,0 +1,983 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "FFT.h"
+#include "Parallel.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                  Polynomial Arithmetic
+    //
+    //          A polynomial is a SeqContainer of its coefficients, lowest degree
+    //          first, so p[i] is the coefficient of x^i.  Trailing zeros are allowed
+    //          and are ignored wherever the degree matters.
+    //
+    //          poly_add / poly_sub         sum and difference, to the longer operand
+    //          poly_mul                    product
+    //          poly_inverse(b, k)          the power series 1 / b, modulo x^k
+    //          poly_divmod / div / mod     quotient and remainder
+    //          horner(p, x)                p at a single point
+    //          poly_eval(p, xs)            p at every point of a sequence
+    //          poly_eval_multipoint(p, xs) the same for integer coefficients, through
+    //                                      a subproduct tree
+    //
+    //          poly_add is provided since an expression a + b takes the size of its
+    //          left operand, and so drops the high terms of a longer right operand.
+    //
+    //          poly_mul picks its algorithm by the length of the shorter operand:
+    //          schoolbook below poly_karatsuba_cutoff, Karatsuba up to
+    //          poly_transform_cutoff, and above it a transform.  Floating point
+    //          coefficients use the real FFT of FFT.h at a length of the form
+    //          2^a 3^b.  Integer coefficients use number theoretic transforms modulo
+    //          three primes, combined by the Chinese remainder theorem, which is exact
+    //          whenever every coefficient of the product is below 2^80 in magnitude,
+    //          (checked from the operands, falling back to Karatsuba otherwise).  A
+    //          long operand is multiplied by a short one as a series of balanced
+    //          products.
+    //
+    //          Integer coefficients are computed modulo 2^N, N the width of the
+    //          coefficient type.  Signed overflow is undefined, so the coefficients
+    //          of a signed or narrow type are widened to an unsigned poly_word of
+    //          at least the width of int, and the results converted back, so that
+    //          a result which does not fit in the coefficient type wraps.
+    //
+    //          The quotient of a by b is the reversal of rev(a) / rev(b) modulo
+    //          x^(deg a - deg b + 1), with the series inverse found by Newton
+    //          iteration, g <- g (2 - b g), which doubles the number of correct terms
+    //          per step.  So it costs a few multiplications.  Small quotients or
+    //          divisors use long division.  Floating point coefficients divide by
+    //          any b, and integer coefficients by a b whose leading coefficient is
+    //          1 or -1, (such as the monic products of the subproduct tree), which
+    //          is exact modulo 2^N.  In floating point, both forms effectively
+    //          expand 1 / rev(b), whose coefficients grow quickly when b has roots
+    //          outside, or many roots near, the unit circle, and then the division
+    //          loses accuracy either way.
+    //
+    //          poly_eval runs Horner's rule over blocks of poly_horner_lanes points,
+    //          the inner loop stepping every point of the block by one coefficient,
+    //          so its iterations are independent.  poly_eval_multipoint builds the
+    //          tree of products of (x - x_i) over runs of points, reduces p modulo
+    //          each node on the way down, and applies Horner at the leaves, which
+    //          is O(n log^2 n) rather than O(n m).  It is for integer coefficients,
+    //          for which every step is exact modulo 2^N.  In floating point the
+    //          remainders of the tree lose all accuracy beyond small degrees, so
+    //          poly_eval is the evaluation for floating point coefficients.
+    //
+    /********************************************************************************************/
+
+    constexpr std::size_t poly_karatsuba_cutoff = 32;
+    constexpr std::size_t poly_transform_cutoff = 256;
+    constexpr std::size_t poly_newton_cutoff    = 64;
+    constexpr std::size_t poly_horner_lanes     = 64;
+    constexpr std::size_t poly_leaf_points      = 64;
+
+    /*
+        A grain which keeps a nested kernel on the calling thread.
+    */
+    constexpr std::size_t poly_serial_grain = std::numeric_limits<std::size_t>::max();
+
+    /*
+        Returns the coefficients of 'p' as a contiguous span, copying them into
+        'buffer' when the SeqContainer is not contiguous.
+    */
+    template <typename T, typename IMPL>
+    std::span<const T> poly_span(const SeqContainer<T, IMPL>& p, std::vector<T>& buffer) {
+        if constexpr (std::ranges::contiguous_range<const IMPL>) {
+            return { p.data(), p.size() };
+        }
+        else {
+            buffer.assign(p.begin(), p.end());
+            return { buffer.data(), buffer.size() };
+        }
+    }
+
+    /*
+        The span without its trailing zero coefficients.
+    */
+    template <typename T>
+    std::span<const T> poly_trimmed(std::span<const T> p) {
+        auto size = p.size();
+        while (size > 0 && p[size - 1] == T{}) {
+            --size;
+        }
+        return p.first(size);
+    }
+
+    template <typename T>
+    SeqContainer<T> poly_sequence(std::span<const T> coefficients) {
+        SeqContainer<T> out;
+        fill_sequence(out, coefficients.size(), [&](T* data) {
+            std::copy(coefficients.begin(), coefficients.end(), data);
+        });
+        return out;
+    }
+
+    /*
+        The type the kernels compute coefficients of type T in.  An integer type
+        other than bool maps to an unsigned type of at least the width of int, so
+        that its sums and products wrap modulo 2^N rather than overflow, (which
+        is undefined for a signed type, and for an unsigned type narrower than
+        int, which promotes to int).
+    */
+    template <typename T>
+    struct poly_word_of {
+        using type = T;
+    };
+
+    template <typename T> requires std::integral<T> && (!std::same_as<T, bool>)
+    struct poly_word_of<T> {
+        using type = std::common_type_t<std::make_unsigned_t<T>, unsigned int>;
+    };
+
+    template <typename T>
+    using poly_word = typename poly_word_of<T>::type;
+
+    template <typename T>
+    concept PolyWidened = !std::same_as<poly_word<T>, T>;
+
+    /*
+        Widens a coefficient to its poly_word, sign extending it, so that a value
+        of -1, (or the largest value of a narrow unsigned type), remains a unit.
+        Every representative is congruent modulo 2^N, so the results converted
+        back are the same.
+    */
+    template <typename T>
+    poly_word<T> poly_widen(T value) noexcept {
+        if constexpr (PolyWidened<T>) {
+            return static_cast<poly_word<T>>(static_cast<std::make_signed_t<T>>(value));
+        }
+        else {
+            return value;
+        }
+    }
+
+    template <typename T, typename IMPL>
+    SeqContainer<poly_word<T>> poly_widen(const SeqContainer<T, IMPL>& p) {
+        SeqContainer<poly_word<T>> out;
+        fill_sequence(out, p.size(), [&](poly_word<T>* data) {
+            auto it = p.begin();
+            for (std::size_t i = 0; i < p.size(); ++i, ++it) {
+                data[i] = poly_widen<T>(*it);
+            }
+        });
+        return out;
+    }
+
+    template <typename T, typename U, typename IMPL>
+    SeqContainer<T> poly_narrow(const SeqContainer<U, IMPL>& p) {
+        SeqContainer<T> out;
+        fill_sequence(out, p.size(), [&](T* data) {
+            auto it = p.begin();
+            for (std::size_t i = 0; i < p.size(); ++i, ++it) {
+                data[i] = static_cast<T>(*it);
+            }
+        });
+        return out;
+    }
+
+    /*
+        Removes the trailing zero coefficients of 'p'.
+    */
+    template <typename T, typename IMPL>
+    SeqContainer<T, IMPL>& poly_trim(SeqContainer<T, IMPL>& p) {
+        auto size = p.size();
+        while (size > 0 && p.impl()[size - 1] == T{}) {
+            --size;
+        }
+        return p.resize(size);
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                  Addition & Subtraction
+    //
+    /*****************************************************************************************/
+
+    template <typename T, typename IMPL1, typename IMPL2>
+    SeqContainer<T> poly_add(const SeqContainer<T, IMPL1>& a, const SeqContainer<T, IMPL2>& b) {
+        SeqContainer<T> out;
+        fill_sequence(out, std::max(a.size(), b.size()), [&](T* data) {
+            for (std::size_t i = 0; i < out.size(); ++i) {
+                data[i] = static_cast<T>(poly_widen(a[i]) + poly_widen(b[i]));
+            }
+        });
+        return out;
+    }
+
+    template <typename T, typename IMPL1, typename IMPL2>
+    SeqContainer<T> poly_sub(const SeqContainer<T, IMPL1>& a, const SeqContainer<T, IMPL2>& b) {
+        SeqContainer<T> out;
+        fill_sequence(out, std::max(a.size(), b.size()), [&](T* data) {
+            for (std::size_t i = 0; i < out.size(); ++i) {
+                data[i] = static_cast<T>(poly_widen(a[i]) - poly_widen(b[i]));
+            }
+        });
+        return out;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                 Schoolbook & Karatsuba
+    //
+    //          Every kernel writes the na + nb - 1 coefficients of the product of
+    //          two non empty operands to 'out'.
+    //
+    /*****************************************************************************************/
+
+    template <typename T>
+    void poly_schoolbook(const T* a, std::size_t na, const T* b, std::size_t nb, T* out) {
+        std::fill(out, out + (na + nb - 1), T{});
+        for (std::size_t i = 0; i < na; ++i) {
+            const T ai  = a[i];
+            T*      row = out + i;
+            for (std::size_t j = 0; j < nb; ++j) {
+                row[j] += ai * b[j];
+            }
+        }
+    }
+
+    /*
+        The product of two operands of 'n' coefficients, using at most
+        poly_karatsuba_scratch(n) elements of 'scratch'.
+
+        With a = a0 + x^h a1 and b = b0 + x^h b1, the product is
+        a0 b0 + x^h ((a0 + a1)(b0 + b1) - a0 b0 - a1 b1) + x^2h a1 b1.
+    */
+    template <typename T>
+    void poly_karatsuba(const T* a, const T* b, std::size_t n, T* out, T* scratch) {
+        if (n < poly_karatsuba_cutoff) {
+            poly_schoolbook(a, n, b, n, out);
+            return;
+        }
+        const auto h = n / 2;
+        const auto m = n - h;
+        poly_karatsuba(a, b, h, out, scratch);
+        out[2 * h - 1] = T{};
+        poly_karatsuba(a + h, b + h, m, out + 2 * h, scratch);
+
+        T* sa  = scratch;
+        T* sb  = sa + m;
+        T* mid = sb + m;
+        for (std::size_t i = 0; i < h; ++i) {
+            sa[i] = a[i] + a[h + i];
+            sb[i] = b[i] + b[h + i];
+        }
+        if (m > h) {
+            sa[h] = a[n - 1];
+            sb[h] = b[n - 1];
+        }
+        poly_karatsuba(sa, sb, m, mid, mid + (2 * m - 1));
+        for (std::size_t i = 0; i < 2 * h - 1; ++i) {
+            mid[i] -= out[i];
+        }
+        for (std::size_t i = 0; i < 2 * m - 1; ++i) {
+            mid[i] -= out[2 * h + i];
+        }
+        for (std::size_t i = 0; i < 2 * m - 1; ++i) {
+            out[h + i] += mid[i];
+        }
+    }
+
+    /*
+        Each level takes 4 ceil(n / 2) - 1 elements, and there are fewer than
+        64 levels.
+    */
+    constexpr std::size_t poly_karatsuba_scratch(std::size_t n) noexcept {
+        return 4 * n + 256;
+    }
+
+    /*
+        The product of a long operand 'a' and a shorter 'b', as a series of
+        balanced products of b with pieces of a of its length.
+    */
+    template <typename T>
+    void poly_karatsuba_unbalanced(std::span<const T> a, std::span<const T> b, T* out) {
+        const auto n = b.size();
+        std::vector<T> piece(n);
+        std::vector<T> product(2 * n - 1);
+        std::vector<T> scratch(poly_karatsuba_scratch(n));
+        std::fill(out, out + (a.size() + n - 1), T{});
+        for (std::size_t start = 0; start < a.size(); start += n) {
+            const auto length = std::min(n, a.size() - start);
+            std::copy_n(a.data() + start, length, piece.data());
+            std::fill(piece.begin() + length, piece.end(), T{});
+            poly_karatsuba(piece.data(), b.data(), n, product.data(), scratch.data());
+            T* row = out + start;
+            for (std::size_t i = 0; i < length + n - 1; ++i) {
+                row[i] += product[i];
+            }
+        }
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                   Transform Products
+    //
+    /*****************************************************************************************/
+
+    /*
+        The smallest even length of the form 2^a 3^b, not less than 'count'.
+    */
+    inline std::size_t poly_fft_length(std::size_t count) noexcept {
+        std::size_t best = std::numeric_limits<std::size_t>::max();
+        for (std::size_t three = 1; three < best; three *= 3) {
+            std::size_t length = 2 * three;
+            while (length < count) {
+                length *= 2;
+            }
+            best = std::min(best, length);
+            if (three > count) {
+                break;
+            }
+        }
+        return best;
+    }
+
+    template <typename T> requires std::floating_point<T>
+    void poly_mul_fft(std::span<const T> a, std::span<const T> b, T* out, std::size_t grain) {
+        const auto count  = a.size() + b.size() - 1;
+        const auto length = poly_fft_length(count);
+        const bool square = a.data() == b.data() && a.size() == b.size();
+
+        SeqContainer<T> padded;
+        padded.resize(length);
+        std::copy(a.begin(), a.end(), padded.data());
+        auto spectrum = rfft(padded, grain);
+        if (square) {
+            auto* x = spectrum.data();
+            parallel_for(spectrum.size(), grain, [&](std::size_t first, std::size_t last, std::size_t) {
+                for (auto k = first; k < last; ++k) {
+                    x[k] = fft_mul(x[k], x[k]);
+                }
+            });
+        }
+        else {
+            std::fill_n(padded.data(), a.size(), T{});
+            std::copy(b.begin(), b.end(), padded.data());
+            const auto other = rfft(padded, grain);
+            auto*       x    = spectrum.data();
+            const auto* y    = other.data();
+            parallel_for(spectrum.size(), grain, [&](std::size_t first, std::size_t last, std::size_t) {
+                for (auto k = first; k < last; ++k) {
+                    x[k] = fft_mul(x[k], y[k]);
+                }
+            });
+        }
+        const auto product = irfft(spectrum, length, grain);
+        std::copy_n(product.data(), count, out);
+    }
+
+    /*
+        Three primes of the form c 2^k + 1, each with primitive root 3, so every
+        one of them has roots of unity of every power of two up to 2^23.
+    */
+    constexpr std::uint32_t ntt_primes[3] = { 167772161, 469762049, 998244353 };
+    constexpr std::size_t   ntt_max_length = std::size_t{ 1 } << 23;
+
+    inline std::uint32_t ntt_pow(std::uint64_t base, std::uint64_t exponent, std::uint32_t prime) noexcept {
+        std::uint64_t result = 1;
+        base %= prime;
+        while (exponent > 0) {
+            if (exponent & 1) {
+                result = result * base % prime;
+            }
+            base      = base * base % prime;
+            exponent >>= 1;
+        }
+        return static_cast<std::uint32_t>(result);
+    }
+
+    /*
+        The value modulo 'prime' of a coefficient of any integer type.
+    */
+    template <typename T>
+    std::uint32_t ntt_residue(T value, std::uint32_t prime) noexcept {
+        if constexpr (std::is_signed_v<T>) {
+            if (value < 0) {
+                const auto magnitude = (static_cast<std::uint64_t>(-(value + 1)) % prime + 1) % prime;
+                return static_cast<std::uint32_t>((prime - magnitude) % prime);
+            }
+        }
+        return static_cast<std::uint32_t>(static_cast<std::uint64_t>(value) % prime);
+    }
+
+    /*
+        An in place radix 2 number theoretic transform of a power of two length,
+        with the roots of each stage computed ahead of its butterflies.
+    */
+    inline void ntt(std::vector<std::uint32_t>& a, std::uint32_t prime, bool inverse) {
+        const auto n = a.size();
+        for (std::size_t i = 1, j = 0; i < n; ++i) {
+            auto bit = n >> 1;
+            for (; j & bit; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j) {
+                std::swap(a[i], a[j]);
+            }
+        }
+        std::vector<std::uint32_t> roots(n / 2);
+        for (std::size_t length = 2; length <= n; length <<= 1) {
+            const auto half = length / 2;
+            auto       step = ntt_pow(3, (prime - 1) / length, prime);
+            if (inverse) {
+                step = ntt_pow(step, prime - 2, prime);
+            }
+            roots[0] = 1;
+            for (std::size_t j = 1; j < half; ++j) {
+                roots[j] = static_cast<std::uint32_t>(std::uint64_t{ roots[j - 1] } * step % prime);
+            }
+            for (std::size_t i = 0; i < n; i += length) {
+                auto* lo = a.data() + i;
+                auto* hi = lo + half;
+                for (std::size_t j = 0; j < half; ++j) {
+                    const auto u = lo[j];
+                    const auto v = static_cast<std::uint32_t>(std::uint64_t{ hi[j] } * roots[j] % prime);
+                    lo[j] = u + v >= prime ? u + v - prime : u + v;
+                    hi[j] = u >= v ? u - v : u + prime - v;
+                }
+            }
+        }
+        if (inverse) {
+            const std::uint64_t scale = ntt_pow(n, prime - 2, prime);
+            for (auto& value : a) {
+                value = static_cast<std::uint32_t>(value * scale % prime);
+            }
+        }
+    }
+
+    /*
+        The representative of an unsigned coefficient nearest zero, so that a
+        signed coefficient widened to its poly_word keeps its magnitude.  The
+        product modulo 2^N does not depend on the representative.
+    */
+    template <typename T> requires std::integral<T>
+    auto ntt_centered(T value) noexcept {
+        if constexpr (std::unsigned_integral<T> && !std::same_as<T, bool>) {
+            return static_cast<std::make_signed_t<T>>(value);
+        }
+        else {
+            return value;
+        }
+    }
+
+    /*
+        Returns false, leaving 'out' untouched, when the product is too long or
+        its coefficients may be too large for the three primes to recover.
+    */
+    template <typename T> requires std::integral<T>
+    bool poly_mul_ntt(std::span<const T> a, std::span<const T> b, T* out, std::size_t grain) {
+        const auto count = a.size() + b.size() - 1;
+        std::size_t length = 1;
+        while (length < count) {
+            length <<= 1;
+        }
+        if (length > ntt_max_length) {
+            return false;
+        }
+        auto largest = [](std::span<const T> p) {
+            long double result = 0;
+            for (const auto& value : p) {
+                result = std::max(result, std::fabs(static_cast<long double>(ntt_centered(value))));
+            }
+            return result;
+        };
+        const auto bound = largest(a) * largest(b) * static_cast<long double>(std::min(a.size(), b.size()));
+        if (bound >= std::ldexp(1.0L, 80)) {
+            return false;
+        }
+
+        std::vector<std::uint32_t> residues[3];
+        parallel_blocks(3, [&](std::size_t block) {
+            const auto prime = ntt_primes[block];
+            auto&      x     = residues[block];
+            std::vector<std::uint32_t> y(length);
+            x.assign(length, 0);
+            for (std::size_t i = 0; i < a.size(); ++i) {
+                x[i] = ntt_residue(ntt_centered(a[i]), prime);
+            }
+            for (std::size_t i = 0; i < b.size(); ++i) {
+                y[i] = ntt_residue(ntt_centered(b[i]), prime);
+            }
+            ntt(x, prime, false);
+            ntt(y, prime, false);
+            for (std::size_t i = 0; i < length; ++i) {
+                x[i] = static_cast<std::uint32_t>(std::uint64_t{ x[i] } * y[i] % prime);
+            }
+            ntt(x, prime, true);
+        });
+
+        /*
+            Garner's form of the Chinese remainder theorem, x = r1 + m1 v2 + m1 m2 v3,
+            evaluated modulo 2^64.  A coefficient is negative when x lies above
+            m1 m2 m3 / 2, which the bound above makes the same as v3 > m3 / 2.
+        */
+        const std::uint64_t m1      = ntt_primes[0];
+        const std::uint64_t m2      = ntt_primes[1];
+        const std::uint64_t m3      = ntt_primes[2];
+        const std::uint64_t inv_12  = ntt_pow(m1, m2 - 2, m2);
+        const std::uint64_t inv_123 = ntt_pow(m1 * m2 % m3, m3 - 2, m3);
+        const std::uint64_t modulus = m1 * m2 * m3;
+        parallel_for(count, grain, [&](std::size_t first, std::size_t last, std::size_t) {
+            for (auto i = first; i < last; ++i) {
+                const std::uint64_t r1 = residues[0][i];
+                const std::uint64_t r2 = residues[1][i];
+                const std::uint64_t r3 = residues[2][i];
+                const std::uint64_t v2 = (r2 + m2 - r1 % m2) % m2 * inv_12 % m2;
+                const std::uint64_t v3 = (r3 + m3 - (r1 + v2 * m1) % m3) % m3 * inv_123 % m3;
+                std::uint64_t       x  = r1 + v2 * m1 + v3 * (m1 * m2);
+                if (v3 > m3 / 2) {
+                    x -= modulus;
+                }
+                out[i] = static_cast<T>(x);
+            }
+        });
+        return true;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                     Multiplication
+    //
+    /*****************************************************************************************/
+
+    /*
+        Writes the product of two non empty operands to the a.size() + b.size() - 1
+        elements of 'out'.
+    */
+    template <typename T>
+    void poly_mul_kernel(std::span<const T> a, std::span<const T> b, T* out, std::size_t grain) {
+        if (a.size() < b.size()) {
+            std::swap(a, b);
+        }
+        if (b.size() < poly_karatsuba_cutoff) {
+            poly_schoolbook(a.data(), a.size(), b.data(), b.size(), out);
+            return;
+        }
+        if (b.size() >= poly_transform_cutoff) {
+            if constexpr (std::floating_point<T>) {
+                poly_mul_fft(a, b, out, grain);
+                return;
+            }
+            else if constexpr (std::integral<T>) {
+                if (poly_mul_ntt(a, b, out, grain)) {
+                    return;
+                }
+            }
+        }
+        poly_karatsuba_unbalanced(a, b, out);
+    }
+
+    template <typename T>
+    std::vector<T> poly_mul_vector(std::span<const T> a, std::span<const T> b, std::size_t grain) {
+        if (a.empty() || b.empty()) {
+            return {};
+        }
+        std::vector<T> out(a.size() + b.size() - 1);
+        poly_mul_kernel(a, b, out.data(), grain);
+        return out;
+    }
+
+    template <typename T, typename IMPL1, typename IMPL2>
+    SeqContainer<T> poly_mul(const SeqContainer<T, IMPL1>& a, const SeqContainer<T, IMPL2>& b, std::size_t grain = default_grain) {
+        if constexpr (PolyWidened<T>) {
+            return poly_narrow<T>(poly_mul(poly_widen(a), poly_widen(b), grain));
+        }
+        else {
+            std::vector<T> a_buffer;
+            std::vector<T> b_buffer;
+            const auto x = poly_trimmed(poly_span(a, a_buffer));
+            const auto y = poly_trimmed(poly_span(b, b_buffer));
+            SeqContainer<T> out;
+            if (!x.empty() && !y.empty()) {
+                fill_sequence(out, x.size() + y.size() - 1, [&](T* data) {
+                    poly_mul_kernel(x, y, data, grain);
+                });
+            }
+            return out;
+        }
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                   Inverse & Division
+    //
+    /*****************************************************************************************/
+
+    /*
+        Floating point coefficients divide by any non zero value, and integer
+        coefficients only by a unit, 1 or -1, which is its own inverse.
+    */
+    template <typename T>
+    concept PolyDivisible = std::floating_point<T> || std::integral<T>;
+
+    template <PolyDivisible T>
+    bool poly_is_unit(T value) noexcept {
+        if constexpr (std::floating_point<T>) {
+            return value != T{};
+        }
+        else {
+            return value == T{ 1 } || value == static_cast<T>(-1);
+        }
+    }
+
+    template <PolyDivisible T>
+    T poly_unit_inverse(T value) noexcept {
+        if constexpr (std::floating_point<T>) {
+            return T{ 1 } / value;
+        }
+        else {
+            return value;
+        }
+    }
+
+    /*
+        The first 'k' coefficients of the power series 1 / b, where b[0] is a unit.
+    */
+    template <PolyDivisible T>
+    std::vector<T> poly_inverse_vector(std::span<const T> b, std::size_t k, std::size_t grain) {
+        std::vector<T> g{ poly_unit_inverse(b[0]) };
+        for (std::size_t length = 1; length < k;) {
+            const auto next = std::min(2 * length, k);
+            auto       e    = poly_mul_vector<T>(b.first(std::min(b.size(), next)), g, grain);
+            e.resize(next);
+            for (auto& value : e) {
+                value = T{} - value;
+            }
+            e[0] += T{ 2 };
+            g = poly_mul_vector<T>(g, e, grain);
+            g.resize(next);
+            length = next;
+        }
+        g.resize(k);
+        return g;
+    }
+
+    template <PolyDivisible T, typename IMPL>
+    SeqContainer<T> poly_inverse(const SeqContainer<T, IMPL>& b, std::size_t k, std::size_t grain = default_grain) {
+        if constexpr (PolyWidened<T>) {
+            return poly_narrow<T>(poly_inverse(poly_widen(b), k, grain));
+        }
+        else {
+            std::vector<T> buffer;
+            const auto     series = poly_span(b, buffer);
+            if (series.empty() || !poly_is_unit(series[0])) {
+                throw std::invalid_argument("poly_inverse: the constant coefficient is not invertible");
+            }
+            if (k == 0) {
+                return {};
+            }
+            const auto inverse = poly_inverse_vector(series, k, grain);
+            return poly_sequence<T>(inverse);
+        }
+    }
+
+    /*
+        Divides 'a' by 'b', whose last coefficient must be a unit, leaving the
+        b.size() - 1 coefficients of the remainder in 'remainder', and the
+        quotient in 'quotient' when it is not null.
+    */
+    template <PolyDivisible T>
+    void poly_divide(std::span<const T> a, std::span<const T> b, std::vector<T>* quotient, std::vector<T>& remainder, std::size_t grain) {
+        const auto nb = b.size();
+        if (a.size() < nb) {
+            remainder.assign(a.begin(), a.end());
+            remainder.resize(nb - 1);
+            if (quotient) {
+                quotient->clear();
+            }
+            return;
+        }
+        const auto k = a.size() - nb + 1;
+        std::vector<T> q(k);
+        if (nb <= poly_newton_cutoff || k <= poly_newton_cutoff) {
+            remainder.assign(a.begin(), a.end());
+            const T inverse = poly_unit_inverse(b[nb - 1]);
+            for (auto i = k; i-- > 0;) {
+                const T coefficient = remainder[i + nb - 1] * inverse;
+                q[i] = coefficient;
+                T* row = remainder.data() + i;
+                for (std::size_t j = 0; j < nb; ++j) {
+                    row[j] -= coefficient * b[j];
+                }
+            }
+            remainder.resize(nb - 1);
+        }
+        else {
+            const std::vector<T> reversed_b(b.rbegin(), b.rbegin() + std::min(nb, k));
+            const std::vector<T> reversed_a(a.rbegin(), a.rbegin() + k);
+            q = poly_mul_vector<T>(reversed_a, poly_inverse_vector<T>(reversed_b, k, grain), grain);
+            q.resize(k);
+            std::reverse(q.begin(), q.end());
+
+            remainder.assign(a.begin(), a.begin() + (nb - 1));
+            if (nb > 1) {
+                const auto low = poly_mul_vector<T>(b.first(nb - 1), std::span<const T>(q).first(std::min(k, nb - 1)), grain);
+                for (std::size_t i = 0; i < nb - 1; ++i) {
+                    remainder[i] -= low[i];
+                }
+            }
+        }
+        if (quotient) {
+            *quotient = std::move(q);
+        }
+    }
+
+    /*
+        Returns the quotient, of a.size() - b.size() + 1 coefficients, and the
+        remainder, of b.size() - 1 coefficients, of 'a' divided by 'b', each
+        counted without trailing zeros.
+    */
+    template <PolyDivisible T, typename IMPL1, typename IMPL2>
+    auto poly_divmod(const SeqContainer<T, IMPL1>& a, const SeqContainer<T, IMPL2>& b, std::size_t grain = default_grain) -> std::pair<SeqContainer<T>, SeqContainer<T>> {
+        if constexpr (PolyWidened<T>) {
+            const auto [quotient, remainder] = poly_divmod(poly_widen(a), poly_widen(b), grain);
+            return { poly_narrow<T>(quotient), poly_narrow<T>(remainder) };
+        }
+        else {
+            std::vector<T> a_buffer;
+            std::vector<T> b_buffer;
+            const auto dividend = poly_trimmed(poly_span(a, a_buffer));
+            const auto divisor  = poly_trimmed(poly_span(b, b_buffer));
+            if (divisor.empty()) {
+                throw std::invalid_argument("poly_divmod: division by the zero polynomial");
+            }
+            if (!poly_is_unit(divisor.back())) {
+                throw std::invalid_argument("poly_divmod: the leading coefficient is not invertible");
+            }
+            std::vector<T> quotient;
+            std::vector<T> remainder;
+            poly_divide(dividend, divisor, &quotient, remainder, grain);
+            return { poly_sequence<T>(quotient), poly_sequence<T>(remainder) };
+        }
+    }
+
+    template <PolyDivisible T, typename IMPL1, typename IMPL2>
+    SeqContainer<T> poly_div(const SeqContainer<T, IMPL1>& a, const SeqContainer<T, IMPL2>& b, std::size_t grain = default_grain) {
+        return poly_divmod(a, b, grain).first;
+    }
+
+    template <PolyDivisible T, typename IMPL1, typename IMPL2>
+    SeqContainer<T> poly_mod(const SeqContainer<T, IMPL1>& a, const SeqContainer<T, IMPL2>& b, std::size_t grain = default_grain) {
+        return poly_divmod(a, b, grain).second;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                       Evaluation
+    //
+    /*****************************************************************************************/
+
+    template <typename T>
+    T horner(std::span<const T> p, T x) {
+        const auto point = poly_widen(x);
+        poly_word<T> result{};
+        for (auto i = p.size(); i-- > 0;) {
+            result = result * point + poly_widen(p[i]);
+        }
+        return static_cast<T>(result);
+    }
+
+    template <typename T, typename IMPL>
+    T horner(const SeqContainer<T, IMPL>& p, T x) {
+        std::vector<T> buffer;
+        return horner(poly_span(p, buffer), x);
+    }
+
+    /*
+        Writes p(x[i]) to y[i] for i in [first, last), a block of lanes at a time.
+    */
+    template <typename T, typename Reader>
+    void horner_block(std::span<const T> p, const Reader& x, T* y, std::size_t first, std::size_t last) {
+        using U = poly_word<T>;
+        U point[poly_horner_lanes];
+        U value[poly_horner_lanes];
+        for (auto base = first; base < last; base += poly_horner_lanes) {
+            const auto lanes = std::min(poly_horner_lanes, last - base);
+            for (std::size_t j = 0; j < lanes; ++j) {
+                point[j] = poly_widen<T>(x[base + j]);
+                value[j] = U{};
+            }
+            for (auto i = p.size(); i-- > 0;) {
+                const U coefficient = poly_widen(p[i]);
+                for (std::size_t j = 0; j < lanes; ++j) {
+                    value[j] = value[j] * point[j] + coefficient;
+                }
+            }
+            for (std::size_t j = 0; j < lanes; ++j) {
+                y[base + j] = static_cast<T>(value[j]);
+            }
+        }
+    }
+
+    /*
+        Returns p at every element of 'xs', a SeqContainer or an expression.
+        'grain' counts multiply adds, so a polynomial of high degree is split
+        over more blocks than one of low degree.
+    */
+    template <typename T, typename IMPL, typename Expr> requires std::same_as<expr_value_type<Expr>, T>
+    auto poly_eval(const SeqContainer<T, IMPL>& p, const Expr& xs, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        std::vector<T> buffer;
+        const auto     coefficients = poly_trimmed(poly_span(p, buffer));
+        const auto     count        = xs.size();
+        const auto     in           = element_reader(xs);
+        const auto     points       = std::max<std::size_t>(grain / std::max<std::size_t>(coefficients.size(), 1), 1);
+        sequence_type_of<Expr> out;
+        fill_sequence(out, count, [&](T* data) {
+            parallel_for(count, points, [&](std::size_t first, std::size_t last, std::size_t) {
+                horner_block(coefficients, in, data, first, last);
+            });
+        });
+        return out;
+    }
+
+    /*
+        Returns p at every element of 'xs' through a subproduct tree.  Level 0 of
+        the tree holds the product of (x - x_i) over each run of poly_leaf_points
+        points, and each node above is the product of its two children, up to
+        nodes of about as many points as p has coefficients.  The remainder of p
+        modulo a node of higher degree is p itself, so the tree stops there, as
+        a forest, which also bounds the magnitude of the products.
+    */
+    template <typename T, typename IMPL, typename Expr> requires std::integral<T> && std::same_as<expr_value_type<Expr>, T>
+    auto poly_eval_multipoint(const SeqContainer<T, IMPL>& p, const Expr& xs, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        std::vector<T> buffer;
+        const auto     coefficients = poly_trimmed(poly_span(p, buffer));
+        const auto     count        = xs.size();
+        if (count <= poly_leaf_points || coefficients.size() <= poly_leaf_points) {
+            return poly_eval(p, xs, grain);
+        }
+        if constexpr (PolyWidened<T>) {
+            SeqContainer<poly_word<T>> points;
+            fill_sequence(points, count, [&](poly_word<T>* data) {
+                const auto in = element_reader(xs);
+                for (std::size_t i = 0; i < count; ++i) {
+                    data[i] = poly_widen<T>(in[i]);
+                }
+            });
+            const auto values = poly_eval_multipoint(poly_widen(p), points, grain);
+            sequence_type_of<Expr> out;
+            fill_sequence(out, count, [&](T* data) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    data[i] = static_cast<T>(values[i]);
+                }
+            });
+            return out;
+        }
+        else {
+            std::vector<T> points(count);
+            {
+                const auto in = element_reader(xs);
+                for (std::size_t i = 0; i < count; ++i) {
+                    points[i] = in[i];
+                }
+            }
+
+            /*
+                Nodes of a level are computed in parallel, each on one thread, and
+                the few nodes at the top of the tree run their products in parallel.
+            */
+            auto for_nodes = [&](std::size_t nodes, auto&& func) {
+                const auto inner = nodes > 1 ? poly_serial_grain : grain;
+                parallel_for(nodes, 1, [&](std::size_t first, std::size_t last, std::size_t) {
+                    for (auto node = first; node < last; ++node) {
+                        func(node, inner);
+                    }
+                });
+            };
+
+            std::vector<std::vector<std::vector<T>>> tree(1);
+            tree[0].resize((count + poly_leaf_points - 1) / poly_leaf_points);
+            for_nodes(tree[0].size(), [&](std::size_t node, std::size_t) {
+                const auto first = node * poly_leaf_points;
+                const auto last  = std::min(first + poly_leaf_points, count);
+                auto&      leaf  = tree[0][node];
+                leaf.assign(last - first + 1, T{});
+                leaf[0] = T{ 1 };
+                for (auto i = first; i < last; ++i) {
+                    const auto degree = i - first;
+                    for (auto j = degree + 1; j > 0; --j) {
+                        leaf[j] = leaf[j - 1] - points[i] * leaf[j];
+                    }
+                    leaf[0] = -points[i] * leaf[0];
+                }
+            });
+            for (auto span = poly_leaf_points; tree.back().size() > 1 && span < coefficients.size(); span *= 2) {
+                const auto& below = tree.back();
+                std::vector<std::vector<T>> level((below.size() + 1) / 2);
+                for_nodes(level.size(), [&](std::size_t node, std::size_t inner) {
+                    if (2 * node + 1 < below.size()) {
+                        level[node] = poly_mul_vector<T>(below[2 * node], below[2 * node + 1], inner);
+                    }
+                    else {
+                        level[node] = below[2 * node];
+                    }
+                });
+                tree.push_back(std::move(level));
+            }
+
+            std::vector<std::vector<T>> remainders(tree.back().size());
+            for_nodes(remainders.size(), [&](std::size_t node, std::size_t inner) {
+                poly_divide<T>(coefficients, tree.back()[node], nullptr, remainders[node], inner);
+            });
+            for (auto depth = tree.size() - 1; depth-- > 0;) {
+                const auto& nodes = tree[depth];
+                std::vector<std::vector<T>> level(nodes.size());
+                for_nodes(nodes.size(), [&](std::size_t node, std::size_t inner) {
+                    poly_divide<T>(remainders[node / 2], nodes[node], nullptr, level[node], inner);
+                });
+                remainders = std::move(level);
+            }
+
+            sequence_type_of<Expr> out;
+            fill_sequence(out, count, [&](T* data) {
+                for_nodes(remainders.size(), [&](std::size_t node, std::size_t) {
+                    const auto first = node * poly_leaf_points;
+                    const auto last  = std::min(first + poly_leaf_points, count);
+                    horner_block<T>(remainders[node], points.data(), data, first, last);
+                });
+            });
+            return out;
+        }
+    }
+}
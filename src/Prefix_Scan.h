@@ -0,0 +1,206 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "Parallel.h"
+#include "Reductions.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                      Prefix Scans
+    //
+    //          inclusive_scan<Op>(x)        out[i] = x[0] Op x[1] Op ... Op x[i]
+    //          exclusive_scan<Op>(x, init)  out[i] = init Op x[0] Op ... Op x[i - 1]
+    //
+    //          Op is any associative operation struct, such as those defined within
+    //          Operator_Templates.h.  It need not be commutative.  The input may be a
+    //          SeqContainer or an expression template, which is then evaluated as it
+    //          is scanned, without being materialized first.
+    //
+    //          Large inputs are scanned with the two pass, (reduce then scan),
+    //          algorithm.  The first pass reduces every block in parallel with
+    //          independent accumulators, the block totals are then scanned serially,
+    //          and the second pass scans every block in parallel starting from the
+    //          total of the blocks before it.
+    //
+    //          Within a block the scan is a single sequential loop.  A log step scan
+    //          of a register of lanes does several times the work per element, and
+    //          without target specific intrinsics was measured to be slower.
+    //
+    /********************************************************************************************/
+
+    /*
+        Reduces [first, last) of 'in' with independent accumulators.  Each lane
+        reduces its own contiguous sub-range, (the last lane also takes the
+        remainder), and the lanes are then combined in order, so that the
+        operands are never reordered.  The range must not be empty.
+    */
+    template <typename Op, typename T, typename Reader>
+    T block_reduce(const Reader& in, std::size_t first, std::size_t last) {
+        constexpr std::size_t lanes = 8;
+        if (last - first < 2 * lanes) {
+            T total = in[first];
+            for (std::size_t i = first + 1; i < last; ++i) {
+                const T value = in[i];
+                total = Op::apply(std::as_const(total), value);
+            }
+            return total;
+        }
+        const auto span = (last - first) / lanes;
+        std::array<T, lanes> partial;
+        for (std::size_t l = 0; l < lanes; ++l) {
+            partial[l] = in[first + l * span];
+        }
+        for (std::size_t k = 1; k < span; ++k) {
+            for (std::size_t l = 0; l < lanes; ++l) {
+                const T value = in[first + l * span + k];
+                partial[l] = Op::apply(std::as_const(partial[l]), value);
+            }
+        }
+        for (std::size_t i = first + lanes * span; i < last; ++i) {
+            const T value = in[i];
+            partial[lanes - 1] = Op::apply(std::as_const(partial[lanes - 1]), value);
+        }
+        T total = partial[0];
+        for (std::size_t l = 1; l < lanes; ++l) {
+            total = Op::apply(std::as_const(total), partial[l]);
+        }
+        return total;
+    }
+
+    /*
+        Scans [first, last) of 'in' into 'out' starting from 'carry', and returns
+        the carry into the next block.
+    */
+    template <typename Op, bool Inclusive, typename T, typename Reader>
+    T block_scan(const Reader& in, T* out, std::size_t first, std::size_t last, T carry) {
+        for (std::size_t i = first; i < last; ++i) {
+            const T value = in[i];
+            if constexpr (Inclusive) {
+                carry  = Op::apply(std::as_const(carry), value);
+                out[i] = carry;
+            }
+            else {
+                out[i] = carry;
+                carry  = Op::apply(std::as_const(carry), value);
+            }
+        }
+        return carry;
+    }
+
+    /*
+        Scans 'in' into the first 'count' elements of 'out'.  An inclusive scan
+        has no initial carry, so it seeds the carry from the first element.
+    */
+    template <typename Op, bool Inclusive, typename T, typename Reader>
+    void scan_into(const Reader& in, T* out, std::size_t count, T init, std::size_t grain) {
+        if (count == 0) {
+            return;
+        }
+        const auto blocks = block_count(count, grain);
+        if (blocks == 1) {
+            if constexpr (Inclusive) {
+                out[0] = in[0];
+                block_scan<Op, true>(in, out, 1, count, out[0]);
+            }
+            else {
+                block_scan<Op, false>(in, out, 0, count, init);
+            }
+            return;
+        }
+
+        std::vector<T> totals(blocks);
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [first, last] = block_range(count, blocks, block);
+            totals[block] = block_reduce<Op, T>(in, first, last);
+        });
+
+        std::vector<T> carries(blocks);
+        T carry = Inclusive ? totals[0] : Op::apply(std::as_const(init), totals[0]);
+        carries[0] = init;
+        for (std::size_t block = 1; block < blocks; ++block) {
+            carries[block] = carry;
+            carry = Op::apply(std::as_const(carry), totals[block]);
+        }
+
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [first, last] = block_range(count, blocks, block);
+            if (Inclusive && block == 0) {
+                out[0] = in[0];
+                block_scan<Op, true>(in, out, 1, last, out[0]);
+            }
+            else {
+                block_scan<Op, Inclusive>(in, out, first, last, carries[block]);
+            }
+        });
+    }
+
+    template <typename Op, typename Expr>
+    auto inclusive_scan(const Expr& expr, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        using value_type = expr_value_type<Expr>;
+        sequence_type_of<Expr> out;
+        fill_sequence(out, expr.size(), [&](value_type* data) {
+            scan_into<Op, true>(element_reader(expr), data, expr.size(), value_type{}, grain);
+        });
+        return out;
+    }
+
+    template <typename Op, typename Expr>
+    auto exclusive_scan(const Expr& expr, expr_value_type<Expr> init, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        using value_type = expr_value_type<Expr>;
+        sequence_type_of<Expr> out;
+        fill_sequence(out, expr.size(), [&](value_type* data) {
+            scan_into<Op, false>(element_reader(expr), data, expr.size(), init, grain);
+        });
+        return out;
+    }
+
+    template <typename Expr>
+    auto cumulative_sum(const Expr& expr) -> sequence_type_of<Expr> {
+        return inclusive_scan<Add_Op<expr_value_type<Expr>>>(expr);
+    }
+
+    template <typename Expr>
+    auto cumulative_product(const Expr& expr) -> sequence_type_of<Expr> {
+        return inclusive_scan<Mul_Op<expr_value_type<Expr>>>(expr);
+    }
+
+    template <typename Expr>
+    auto cumulative_min(const Expr& expr) -> sequence_type_of<Expr> {
+        return inclusive_scan<Min_Op<expr_value_type<Expr>>>(expr);
+    }
+
+    template <typename Expr>
+    auto cumulative_max(const Expr& expr) -> sequence_type_of<Expr> {
+        return inclusive_scan<Max_Op<expr_value_type<Expr>>>(expr);
+    }
+}
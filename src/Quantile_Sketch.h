@@ -0,0 +1,435 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Parallel.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                   'KllSketch' class
+    //
+    //          A mergeable summary of a stream of values, answering approximate
+    //          quantile and rank queries in space independent of the length of
+    //          the stream, after Karnin, Lang and Liberty.
+    //
+    //          Values are kept in a stack of compactors, where an item of level h
+    //          stands for 2^h values of the stream.  When the sketch is full, the
+    //          lowest full level is sorted and every other item, starting at a
+    //          random offset, is promoted to the level above, halving its size.
+    //          Level capacities shrink geometrically by 2/3 below the top level,
+    //          which holds 'k' items, so the sketch holds O(k) items in all and
+    //          the rank error is about 1.7 / k of the count with high probability.
+    //
+    //          Sketches of separate chunks of a sequence, or of separate streams,
+    //          merge into a sketch of their union with the same error bound.  So a
+    //          large sequence is sketched in parallel, one block per thread, and
+    //          the sketches of the blocks are merged.  The exact minimum and
+    //          maximum are also kept, and bound every answer.
+    //
+    /********************************************************************************************/
+
+    template <typename VALUE = double>
+    class KllSketch {
+
+    public:
+        using value_type = VALUE;
+
+        static constexpr std::size_t default_k = 200;
+
+        explicit KllSketch(std::size_t k = default_k, std::uint64_t seed = 0);
+
+        void update(const value_type& value);
+
+        template <typename Expr> requires requires (const Expr& chunk) { chunk.size(); chunk[0]; }
+        void update(const Expr& chunk);
+
+        KllSketch& merge(const KllSketch& other);
+
+        std::size_t k() const noexcept;
+        std::size_t count() const noexcept;
+        std::size_t retained() const noexcept;
+        bool        empty() const noexcept;
+
+        value_type  min() const;
+        value_type  max() const;
+
+        double      rank(const value_type& value) const;
+        value_type  quantile(double q) const;
+
+        template <typename Expr>
+        SeqContainer<value_type> quantiles(const Expr& fractions) const;
+
+    private:
+        std::size_t                          _k;
+        std::uint64_t                        _state;
+        std::size_t                          _count;
+        std::size_t                          _retained;
+        std::size_t                          _capacity;
+        value_type                           _min;
+        value_type                           _max;
+        std::vector<std::vector<value_type>> _levels;
+
+        std::size_t capacity(std::size_t level) const noexcept;
+        void        add_level();
+        bool        random_bit() noexcept;
+        void        compress();
+        void        compact(std::size_t level);
+
+        std::vector<std::pair<value_type, std::size_t>> weighted_items() const;
+        value_type  quantile_of(const std::vector<std::pair<value_type, std::size_t>>& items, double q) const;
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                    Construction
+    //
+    /*****************************************************************************************/
+
+    template <typename VALUE>
+    inline KllSketch<VALUE>::KllSketch(std::size_t k, std::uint64_t seed)
+        : _k(std::max<std::size_t>(k, 8)), _state(seed ^ 0x9E3779B97F4A7C15ull), _count(0), _retained(0), _capacity(0), _min(), _max(), _levels() {
+        add_level();
+    }
+
+    template <typename VALUE>
+    inline std::size_t KllSketch<VALUE>::k() const noexcept {
+        return _k;
+    }
+
+    template <typename VALUE>
+    inline std::size_t KllSketch<VALUE>::count() const noexcept {
+        return _count;
+    }
+
+    template <typename VALUE>
+    inline std::size_t KllSketch<VALUE>::retained() const noexcept {
+        return _retained;
+    }
+
+    template <typename VALUE>
+    inline bool KllSketch<VALUE>::empty() const noexcept {
+        return _count == 0;
+    }
+
+    template <typename VALUE>
+    inline KllSketch<VALUE>::value_type KllSketch<VALUE>::min() const {
+        return _min;
+    }
+
+    template <typename VALUE>
+    inline KllSketch<VALUE>::value_type KllSketch<VALUE>::max() const {
+        return _max;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                     Compaction
+    //
+    /*****************************************************************************************/
+
+    template <typename VALUE>
+    inline std::size_t KllSketch<VALUE>::capacity(std::size_t level) const noexcept {
+        const auto depth = static_cast<double>(_levels.size() - 1 - level);
+        return std::max<std::size_t>(static_cast<std::size_t>(std::ceil(static_cast<double>(_k) * std::pow(2.0 / 3.0, depth))), 2);
+    }
+
+    /*
+        Adding a level shrinks the capacity of every level below it, so the
+        total capacity is recomputed.
+    */
+    template <typename VALUE>
+    inline void KllSketch<VALUE>::add_level() {
+        _levels.emplace_back();
+        _capacity = 0;
+        for (std::size_t level = 0; level < _levels.size(); ++level) {
+            _capacity += capacity(level);
+        }
+    }
+
+    template <typename VALUE>
+    inline bool KllSketch<VALUE>::random_bit() noexcept {
+        _state ^= _state << 13;
+        _state ^= _state >> 7;
+        _state ^= _state << 17;
+        return (_state >> 32) & 1;
+    }
+
+    /*
+        Promotes every other item of a sorted level, leaving the odd one out,
+        (if any), behind, so the total weight is unchanged.
+    */
+    template <typename VALUE>
+    inline void KllSketch<VALUE>::compact(std::size_t level) {
+        if (level + 1 == _levels.size()) {
+            add_level();
+        }
+        auto& items = _levels[level];
+        std::sort(items.begin(), items.end());
+        const auto begin  = items.size() % 2;
+        const auto offset = static_cast<std::size_t>(random_bit());
+        auto& above = _levels[level + 1];
+        for (auto i = begin + offset; i < items.size(); i += 2) {
+            above.push_back(items[i]);
+        }
+        _retained -= (items.size() - begin) / 2;
+        items.resize(begin);
+    }
+
+    template <typename VALUE>
+    inline void KllSketch<VALUE>::compress() {
+        while (_retained > _capacity) {
+            for (std::size_t level = 0; level < _levels.size(); ++level) {
+                if (_levels[level].size() >= capacity(level)) {
+                    compact(level);
+                    break;
+                }
+            }
+        }
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                   Updating & Merging
+    //
+    /*****************************************************************************************/
+
+    template <typename VALUE>
+    inline void KllSketch<VALUE>::update(const value_type& value) {
+        if (_count == 0) {
+            _min = value;
+            _max = value;
+        }
+        else {
+            _min = value < _min ? value : _min;
+            _max = _max < value ? value : _max;
+        }
+        ++_count;
+        ++_retained;
+        _levels[0].push_back(value);
+        if (_retained > _capacity) {
+            compress();
+        }
+    }
+
+    template <typename VALUE>
+    template <typename Expr> requires requires (const Expr& chunk) { chunk.size(); chunk[0]; }
+    inline void KllSketch<VALUE>::update(const Expr& chunk) {
+        const auto in = element_reader(chunk);
+        for (std::size_t i = 0; i < chunk.size(); ++i) {
+            update(static_cast<value_type>(in[i]));
+        }
+    }
+
+    template <typename VALUE>
+    inline KllSketch<VALUE>& KllSketch<VALUE>::merge(const KllSketch& other) {
+        if (other._count == 0) {
+            return *this;
+        }
+        if (_count == 0) {
+            _min = other._min;
+            _max = other._max;
+        }
+        else {
+            _min = other._min < _min ? other._min : _min;
+            _max = _max < other._max ? other._max : _max;
+        }
+        while (_levels.size() < other._levels.size()) {
+            add_level();
+        }
+        for (std::size_t level = 0; level < other._levels.size(); ++level) {
+            _levels[level].insert(_levels[level].end(), other._levels[level].begin(), other._levels[level].end());
+        }
+        _count    += other._count;
+        _retained += other._retained;
+        compress();
+        return *this;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                       Queries
+    //
+    /*****************************************************************************************/
+
+    template <typename VALUE>
+    inline std::vector<std::pair<typename KllSketch<VALUE>::value_type, std::size_t>> KllSketch<VALUE>::weighted_items() const {
+        std::vector<std::pair<value_type, std::size_t>> items;
+        items.reserve(_retained);
+        for (std::size_t level = 0; level < _levels.size(); ++level) {
+            for (const auto& value : _levels[level]) {
+                items.emplace_back(value, std::size_t{ 1 } << level);
+            }
+        }
+        std::sort(items.begin(), items.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        return items;
+    }
+
+    /*
+        Returns the estimated fraction of the values which are less than or
+        equal to 'value'.
+    */
+    template <typename VALUE>
+    inline double KllSketch<VALUE>::rank(const value_type& value) const {
+        if (_count == 0) {
+            return 0.0;
+        }
+        std::size_t weight = 0;
+        for (std::size_t level = 0; level < _levels.size(); ++level) {
+            for (const auto& item : _levels[level]) {
+                weight += static_cast<std::size_t>(!(value < item)) << level;
+            }
+        }
+        return static_cast<double>(weight) / static_cast<double>(_count);
+    }
+
+    template <typename VALUE>
+    inline KllSketch<VALUE>::value_type KllSketch<VALUE>::quantile_of(const std::vector<std::pair<value_type, std::size_t>>& items, double q) const {
+        if (q <= 0.0) {
+            return _min;
+        }
+        if (q >= 1.0) {
+            return _max;
+        }
+        const auto  target = q * static_cast<double>(_count);
+        std::size_t weight = 0;
+        for (const auto& [value, w] : items) {
+            weight += w;
+            if (static_cast<double>(weight) >= target) {
+                return value;
+            }
+        }
+        return _max;
+    }
+
+    /*
+        Returns the value whose estimated rank is 'q', 0 <= q <= 1.  The sketch
+        must not be empty.
+    */
+    template <typename VALUE>
+    inline KllSketch<VALUE>::value_type KllSketch<VALUE>::quantile(double q) const {
+        return quantile_of(weighted_items(), q);
+    }
+
+    /*
+        Returns the quantile of every fraction of 'fractions', sorting the items
+        of the sketch only once.
+    */
+    template <typename VALUE>
+    template <typename Expr>
+    inline SeqContainer<typename KllSketch<VALUE>::value_type> KllSketch<VALUE>::quantiles(const Expr& fractions) const {
+        const auto items = weighted_items();
+        SeqContainer<value_type> out;
+        fill_sequence(out, fractions.size(), [&](value_type* data) {
+            for (std::size_t f = 0; f < fractions.size(); ++f) {
+                data[f] = quantile_of(items, static_cast<double>(fractions[f]));
+            }
+        });
+        return out;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                  Building Sketches
+    //
+    //          'Sketch' is a fused item, so that a sketch may be built in the same
+    //          sweep as other reductions and statements:
+    //
+    //              auto [s, q] = fuse(sum(x), sketch(x));
+    //
+    /*****************************************************************************************/
+
+    template <typename Expr>
+    class Sketch {
+
+    public:
+        using value_type = expr_value_type<Expr>;
+
+        Sketch(const Expr& expr, std::size_t k) : _expr(expr), _sketch(k) {
+        }
+
+        void prepare() {
+        }
+
+        std::size_t size() const {
+            return _expr.size();
+        }
+
+        void run(std::size_t first, std::size_t last) {
+            last = std::min(last, size());
+            for (std::size_t i = first; i < last; ++i) {
+                _sketch.update(static_cast<value_type>(_expr[i]));
+            }
+        }
+
+        KllSketch<value_type> result() const {
+            return _sketch;
+        }
+
+    private:
+        const Expr&           _expr;
+        KllSketch<value_type> _sketch;
+    };
+
+    template <typename Expr>
+    auto sketch(const Expr& expr, std::size_t k = KllSketch<expr_value_type<Expr>>::default_k) -> Sketch<Expr> {
+        return Sketch<Expr>(expr, k);
+    }
+
+    /*
+        Sketches every block of 'expr' in parallel and merges the sketches.
+    */
+    template <typename Expr>
+    auto build_sketch(const Expr& expr, std::size_t k = KllSketch<expr_value_type<Expr>>::default_k, std::size_t grain = default_grain) -> KllSketch<expr_value_type<Expr>> {
+        using value_type = expr_value_type<Expr>;
+        const auto count  = expr.size();
+        const auto in     = element_reader(expr);
+        const auto blocks = block_count(count, grain);
+        std::vector<KllSketch<value_type>> sketches;
+        sketches.reserve(blocks);
+        for (std::size_t block = 0; block < blocks; ++block) {
+            sketches.emplace_back(k, block);
+        }
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [first, last] = block_range(count, blocks, block);
+            for (std::size_t i = first; i < last; ++i) {
+                sketches[block].update(static_cast<value_type>(in[i]));
+            }
+        });
+        for (std::size_t block = 1; block < blocks; ++block) {
+            sketches[0].merge(sketches[block]);
+        }
+        return std::move(sketches[0]);
+    }
+}
@@ -0,0 +1,279 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "Parallel.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                      Radix Sort
+    //
+    //          A parallel least significant digit radix sort for integer and IEEE
+    //          floating point sequences, sorting eight bits per pass.
+    //
+    //          Every value is first mapped to an unsigned key which sorts in the same
+    //          order: the sign bit of a signed integer is flipped, and a float has
+    //          its sign bit flipped when positive, or all of its bits flipped when
+    //          negative.  So -0.0 sorts before +0.0, and NaNs sort to the ends
+    //          according to their sign bit.
+    //
+    //          Each pass counts the digits of every block in parallel, computes the
+    //          offset of every (digit, block) pair, and then scatters every block in
+    //          parallel.  The sort is stable, and a pass is skipped when all of the
+    //          keys share the same digit, which is common for the high bytes of
+    //          small integers.
+    //
+    //          argsort() sorts the indices of the elements instead, which can then
+    //          be used to reorder other sequences with gather().
+    //
+    /********************************************************************************************/
+
+    template <typename T>
+    concept RadixSortable = (std::integral<T> && sizeof(T) <= 8) ||
+                            (std::floating_point<T> && std::numeric_limits<T>::is_iec559 && (sizeof(T) == 4 || sizeof(T) == 8));
+
+    template <typename T>
+    using radix_key_type = std::conditional_t<sizeof(T) == 1, std::uint8_t,
+                           std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                           std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+
+    constexpr std::size_t radix_bits    = 8;
+    constexpr std::size_t radix_buckets = std::size_t{ 1 } << radix_bits;
+    constexpr std::size_t radix_cutoff  = 512;
+
+    template <RadixSortable T>
+    radix_key_type<T> to_radix_key(T value) noexcept {
+        using key_type = radix_key_type<T>;
+        constexpr auto sign = static_cast<key_type>(key_type{ 1 } << (8 * sizeof(T) - 1));
+        if constexpr (std::floating_point<T>) {
+            const auto bits = std::bit_cast<key_type>(value);
+            return (bits & sign) ? static_cast<key_type>(~bits) : static_cast<key_type>(bits | sign);
+        }
+        else if constexpr (std::is_signed_v<T>) {
+            return static_cast<key_type>(static_cast<key_type>(value) ^ sign);
+        }
+        else {
+            return static_cast<key_type>(value);
+        }
+    }
+
+    template <RadixSortable T>
+    T from_radix_key(radix_key_type<T> key) noexcept {
+        using key_type = radix_key_type<T>;
+        constexpr auto sign = static_cast<key_type>(key_type{ 1 } << (8 * sizeof(T) - 1));
+        if constexpr (std::floating_point<T>) {
+            return std::bit_cast<T>((key & sign) ? static_cast<key_type>(key ^ sign) : static_cast<key_type>(~key));
+        }
+        else if constexpr (std::is_signed_v<T>) {
+            return static_cast<T>(static_cast<key_type>(key ^ sign));
+        }
+        else {
+            return static_cast<T>(key);
+        }
+    }
+
+    /*
+        Sorts 'keys', and 'index' along with them when it is not empty.  The
+        buffers are swapped with their scratch copies after every pass.
+    */
+    template <typename Key>
+    void radix_sort_keys(std::vector<Key>& keys, std::vector<std::size_t>& index, std::size_t grain) {
+        const auto count = keys.size();
+        const bool with_index = !index.empty();
+        if (count < 2) {
+            return;
+        }
+        if (count < radix_cutoff) {
+            if (with_index) {
+                std::vector<std::size_t> order(count);
+                std::iota(order.begin(), order.end(), std::size_t{ 0 });
+                std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+                    return keys[a] < keys[b];
+                });
+                std::vector<Key>         sorted_keys(count);
+                std::vector<std::size_t> sorted_index(count);
+                for (std::size_t i = 0; i < count; ++i) {
+                    sorted_keys[i]  = keys[order[i]];
+                    sorted_index[i] = index[order[i]];
+                }
+                keys.swap(sorted_keys);
+                index.swap(sorted_index);
+            }
+            else {
+                std::sort(keys.begin(), keys.end());
+            }
+            return;
+        }
+
+        const auto blocks = block_count(count, grain);
+        std::vector<Key>         keys_out(count);
+        std::vector<std::size_t> index_out(with_index ? count : 0);
+        std::vector<std::array<std::size_t, radix_buckets>> offsets(blocks);
+
+        for (std::size_t shift = 0; shift < 8 * sizeof(Key); shift += radix_bits) {
+            parallel_blocks(blocks, [&](std::size_t block) {
+                const auto [first, last] = block_range(count, blocks, block);
+                auto& counts = offsets[block];
+                counts.fill(0);
+                for (std::size_t i = first; i < last; ++i) {
+                    ++counts[(keys[i] >> shift) & (radix_buckets - 1)];
+                }
+            });
+
+            std::size_t total = 0;
+            bool        skip  = false;
+            for (std::size_t digit = 0; digit < radix_buckets; ++digit) {
+                std::size_t digit_total = 0;
+                for (std::size_t block = 0; block < blocks; ++block) {
+                    const auto digit_count = offsets[block][digit];
+                    offsets[block][digit] = total + digit_total;
+                    digit_total += digit_count;
+                }
+                skip   = skip || digit_total == count;
+                total += digit_total;
+            }
+            if (skip) {
+                continue;
+            }
+
+            parallel_blocks(blocks, [&](std::size_t block) {
+                const auto [first, last] = block_range(count, blocks, block);
+                auto& next = offsets[block];
+                for (std::size_t i = first; i < last; ++i) {
+                    const auto at = next[(keys[i] >> shift) & (radix_buckets - 1)]++;
+                    keys_out[at] = keys[i];
+                    if (with_index) {
+                        index_out[at] = index[i];
+                    }
+                }
+            });
+            keys.swap(keys_out);
+            if (with_index) {
+                index.swap(index_out);
+            }
+        }
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                   Sorting Functions
+    //
+    /*****************************************************************************************/
+
+    template <typename VALUE, typename IMPL> requires RadixSortable<VALUE>
+    SeqContainer<VALUE, IMPL>& radix_sort(SeqContainer<VALUE, IMPL>& seq, std::size_t grain = default_grain) {
+        using key_type = radix_key_type<VALUE>;
+        const auto count = seq.size();
+        std::vector<key_type>    keys(count);
+        std::vector<std::size_t> no_index;
+        const auto in = element_reader(seq);
+        parallel_for(count, grain, [&](std::size_t first, std::size_t last, std::size_t) {
+            for (std::size_t i = first; i < last; ++i) {
+                keys[i] = to_radix_key<VALUE>(in[i]);
+            }
+        });
+        radix_sort_keys(keys, no_index, grain);
+        fill_sequence(seq, count, [&](VALUE* data) {
+            parallel_for(count, grain, [&](std::size_t first, std::size_t last, std::size_t) {
+                for (std::size_t i = first; i < last; ++i) {
+                    data[i] = from_radix_key<VALUE>(keys[i]);
+                }
+            });
+        });
+        return seq;
+    }
+
+    template <typename Expr> requires RadixSortable<expr_value_type<Expr>>
+    auto sorted(const Expr& expr, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        sequence_type_of<Expr> out;
+        fill_sequence(out, expr.size(), [&](expr_value_type<Expr>* data) {
+            const auto in = element_reader(expr);
+            for (std::size_t i = 0; i < expr.size(); ++i) {
+                data[i] = in[i];
+            }
+        });
+        return radix_sort(out, grain);
+    }
+
+    /*
+        Returns the indices which stably sort 'expr', so that expr[index[0]] is
+        the smallest element.
+    */
+    template <typename Expr> requires RadixSortable<expr_value_type<Expr>>
+    auto argsort(const Expr& expr, std::size_t grain = default_grain) -> SeqContainer<std::size_t> {
+        using value_type = expr_value_type<Expr>;
+        using key_type   = radix_key_type<value_type>;
+        const auto count = expr.size();
+        std::vector<key_type>    keys(count);
+        std::vector<std::size_t> index(count);
+        const auto in = element_reader(expr);
+        parallel_for(count, grain, [&](std::size_t first, std::size_t last, std::size_t) {
+            for (std::size_t i = first; i < last; ++i) {
+                keys[i]  = to_radix_key<value_type>(in[i]);
+                index[i] = i;
+            }
+        });
+        radix_sort_keys(keys, index, grain);
+        SeqContainer<std::size_t> out;
+        fill_sequence(out, count, [&](std::size_t* data) {
+            std::copy(index.begin(), index.end(), data);
+        });
+        return out;
+    }
+
+    /*
+        Returns out[i] = expr[index[i]], reordering a sequence by the result of
+        argsort().  Indices past the end of 'expr' read as zero.
+    */
+    template <typename Expr, typename Index>
+    auto gather(const Expr& expr, const Index& index, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        using value_type = expr_value_type<Expr>;
+        const auto count = index.size();
+        sequence_type_of<Expr> out;
+        fill_sequence(out, count, [&](value_type* data) {
+            const auto at = element_reader(index);
+            parallel_for(count, grain, [&](std::size_t first, std::size_t last, std::size_t) {
+                for (std::size_t i = first; i < last; ++i) {
+                    data[i] = expr[static_cast<std::size_t>(at[i])];
+                }
+            });
+        });
+        return out;
+    }
+}
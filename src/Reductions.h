@@ -0,0 +1,272 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Statement_Fusion.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                  Multi Output Reductions
+    //
+    //          Reductions are fused items, the same as statements, so that several
+    //          results over the same leaves are computed in a single sweep:
+    //
+    //              auto [s, ss, lo, hi] = fuse(sum(x), sum(x * x), min_of(x), max_of(x));
+    //
+    //          Reductions and assignments may be mixed freely in one call of fuse(),
+    //          and the tuple holds a value per reduction and a reference per
+    //          statement, in the order the items were given.
+    //
+    //          Each reduction keeps a small number of independent accumulators, so
+    //          consecutive elements do not form a single dependency chain and the
+    //          loop can be vectorized.  Floating point results may therefore differ
+    //          in the last bits from a strictly sequential loop.
+    //
+    /********************************************************************************************/
+
+    template <typename Op, typename T>
+    struct Identity;
+
+    template <typename T>
+    struct Identity<Add_Op<T>, T> {
+        static constexpr T value() { return T{ 0 }; }
+    };
+
+    template <typename T>
+    struct Identity<Mul_Op<T>, T> {
+        static constexpr T value() { return T{ 1 }; }
+    };
+
+    template <typename T>
+    struct Identity<Min_Op<T>, T> {
+        static constexpr T value() {
+            return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+        }
+    };
+
+    template <typename T>
+    struct Identity<Max_Op<T>, T> {
+        static constexpr T value() {
+            return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+        }
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                     'Reduction' class
+    //
+    //          Folds every element of an expression with an associative Op.
+    //
+    /*****************************************************************************************/
+
+    template <typename Op, typename Expr>
+    class Reduction {
+
+    public:
+        using value_type = expr_value_type<Expr>;
+
+        static constexpr std::size_t lanes = 8;
+
+        Reduction(const Expr& expr, value_type identity) : _expr(expr), _identity(identity), _lanes() {
+            _lanes.fill(identity);
+        }
+
+        void prepare() {
+        }
+
+        std::size_t size() const {
+            return _expr.size();
+        }
+
+        void run(std::size_t first, std::size_t last) {
+            last = std::min(last, size());
+            std::size_t i = first;
+            for (; i + lanes <= last; i += lanes) {
+                for (std::size_t l = 0; l < lanes; ++l) {
+                    const value_type value = _expr[i + l];
+                    _lanes[l] = Op::apply(std::as_const(_lanes[l]), value);
+                }
+            }
+            for (; i < last; ++i) {
+                const value_type value = _expr[i];
+                _lanes[0] = Op::apply(std::as_const(_lanes[0]), value);
+            }
+        }
+
+        value_type result() const {
+            value_type total = _identity;
+            for (const auto& lane : _lanes) {
+                total = Op::apply(std::as_const(total), lane);
+            }
+            return total;
+        }
+
+    private:
+        const Expr&                       _expr;
+        value_type                        _identity;
+        std::array<value_type, lanes>     _lanes;
+    };
+
+    template <typename Op, typename Expr>
+    auto reduction(const Expr& expr) -> Reduction<Op, Expr> {
+        return Reduction<Op, Expr>(expr, Identity<Op, expr_value_type<Expr>>::value());
+    }
+
+    template <typename Expr>
+    auto sum(const Expr& expr) -> Reduction<Add_Op<expr_value_type<Expr>>, Expr> {
+        return reduction<Add_Op<expr_value_type<Expr>>>(expr);
+    }
+
+    template <typename Expr>
+    auto product(const Expr& expr) -> Reduction<Mul_Op<expr_value_type<Expr>>, Expr> {
+        return reduction<Mul_Op<expr_value_type<Expr>>>(expr);
+    }
+
+    template <typename Expr>
+    auto min_of(const Expr& expr) -> Reduction<Min_Op<expr_value_type<Expr>>, Expr> {
+        return reduction<Min_Op<expr_value_type<Expr>>>(expr);
+    }
+
+    template <typename Expr>
+    auto max_of(const Expr& expr) -> Reduction<Max_Op<expr_value_type<Expr>>, Expr> {
+        return reduction<Max_Op<expr_value_type<Expr>>>(expr);
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                      'Moments' class
+    //
+    //          Computes the count, mean and population variance of an expression.
+    //          Each tile is reduced with two passes over its, (cache resident),
+    //          elements, and the tiles are then merged with the pairwise update of
+    //          Chan, Golub and LeVeque, which avoids the cancellation of the sum of
+    //          squares formula.
+    //
+    //          An integral expression is accumulated in double, (or long double
+    //          when double cannot hold every value), so that the mean and variance
+    //          are neither truncated nor wrapped, and its result is a
+    //          MomentsResult<double>.
+    //
+    /*****************************************************************************************/
+
+    template <typename T>
+    using moments_value_type = std::conditional_t<std::is_integral_v<T>, double, T>;
+
+    template <typename T>
+    using moments_accumulator_type = std::conditional_t<std::is_integral_v<T>,
+        std::conditional_t<(std::numeric_limits<T>::digits > std::numeric_limits<double>::digits), long double, double>, T>;
+
+    template <typename T>
+    struct MomentsResult {
+        std::size_t count    = 0;
+        T           mean     = T{ 0 };
+        T           variance = T{ 0 };
+    };
+
+    template <typename Expr>
+    class Moments {
+
+    public:
+        using value_type  = moments_value_type<expr_value_type<Expr>>;
+        using accumulator = moments_accumulator_type<expr_value_type<Expr>>;
+
+        Moments(const Expr& expr) : _expr(expr), _count(0), _mean(0), _m2(0) {
+        }
+
+        void prepare() {
+        }
+
+        std::size_t size() const {
+            return _expr.size();
+        }
+
+        void run(std::size_t first, std::size_t last) {
+            last = std::min(last, size());
+            if (first >= last) {
+                return;
+            }
+            const auto count = last - first;
+            accumulator total = 0;
+            for (std::size_t i = first; i < last; ++i) {
+                total += static_cast<accumulator>(_expr[i]);
+            }
+            const accumulator mean = total / static_cast<accumulator>(count);
+            accumulator m2 = 0;
+            for (std::size_t i = first; i < last; ++i) {
+                const accumulator delta = static_cast<accumulator>(_expr[i]) - mean;
+                m2 += delta * delta;
+            }
+            const auto merged = _count + count;
+            const accumulator delta = mean - _mean;
+            _mean += delta * static_cast<accumulator>(count) / static_cast<accumulator>(merged);
+            _m2   += m2 + delta * delta * static_cast<accumulator>(_count) * static_cast<accumulator>(count) / static_cast<accumulator>(merged);
+            _count = merged;
+        }
+
+        MomentsResult<value_type> result() const {
+            if (_count == 0) {
+                return MomentsResult<value_type>{};
+            }
+            return MomentsResult<value_type>{ _count, static_cast<value_type>(_mean), static_cast<value_type>(_m2 / static_cast<accumulator>(_count)) };
+        }
+
+    private:
+        const Expr& _expr;
+        std::size_t _count;
+        accumulator _mean;
+        accumulator _m2;
+    };
+
+    template <typename Expr>
+    auto moments(const Expr& expr) -> Moments<Expr> {
+        return Moments<Expr>(expr);
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                  Convenience Functions
+    //
+    /*****************************************************************************************/
+
+    template <typename Expr>
+    auto mean_variance(const Expr& expr) -> MomentsResult<moments_value_type<expr_value_type<Expr>>> {
+        return std::get<0>(fuse(moments(expr)));
+    }
+
+    template <typename Expr>
+    auto min_max(const Expr& expr) -> std::pair<expr_value_type<Expr>, expr_value_type<Expr>> {
+        auto [lo, hi] = fuse(min_of(expr), max_of(expr));
+        return { lo, hi };
+    }
+}
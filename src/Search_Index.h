@@ -0,0 +1,298 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Parallel.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                   'SearchIndex' class
+    //
+    //          A search index built once over a sorted sequence, which answers
+    //          lower_bound and upper_bound queries with the rank of the result in
+    //          the sorted sequence.
+    //
+    //          The keys are stored in Eytzinger order, (the breadth first order of
+    //          the implicit binary search tree, with the children of node k at 2k
+    //          and 2k + 1), so the first levels of every search share the same few
+    //          cache lines, and the descendants of a node a few levels down share
+    //          a single cache line.  Each step of a search fetches that line ahead
+    //          of time and descends with k = 2k + (key[k] < x), without a data
+    //          dependent branch.
+    //
+    //          Batched lookups interleave a group of queries, descending every
+    //          query of the group one level at a time, so the cache misses of
+    //          independent queries overlap.  Groups are evaluated in parallel.
+    //
+    //          The sequence must be sorted in ascending order by operator<.
+    //
+    /********************************************************************************************/
+
+    /*
+        Hints the processor to fetch the cache line holding 'address'.
+    */
+    inline void prefetch_read(const void* address) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address, 0, 3);
+#else
+        static_cast<void>(address);
+#endif
+    }
+
+    template <typename VALUE = intmax_t>
+    class SearchIndex {
+
+    public:
+        using value_type = VALUE;
+
+        static constexpr std::size_t cache_line   = 64;
+        static constexpr std::size_t line_keys    = std::max<std::size_t>(cache_line / sizeof(VALUE), 1);
+        static constexpr std::size_t batch_width  = 16;
+
+        SearchIndex() = default;
+
+        template <typename Expr>
+        explicit SearchIndex(const Expr& sorted);
+
+        std::size_t size() const noexcept;
+        bool        empty() const noexcept;
+
+        std::size_t lower_bound(const value_type& key) const;
+        std::size_t upper_bound(const value_type& key) const;
+        bool        contains(const value_type& key) const;
+
+        template <typename Expr> SeqContainer<std::size_t> lower_bounds(const Expr& keys, std::size_t grain = default_grain) const;
+        template <typename Expr> SeqContainer<std::size_t> upper_bounds(const Expr& keys, std::size_t grain = default_grain) const;
+
+    private:
+        std::vector<value_type>  _storage;
+        std::size_t              _offset = 0;
+        std::vector<std::size_t> _ranks;
+        std::size_t              _size   = 0;
+
+        const value_type* keys() const noexcept;
+
+        template <typename Reader>
+        std::size_t build(const Reader& in, std::size_t rank, std::size_t node);
+
+        template <bool Upper>
+        std::size_t descend(const value_type& key) const;
+
+        template <bool Upper, typename Reader>
+        void search_range(const Reader& in, std::size_t* out, std::size_t first, std::size_t last) const;
+
+        template <bool Upper, typename Expr>
+        SeqContainer<std::size_t> search_all(const Expr& keys, std::size_t grain) const;
+
+        std::size_t rank_of(std::size_t node) const noexcept;
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                     Construction
+    //
+    /*****************************************************************************************/
+
+    /*
+        The keys are stored at nodes [1, size], behind an offset which places
+        node 0 at the start of a cache line.
+    */
+    template <typename VALUE>
+    template <typename Expr>
+    inline SearchIndex<VALUE>::SearchIndex(const Expr& sorted) : _storage(), _offset(0), _ranks(), _size(sorted.size()) {
+        _storage.resize(_size + 1 + line_keys);
+        if constexpr (cache_line % sizeof(value_type) == 0) {
+            const auto misalignment = reinterpret_cast<std::uintptr_t>(_storage.data()) % cache_line;
+            _offset = misalignment == 0 ? 0 : (cache_line - misalignment) / sizeof(value_type);
+        }
+        _ranks.resize(_size + 1);
+        build(element_reader(sorted), 0, 1);
+    }
+
+    /*
+        Fills the subtree under 'node' with the keys from 'rank' on, in order,
+        and returns the rank following the subtree.
+    */
+    template <typename VALUE>
+    template <typename Reader>
+    inline std::size_t SearchIndex<VALUE>::build(const Reader& in, std::size_t rank, std::size_t node) {
+        if (node <= _size) {
+            rank = build(in, rank, 2 * node);
+            _storage[_offset + node] = in[rank];
+            _ranks[node] = rank++;
+            rank = build(in, rank, 2 * node + 1);
+        }
+        return rank;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                      Searching
+    //
+    /*****************************************************************************************/
+
+    template <typename VALUE>
+    inline const typename SearchIndex<VALUE>::value_type* SearchIndex<VALUE>::keys() const noexcept {
+        return _storage.data() + _offset;
+    }
+
+    template <typename VALUE>
+    inline std::size_t SearchIndex<VALUE>::size() const noexcept {
+        return _size;
+    }
+
+    template <typename VALUE>
+    inline bool SearchIndex<VALUE>::empty() const noexcept {
+        return _size == 0;
+    }
+
+    /*
+        The path of a search is the bits of the final node.  The result is the
+        last node at which the search went left, which is found by dropping the
+        trailing right turns, (one bits), and the left turn before them.
+    */
+    template <typename VALUE>
+    inline std::size_t SearchIndex<VALUE>::rank_of(std::size_t node) const noexcept {
+        node >>= std::countr_one(node) + 1;
+        return node == 0 ? _size : _ranks[node];
+    }
+
+    template <typename VALUE>
+    template <bool Upper>
+    inline std::size_t SearchIndex<VALUE>::descend(const value_type& key) const {
+        const auto* data = keys();
+        std::size_t node = 1;
+        while (node <= _size) {
+            if (node * line_keys <= _size) {
+                prefetch_read(data + node * line_keys);
+            }
+            if constexpr (Upper) {
+                node = 2 * node + static_cast<std::size_t>(!(key < data[node]));
+            }
+            else {
+                node = 2 * node + static_cast<std::size_t>(data[node] < key);
+            }
+        }
+        return node;
+    }
+
+    template <typename VALUE>
+    inline std::size_t SearchIndex<VALUE>::lower_bound(const value_type& key) const {
+        return rank_of(descend<false>(key));
+    }
+
+    template <typename VALUE>
+    inline std::size_t SearchIndex<VALUE>::upper_bound(const value_type& key) const {
+        return rank_of(descend<true>(key));
+    }
+
+    template <typename VALUE>
+    inline bool SearchIndex<VALUE>::contains(const value_type& key) const {
+        auto node = descend<false>(key);
+        node >>= std::countr_one(node) + 1;
+        return node != 0 && !(key < keys()[node]);
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                    Batched Searches
+    //
+    /*****************************************************************************************/
+
+    /*
+        Every search descends exactly bit_width(size) levels, after which every
+        node is past the last key, so the queries of a group stay in step.
+    */
+    template <typename VALUE>
+    template <bool Upper, typename Reader>
+    inline void SearchIndex<VALUE>::search_range(const Reader& in, std::size_t* out, std::size_t first, std::size_t last) const {
+        const auto* data   = keys();
+        const auto  levels = static_cast<std::size_t>(std::bit_width(_size));
+        std::array<value_type, batch_width>  query;
+        std::array<std::size_t, batch_width> node;
+        for (auto at = first; at < last; at += batch_width) {
+            const auto width = std::min(batch_width, last - at);
+            for (std::size_t q = 0; q < width; ++q) {
+                query[q] = in[at + q];
+                node[q]  = 1;
+            }
+            for (std::size_t level = 0; level < levels; ++level) {
+                for (std::size_t q = 0; q < width; ++q) {
+                    const auto k = node[q];
+                    if (k > _size) {
+                        continue;
+                    }
+                    if (k * line_keys <= _size) {
+                        prefetch_read(data + k * line_keys);
+                    }
+                    if constexpr (Upper) {
+                        node[q] = 2 * k + static_cast<std::size_t>(!(query[q] < data[k]));
+                    }
+                    else {
+                        node[q] = 2 * k + static_cast<std::size_t>(data[k] < query[q]);
+                    }
+                }
+            }
+            for (std::size_t q = 0; q < width; ++q) {
+                out[at + q] = rank_of(node[q]);
+            }
+        }
+    }
+
+    template <typename VALUE>
+    template <bool Upper, typename Expr>
+    inline SeqContainer<std::size_t> SearchIndex<VALUE>::search_all(const Expr& queries, std::size_t grain) const {
+        SeqContainer<std::size_t> out;
+        fill_sequence(out, queries.size(), [&](std::size_t* data) {
+            const auto in = element_reader(queries);
+            parallel_for(queries.size(), grain, [&](std::size_t first, std::size_t last, std::size_t) {
+                search_range<Upper>(in, data, first, last);
+            });
+        });
+        return out;
+    }
+
+    template <typename VALUE>
+    template <typename Expr>
+    inline SeqContainer<std::size_t> SearchIndex<VALUE>::lower_bounds(const Expr& queries, std::size_t grain) const {
+        return search_all<false>(queries, grain);
+    }
+
+    template <typename VALUE>
+    template <typename Expr>
+    inline SeqContainer<std::size_t> SearchIndex<VALUE>::upper_bounds(const Expr& queries, std::size_t grain) const {
+        return search_all<true>(queries, grain);
+    }
+}
@@ -0,0 +1,288 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "Prefix_Scan.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                              Segmented Reductions & Scans
+    //
+    //          A sequence of values is split into segments, either by a mask of
+    //          flags, where a non zero flag starts a new segment, or by a sorted
+    //          sequence of keys, where a new segment starts whenever the key changes.
+    //          The first element always starts a segment.  Flags and keys past the
+    //          end of their sequence read as zero and as equal respectively.
+    //
+    //          A segmented reduction produces one result per segment in a compact
+    //          sequence, and a segmented scan restarts at the start of every segment.
+    //
+    //          Both run in parallel over blocks of elements.  Within a block, the
+    //          start of the next segment is searched for and the run up to it is
+    //          reduced, (or scanned), with a branch free loop.  The pieces of a
+    //          segment spanning several blocks are then combined in block order,
+    //          so Op only needs to be associative.
+    //
+    /********************************************************************************************/
+
+    /*
+        Returns the index of the first segment start in [first, last), or last.
+    */
+    template <typename Starts>
+    std::size_t next_segment_start(const Starts& is_start, std::size_t first, std::size_t last) {
+        while (first < last && !is_start(first)) {
+            ++first;
+        }
+        return first;
+    }
+
+    template <typename Flags>
+    auto flag_starts(const Flags& flags) {
+        return [reader = element_reader(flags), size = flags.size()](std::size_t i) -> bool {
+            return i == 0 || (i < size && static_cast<bool>(reader[i]));
+        };
+    }
+
+    template <typename Keys>
+    auto key_starts(const Keys& keys) {
+        return [reader = element_reader(keys), size = keys.size()](std::size_t i) -> bool {
+            return i == 0 || (i < size && reader[i] != reader[i - 1]);
+        };
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                 Segmented Reductions
+    //
+    /*****************************************************************************************/
+
+    /*
+        Reduces every segment of 'in', defined by 'is_start', and returns one value
+        per segment along with the index at which each segment starts.
+    */
+    template <typename Op, typename T, typename Reader, typename Starts>
+    std::pair<std::vector<T>, std::vector<std::size_t>> segmented_reduce_into(const Reader& in, std::size_t count, const Starts& is_start, std::size_t grain) {
+        std::vector<T>           results;
+        std::vector<std::size_t> heads;
+        if (count == 0) {
+            return { std::move(results), std::move(heads) };
+        }
+        const auto blocks = block_count(count, grain);
+
+        std::vector<std::vector<std::size_t>> block_heads(blocks);
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [first, last] = block_range(count, blocks, block);
+            for (auto i = next_segment_start(is_start, first, last); i < last; i = next_segment_start(is_start, i + 1, last)) {
+                block_heads[block].push_back(i);
+            }
+        });
+
+        std::vector<std::size_t> offsets(blocks + 1, 0);
+        for (std::size_t block = 0; block < blocks; ++block) {
+            offsets[block + 1] = offsets[block] + block_heads[block].size();
+        }
+        results.resize(offsets[blocks]);
+        heads.resize(offsets[blocks]);
+
+        /*
+            The leading run of a block belongs to a segment started in an earlier
+            block, and is kept aside to be combined in block order.
+        */
+        std::vector<std::optional<T>> leading(blocks);
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [first, last] = block_range(count, blocks, block);
+            const auto& local = block_heads[block];
+            const auto  head  = local.empty() ? last : local.front();
+            if (first < head) {
+                leading[block] = block_reduce<Op, T>(in, first, head);
+            }
+            for (std::size_t s = 0; s < local.size(); ++s) {
+                const auto end = s + 1 < local.size() ? local[s + 1] : last;
+                results[offsets[block] + s] = block_reduce<Op, T>(in, local[s], end);
+                heads[offsets[block] + s]   = local[s];
+            }
+        });
+
+        for (std::size_t block = 1; block < blocks; ++block) {
+            if (leading[block]) {
+                auto& result = results[offsets[block] - 1];
+                result = Op::apply(std::as_const(result), *leading[block]);
+            }
+        }
+        return { std::move(results), std::move(heads) };
+    }
+
+    template <typename Op, typename Expr, typename Flags>
+    auto segmented_reduce(const Expr& values, const Flags& flags, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        using value_type = expr_value_type<Expr>;
+        auto [results, heads] = segmented_reduce_into<Op, value_type>(element_reader(values), values.size(), flag_starts(flags), grain);
+        sequence_type_of<Expr> out;
+        fill_sequence(out, results.size(), [&](value_type* data) {
+            std::move(results.begin(), results.end(), data);
+        });
+        return out;
+    }
+
+    /*
+        Returns the key and the reduction of every run of equal keys.
+    */
+    template <typename Op, typename Expr, typename Keys>
+    auto reduce_by_key(const Expr& values, const Keys& keys, std::size_t grain = default_grain) -> std::pair<sequence_type_of<Keys>, sequence_type_of<Expr>> {
+        using value_type = expr_value_type<Expr>;
+        using key_type   = expr_value_type<Keys>;
+        auto [results, heads] = segmented_reduce_into<Op, value_type>(element_reader(values), values.size(), key_starts(keys), grain);
+        sequence_type_of<Keys> out_keys;
+        sequence_type_of<Expr> out_values;
+        fill_sequence(out_keys, heads.size(), [&](key_type* data) {
+            for (std::size_t s = 0; s < heads.size(); ++s) {
+                data[s] = heads[s] < keys.size() ? keys[heads[s]] : key_type{};
+            }
+        });
+        fill_sequence(out_values, results.size(), [&](value_type* data) {
+            std::move(results.begin(), results.end(), data);
+        });
+        return { std::move(out_keys), std::move(out_values) };
+    }
+
+    template <typename Expr, typename Flags>
+    auto segmented_sum(const Expr& values, const Flags& flags) -> sequence_type_of<Expr> {
+        return segmented_reduce<Add_Op<expr_value_type<Expr>>>(values, flags);
+    }
+
+    template <typename Expr, typename Flags>
+    auto segmented_min(const Expr& values, const Flags& flags) -> sequence_type_of<Expr> {
+        return segmented_reduce<Min_Op<expr_value_type<Expr>>>(values, flags);
+    }
+
+    template <typename Expr, typename Flags>
+    auto segmented_max(const Expr& values, const Flags& flags) -> sequence_type_of<Expr> {
+        return segmented_reduce<Max_Op<expr_value_type<Expr>>>(values, flags);
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                   Segmented Scans
+    //
+    /*****************************************************************************************/
+
+    /*
+        Inclusively scans [first, last) of 'in' into 'out', restarting at every
+        segment start.  'carry' continues a segment started in an earlier block.
+        Returns the carry into the next block.
+    */
+    template <typename Op, typename T, typename Reader, typename Starts>
+    std::optional<T> segmented_block_scan(const Reader& in, T* out, std::size_t first, std::size_t last, const Starts& is_start, std::optional<T> carry) {
+        auto run = first;
+        while (run < last) {
+            auto end = next_segment_start(is_start, run + 1, last);
+            if (is_start(run) || !carry) {
+                out[run] = in[run];
+            }
+            else {
+                const T value = in[run];
+                out[run] = Op::apply(std::as_const(*carry), value);
+            }
+            carry = block_scan<Op, true>(in, out, run + 1, end, out[run]);
+            run   = end;
+        }
+        return carry;
+    }
+
+    template <typename Op, typename T, typename Reader, typename Starts>
+    void segmented_scan_into(const Reader& in, T* out, std::size_t count, const Starts& is_start, std::size_t grain) {
+        if (count == 0) {
+            return;
+        }
+        const auto blocks = block_count(count, grain);
+        if (blocks == 1) {
+            segmented_block_scan<Op>(in, out, 0, count, is_start, std::optional<T>());
+            return;
+        }
+
+        /*
+            The tail of a block is the reduction of the elements after its last
+            segment start, and flows into the next block unless it starts a segment.
+        */
+        std::vector<std::optional<T>> tails(blocks);
+        std::vector<char>             restarts(blocks, 0);
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [first, last] = block_range(count, blocks, block);
+            auto tail = first;
+            for (auto i = next_segment_start(is_start, first, last); i < last; i = next_segment_start(is_start, i + 1, last)) {
+                tail = i;
+                restarts[block] = 1;
+            }
+            tails[block] = block_reduce<Op, T>(in, tail, last);
+        });
+
+        std::vector<std::optional<T>> carries(blocks);
+        for (std::size_t block = 1; block < blocks; ++block) {
+            const auto& previous = tails[block - 1];
+            if (restarts[block - 1] || !carries[block - 1]) {
+                carries[block] = previous;
+            }
+            else {
+                carries[block] = Op::apply(std::as_const(*carries[block - 1]), *previous);
+            }
+        }
+
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [first, last] = block_range(count, blocks, block);
+            segmented_block_scan<Op>(in, out, first, last, is_start, carries[block]);
+        });
+    }
+
+    template <typename Op, typename Expr, typename Flags>
+    auto segmented_inclusive_scan(const Expr& values, const Flags& flags, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        using value_type = expr_value_type<Expr>;
+        sequence_type_of<Expr> out;
+        fill_sequence(out, values.size(), [&](value_type* data) {
+            segmented_scan_into<Op>(element_reader(values), data, values.size(), flag_starts(flags), grain);
+        });
+        return out;
+    }
+
+    template <typename Op, typename Expr, typename Keys>
+    auto inclusive_scan_by_key(const Expr& values, const Keys& keys, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        using value_type = expr_value_type<Expr>;
+        sequence_type_of<Expr> out;
+        fill_sequence(out, values.size(), [&](value_type* data) {
+            segmented_scan_into<Op>(element_reader(values), data, values.size(), key_starts(keys), grain);
+        });
+        return out;
+    }
+
+    template <typename Expr, typename Flags>
+    auto segmented_cumulative_sum(const Expr& values, const Flags& flags) -> sequence_type_of<Expr> {
+        return segmented_inclusive_scan<Add_Op<expr_value_type<Expr>>>(values, flags);
+    }
+}
@@ -0,0 +1,354 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Parallel.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                 Selection & Partial Sorting
+    //
+    //          argmin / argmax      the index of the first smallest, (largest), element
+    //          top_k / bottom_k     the k largest, (smallest), elements, best first
+    //          nth_value            the element of rank n, as if the input were sorted
+    //          median / quantile    built on nth_value
+    //
+    //          Every function accepts a SeqContainer or an expression template, which
+    //          is read once per pass without being materialized.  Elements must be
+    //          ordered by operator<, so a NaN gives unspecified results.
+    //
+    //          top_k keeps a buffer of up to 2k candidates per block, together with
+    //          the k-th best value found so far.  Most elements fail the comparison
+    //          against that threshold, so the scan is a tight, predictable loop, and
+    //          the buffer is cut back to the best k with nth_element only when full.
+    //
+    //          nth_value sorts a small random sample to pick two splitters which
+    //          bracket rank n, counts the elements on each side in parallel, and
+    //          gathers only the elements between them, which are then selected
+    //          with nth_element.  Should the rank fall outside the bracket, the side
+    //          holding it is gathered instead and the search repeats on it.
+    //
+    /********************************************************************************************/
+
+    constexpr std::size_t selection_sample = 1024;
+
+    /*****************************************************************************************/
+    //
+    //                                   Argmin & Argmax
+    //
+    /*****************************************************************************************/
+
+    /*
+        Returns the index of the first element for which no other element is
+        better by 'better', or the size of an empty expression.
+    */
+    template <typename Expr, typename Better>
+    std::size_t arg_best(const Expr& expr, Better better, std::size_t grain) {
+        using value_type = expr_value_type<Expr>;
+        const auto count = expr.size();
+        if (count == 0) {
+            return 0;
+        }
+        const auto in     = element_reader(expr);
+        const auto blocks = block_count(count, grain);
+        std::vector<std::pair<value_type, std::size_t>> bests(blocks);
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [first, last] = block_range(count, blocks, block);
+            value_type  best  = in[first];
+            std::size_t index = first;
+            for (std::size_t i = first + 1; i < last; ++i) {
+                const value_type value = in[i];
+                if (better(value, best)) {
+                    best  = value;
+                    index = i;
+                }
+            }
+            bests[block] = { best, index };
+        });
+        auto result = bests[0];
+        for (std::size_t block = 1; block < blocks; ++block) {
+            if (better(bests[block].first, result.first)) {
+                result = bests[block];
+            }
+        }
+        return result.second;
+    }
+
+    template <typename Expr>
+    std::size_t argmin(const Expr& expr, std::size_t grain = default_grain) {
+        return arg_best(expr, std::less<expr_value_type<Expr>>(), grain);
+    }
+
+    template <typename Expr>
+    std::size_t argmax(const Expr& expr, std::size_t grain = default_grain) {
+        return arg_best(expr, std::greater<expr_value_type<Expr>>(), grain);
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                        Top K
+    //
+    /*****************************************************************************************/
+
+    /*
+        Cuts 'candidates' back to its best 'k' elements by 'better', and returns
+        the worst of them as the new threshold.
+    */
+    template <typename T, typename Better>
+    T prune_candidates(std::vector<T>& candidates, std::size_t k, Better better) {
+        std::nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.end(), better);
+        candidates.resize(k);
+        return candidates[k - 1];
+    }
+
+    /*
+        Appends the best 'k' elements of [first, last) of 'in' to 'candidates'.
+    */
+    template <typename T, typename Reader, typename Better>
+    void top_k_block(const Reader& in, std::size_t first, std::size_t last, std::size_t k, Better better, std::vector<T>& candidates) {
+        candidates.clear();
+        candidates.reserve(2 * k);
+        std::size_t i = first;
+        for (; i < last && candidates.size() < k; ++i) {
+            candidates.push_back(in[i]);
+        }
+        if (candidates.size() < k) {
+            return;
+        }
+        T threshold = prune_candidates(candidates, k, better);
+        for (; i < last; ++i) {
+            const T value = in[i];
+            if (better(value, threshold)) {
+                candidates.push_back(value);
+                if (candidates.size() == 2 * k) {
+                    threshold = prune_candidates(candidates, k, better);
+                }
+            }
+        }
+        if (candidates.size() > k) {
+            prune_candidates(candidates, k, better);
+        }
+    }
+
+    template <typename Expr, typename Better>
+    auto best_k(const Expr& expr, std::size_t k, Better better, std::size_t grain) -> sequence_type_of<Expr> {
+        using value_type = expr_value_type<Expr>;
+        const auto count = expr.size();
+        k = std::min(k, count);
+        std::vector<value_type> result;
+        if (k > 0) {
+            const auto in     = element_reader(expr);
+            const auto blocks = block_count(count, std::max(grain, k));
+            std::vector<std::vector<value_type>> candidates(blocks);
+            parallel_blocks(blocks, [&](std::size_t block) {
+                const auto [first, last] = block_range(count, blocks, block);
+                top_k_block(in, first, last, k, better, candidates[block]);
+            });
+            for (auto& block : candidates) {
+                result.insert(result.end(), block.begin(), block.end());
+            }
+            if (result.size() > k) {
+                prune_candidates(result, k, better);
+            }
+            std::sort(result.begin(), result.end(), better);
+        }
+        sequence_type_of<Expr> out;
+        fill_sequence(out, result.size(), [&](value_type* data) {
+            std::move(result.begin(), result.end(), data);
+        });
+        return out;
+    }
+
+    template <typename Expr>
+    auto top_k(const Expr& expr, std::size_t k, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        return best_k(expr, k, std::greater<expr_value_type<Expr>>(), grain);
+    }
+
+    template <typename Expr>
+    auto bottom_k(const Expr& expr, std::size_t k, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        return best_k(expr, k, std::less<expr_value_type<Expr>>(), grain);
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                      Selection
+    //
+    /*****************************************************************************************/
+
+    /*
+        Gathers the elements of 'in' for which keep(value) holds, in parallel.
+    */
+    template <typename T, typename Reader, typename Keep>
+    std::vector<T> gather_if(const Reader& in, std::size_t count, Keep keep, std::size_t grain) {
+        const auto blocks = block_count(count, grain);
+        std::vector<std::vector<T>> parts(blocks);
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [first, last] = block_range(count, blocks, block);
+            for (std::size_t i = first; i < last; ++i) {
+                const T value = in[i];
+                if (keep(value)) {
+                    parts[block].push_back(value);
+                }
+            }
+        });
+        std::vector<T> result;
+        for (auto& part : parts) {
+            result.insert(result.end(), part.begin(), part.end());
+        }
+        return result;
+    }
+
+    /*
+        Returns the element of rank 'n' of the first 'count' elements of 'in',
+        where n < count.
+    */
+    template <typename T, typename Reader>
+    T select_rank(const Reader& in, std::size_t count, std::size_t n, std::size_t grain) {
+        if (count <= 4 * selection_sample || block_count(count, grain) == 1) {
+            std::vector<T> values(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                values[i] = in[i];
+            }
+            std::nth_element(values.begin(), values.begin() + n, values.end());
+            return values[n];
+        }
+
+        /*
+            A fixed seed keeps the result, and its cost, reproducible.
+        */
+        std::vector<T> sample(selection_sample);
+        std::uint64_t  state = 0x9E3779B97F4A7C15ull ^ count;
+        for (auto& value : sample) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            value  = in[static_cast<std::size_t>(state % count)];
+        }
+        std::sort(sample.begin(), sample.end());
+        const auto position = static_cast<std::size_t>(static_cast<double>(n) / static_cast<double>(count) * selection_sample);
+        const auto margin   = 2 * static_cast<std::size_t>(std::sqrt(static_cast<double>(selection_sample)));
+        const T low  = sample[position > margin ? position - margin : 0];
+        const T high = sample[std::min(position + margin, selection_sample - 1)];
+
+        const auto blocks = block_count(count, grain);
+        std::vector<std::pair<std::size_t, std::size_t>> sides(blocks);
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [first, last] = block_range(count, blocks, block);
+            std::size_t below = 0;
+            std::size_t above = 0;
+            for (std::size_t i = first; i < last; ++i) {
+                const T value = in[i];
+                below += static_cast<std::size_t>(value < low);
+                above += static_cast<std::size_t>(high < value);
+            }
+            sides[block] = { below, above };
+        });
+        std::size_t below = 0;
+        std::size_t above = 0;
+        for (const auto& side : sides) {
+            below += side.first;
+            above += side.second;
+        }
+
+        if (n < below) {
+            const auto part = gather_if<T>(in, count, [&](const T& value) { return value < low; }, grain);
+            return select_rank<T>(part.data(), part.size(), n, grain);
+        }
+        if (n >= count - above) {
+            const auto part = gather_if<T>(in, count, [&](const T& value) { return high < value; }, grain);
+            return select_rank<T>(part.data(), part.size(), n - (count - above), grain);
+        }
+        auto middle = gather_if<T>(in, count, [&](const T& value) { return !(value < low) && !(high < value); }, grain);
+        std::nth_element(middle.begin(), middle.begin() + (n - below), middle.end());
+        return middle[n - below];
+    }
+
+    /*
+        Returns the element of rank 'n', (counting from zero), of an expression,
+        throwing std::out_of_range unless it holds more than n elements.
+    */
+    template <typename Expr>
+    auto nth_value(const Expr& expr, std::size_t n, std::size_t grain = default_grain) -> expr_value_type<Expr> {
+        if (n >= expr.size()) {
+            throw std::out_of_range("nth_value: the rank is outside of the expression");
+        }
+        return select_rank<expr_value_type<Expr>>(element_reader(expr), expr.size(), n, grain);
+    }
+
+    /*
+        The median of an even number of floating point elements is the mean of
+        the middle two, and otherwise the lower of them.  An empty expression
+        throws std::invalid_argument.
+    */
+    template <typename Expr>
+    auto median(const Expr& expr, std::size_t grain = default_grain) -> expr_value_type<Expr> {
+        using value_type = expr_value_type<Expr>;
+        const auto count = expr.size();
+        if (count == 0) {
+            throw std::invalid_argument("median: the expression is empty");
+        }
+        const auto lower = nth_value(expr, (count - 1) / 2, grain);
+        if constexpr (std::floating_point<value_type>) {
+            if (count % 2 == 0) {
+                return (lower + nth_value(expr, count / 2, grain)) / value_type{ 2 };
+            }
+        }
+        return lower;
+    }
+
+    /*
+        Returns the q-th quantile, 0 <= q <= 1, interpolating linearly between the
+        two closest ranks.  An empty expression throws std::invalid_argument.
+    */
+    template <typename Expr> requires std::floating_point<expr_value_type<Expr>>
+    auto quantile(const Expr& expr, double q, std::size_t grain = default_grain) -> expr_value_type<Expr> {
+        using value_type = expr_value_type<Expr>;
+        if (expr.size() == 0) {
+            throw std::invalid_argument("quantile: the expression is empty");
+        }
+        const auto position = std::clamp(q, 0.0, 1.0) * static_cast<double>(expr.size() - 1);
+        const auto lower    = static_cast<std::size_t>(position);
+        const auto fraction = static_cast<value_type>(position - static_cast<double>(lower));
+        const auto low      = nth_value(expr, lower, grain);
+        if (fraction == value_type{ 0 }) {
+            return low;
+        }
+        const auto high = nth_value(expr, lower + 1, grain);
+        return low + (high - low) * fraction;
+    }
+}
@@ -36,7 +36,9 @@
 #include <functional>
 #include <limits>
 #include <list>
+#include <ranges>
 #include <type_traits>
+#include <vector>
 
 #include "Expression_Template.h"
 
@@ -60,6 +62,11 @@ namespace Oliver {
     //
     /********************************************************************************************/
 
+    template <typename T>
+    constexpr const T& max_val(const T& a, const T& b) {
+        return a < b ? b : a;
+    }
+
     template <typename Object >
     concept HasReserveMethod = requires(Object) {
         { std::is_member_function_pointer<decltype(&Object::reserve)>::value };
@@ -79,6 +86,7 @@ namespace Oliver {
         constexpr SeqContainer();
         constexpr SeqContainer(value_type value);
         constexpr SeqContainer(std::initializer_list<value_type> list);
+        constexpr explicit SeqContainer(impl_type&& impl);
 
         template <typename LE, typename Op, typename RE>
         constexpr SeqContainer(ExprTemplate<LE, Op, RE>&& expr);
@@ -110,6 +118,12 @@ namespace Oliver {
         auto  rend() const noexcept;
         auto crend() const noexcept;
 
+        constexpr       impl_type& impl() noexcept;
+        constexpr const impl_type& impl() const noexcept;
+
+        constexpr       value_type* data()       requires std::ranges::contiguous_range<IMPL>;
+        constexpr const value_type* data() const requires std::ranges::contiguous_range<const IMPL>;
+
         constexpr std::size_t     size() const;
         constexpr std::size_t max_size() const;
         constexpr std::size_t capacity() const;
@@ -167,29 +181,139 @@ namespace Oliver {
         template <typename RightExpr> SeqContainer& operator >>=(RightExpr&& re);
         template <typename RightExpr> SeqContainer&        apply(RightExpr&& re);
 
-        template <typename RightExpr> auto operator  +(RightExpr&& re) const->ExprTemplate<const SeqContainer&, Add_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
-        template <typename RightExpr> auto operator  -(RightExpr&& re) const->ExprTemplate<const SeqContainer&, Sub_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
-        template <typename RightExpr> auto operator  *(RightExpr&& re) const->ExprTemplate<const SeqContainer&, Mul_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
-        template <typename RightExpr> auto operator  /(RightExpr&& re) const->ExprTemplate<const SeqContainer&, Div_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
-        template <typename RightExpr> auto operator  %(RightExpr&& re) const->ExprTemplate<const SeqContainer&, Mod_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
-        template <typename RightExpr> auto operator  &(RightExpr&& re) const->ExprTemplate<const SeqContainer&, And_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
-        template <typename RightExpr> auto operator  |(RightExpr&& re) const->ExprTemplate<const SeqContainer&, Or_Op<value_type>,                  decltype(std::forward<RightExpr>(re))>;
-        template <typename RightExpr> auto operator  ^(RightExpr&& re) const->ExprTemplate<const SeqContainer&, Xor_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
-        template <typename RightExpr> auto operator <<(RightExpr&& re) const->ExprTemplate<const SeqContainer&, LeftShift_Op<value_type>,           decltype(std::forward<RightExpr>(re))>;
-        template <typename RightExpr> auto operator >>(RightExpr&& re) const->ExprTemplate<const SeqContainer&, RightShift_Op<value_type>,          decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  +(RightExpr&& re) const&->ExprTemplate<const SeqContainer&, Add_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  -(RightExpr&& re) const&->ExprTemplate<const SeqContainer&, Sub_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  *(RightExpr&& re) const&->ExprTemplate<const SeqContainer&, Mul_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  /(RightExpr&& re) const&->ExprTemplate<const SeqContainer&, Div_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  %(RightExpr&& re) const&->ExprTemplate<const SeqContainer&, Mod_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  &(RightExpr&& re) const&->ExprTemplate<const SeqContainer&, And_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  |(RightExpr&& re) const&->ExprTemplate<const SeqContainer&, Or_Op<value_type>,                  decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  ^(RightExpr&& re) const&->ExprTemplate<const SeqContainer&, Xor_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator <<(RightExpr&& re) const&->ExprTemplate<const SeqContainer&, LeftShift_Op<value_type>,           decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator >>(RightExpr&& re) const&->ExprTemplate<const SeqContainer&, RightShift_Op<value_type>,          decltype(std::forward<RightExpr>(re))>;
         template <typename RightExpr> auto       apply(RightExpr&& re) const->ExprTemplate<const SeqContainer&, std::function<VALUE(VALUE)>,        decltype(std::forward<RightExpr>(re))>;
         template <typename RightExpr> auto       apply(RightExpr&& re) const->ExprTemplate<const SeqContainer&, std::function<VALUE(VALUE, VALUE)>, decltype(std::forward<RightExpr>(re))>;
 
+        template <typename RightExpr> auto operator  +(RightExpr&& re) &&     ->ExprTemplate<SeqContainer&&,      Add_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  -(RightExpr&& re) &&     ->ExprTemplate<SeqContainer&&,      Sub_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  *(RightExpr&& re) &&     ->ExprTemplate<SeqContainer&&,      Mul_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  /(RightExpr&& re) &&     ->ExprTemplate<SeqContainer&&,      Div_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  %(RightExpr&& re) &&     ->ExprTemplate<SeqContainer&&,      Mod_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  &(RightExpr&& re) &&     ->ExprTemplate<SeqContainer&&,      And_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  |(RightExpr&& re) &&     ->ExprTemplate<SeqContainer&&,      Or_Op<value_type>,                  decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator  ^(RightExpr&& re) &&     ->ExprTemplate<SeqContainer&&,      Xor_Op<value_type>,                 decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator <<(RightExpr&& re) &&     ->ExprTemplate<SeqContainer&&,      LeftShift_Op<value_type>,           decltype(std::forward<RightExpr>(re))>;
+        template <typename RightExpr> auto operator >>(RightExpr&& re) &&     ->ExprTemplate<SeqContainer&&,      RightShift_Op<value_type>,          decltype(std::forward<RightExpr>(re))>;
+
     protected:
         static const value_type def_value;
         impl_type _sequence;
 
+        constexpr decltype(auto) elements();
+
+        template <typename Expr>
+        constexpr void assign_elements(std::size_t limit, const Expr& expr);
+
+        template <typename Expr>
+        constexpr bool aliased_by(const Expr& expr) const;
+
+        template <typename Expr>
+        static SeqContainer evaluated(const Expr& expr);
+
         constexpr SeqContainer& rotate_left          (std::size_t shift);
         constexpr SeqContainer& rotate_left_and_drop (std::size_t shift);
         constexpr SeqContainer& rotate_right         (std::size_t shift);
         constexpr SeqContainer& rotate_right_and_drop(std::size_t shift);
     };
 
+    /*****************************************************************************************/
+    //
+    //                                      Type Traits
+    //
+    //          'sequence_type_of' is the SeqContainer an expression is materialized
+    //          into: a SeqContainer keeps its own type, and an expression template
+    //          is materialized into the default SeqContainer of its value type.
+    //
+    /*****************************************************************************************/
+
+    template <typename Seq>
+    struct is_seq_container : std::false_type {};
+
+    template <typename VALUE, typename IMPL>
+    struct is_seq_container<SeqContainer<VALUE, IMPL>> : std::true_type {};
+
+    template <typename Expr>
+    using expr_value_type = std::remove_cvref_t<Expr>::value_type;
+
+    template <typename Expr>
+    using sequence_type_of = std::conditional_t<is_seq_container<std::remove_cvref_t<Expr>>::value, std::remove_cvref_t<Expr>, SeqContainer<expr_value_type<Expr>>>;
+
+    /*
+        The customization point of the compound assignments of a contiguous
+        SeqContainer.  apply(data, size, re) may perform data[i] Op= re[i] for
+        every i < size with a dedicated kernel and return true, or return false
+        for the element wise loop.  Blas.h specializes it for axpy and scal, on
+        expressions holding its Scalar.
+    */
+    template <typename Op, typename T, typename Expr>
+    struct CompoundAssign {
+        static bool apply(T*, std::size_t, const Expr&) noexcept {
+            return false;
+        }
+    };
+
+    /*
+        Returns an object whose operator[] reads an element of the expression.
+        A contiguous SeqContainer is read through its raw pointer, skipping
+        the bounds check of SeqContainer::operator[], so that the index must be
+        less than the size of the expression.
+    */
+    template <typename Expr>
+    struct ElementReader {
+        const Expr& expr;
+
+        auto operator [](std::size_t index) const -> expr_value_type<Expr> {
+            return expr[index];
+        }
+    };
+
+    /*
+        Resizes 'out' to 'count' elements and calls func(data) with a pointer to
+        'count' contiguous elements.  A SeqContainer whose IMPL is not contiguous
+        is written through a temporary buffer which is then copied into it.
+    */
+    template <typename Seq, typename Func>
+    void fill_sequence(Seq& out, std::size_t count, Func&& func) {
+        using value_type = typename Seq::value_type;
+        out.resize(count);
+        if constexpr (std::ranges::contiguous_range<typename Seq::impl_type>) {
+            func(out.data());
+        }
+        else {
+            std::vector<value_type> buffer(count);
+            func(buffer.data());
+            auto& impl = out.impl();
+            for (std::size_t i = 0; i < count; ++i) {
+                impl[i] = std::move(buffer[i]);
+            }
+        }
+    }
+
+    template <typename Expr>
+    auto element_reader(const Expr& expr) {
+        if constexpr (is_seq_container<Expr>::value) {
+            if constexpr (std::ranges::contiguous_range<const typename Expr::impl_type>) {
+                return expr.data();
+            }
+            else {
+                return ElementReader<Expr>{ expr };
+            }
+        }
+        else {
+            return ElementReader<Expr>{ expr };
+        }
+    }
+
     /*****************************************************************************************/
     //
     //                         Default Initialization & TypeDefines
@@ -235,13 +359,21 @@ namespace Oliver {
         std::cout << "value = " << std::is_same<decltype(&IMPL::size), void>::value << std::endl;
     }
 
+    template<typename VALUE, typename IMPL>
+    inline constexpr SeqContainer<VALUE, IMPL>::SeqContainer(impl_type&& impl) : _sequence(std::move(impl)) {
+    }
+
     template<typename VALUE, typename IMPL>
     template<typename LE, typename Op, typename RE>
-    inline constexpr SeqContainer<VALUE, IMPL>::SeqContainer(ExprTemplate<LE, Op, RE>&& expr) : _sequence(expr.size(), value_type{}) {
-        const auto limit = _sequence.size();
-        for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] = expr[i];
+    inline constexpr SeqContainer<VALUE, IMPL>::SeqContainer(ExprTemplate<LE, Op, RE>&& expr) : _sequence() {
+        const auto limit = expr.size();
+        if (auto leaf = expr.template rvalue_leaf<SeqContainer>(limit)) {
+            leaf->assign_elements(limit, expr);
+            _sequence = std::move(leaf->_sequence);
+            return;
         }
+        _sequence = impl_type(limit, value_type{});
+        assign_elements(limit, expr);
     }
 
     template<typename VALUE, typename IMPL>
@@ -332,6 +464,35 @@ namespace Oliver {
         return _sequence.crend();
     }
 
+    /*****************************************************************************************/
+    //
+    //                                    IMPL Access
+    //
+    //          Gives access to the underlying sequence, for the methods which are
+    //          specific to an IMPL, such as the slice of a PersistentSequence.
+    //
+    /*****************************************************************************************/
+
+    template<typename VALUE, typename IMPL>
+    inline constexpr SeqContainer<VALUE, IMPL>::impl_type& SeqContainer<VALUE, IMPL>::impl() noexcept {
+        return _sequence;
+    }
+
+    template<typename VALUE, typename IMPL>
+    inline constexpr const SeqContainer<VALUE, IMPL>::impl_type& SeqContainer<VALUE, IMPL>::impl() const noexcept {
+        return _sequence;
+    }
+
+    template<typename VALUE, typename IMPL>
+    inline constexpr SeqContainer<VALUE, IMPL>::value_type* SeqContainer<VALUE, IMPL>::data() requires std::ranges::contiguous_range<IMPL> {
+        return std::ranges::data(_sequence);
+    }
+
+    template<typename VALUE, typename IMPL>
+    inline constexpr const SeqContainer<VALUE, IMPL>::value_type* SeqContainer<VALUE, IMPL>::data() const requires std::ranges::contiguous_range<const IMPL> {
+        return std::ranges::data(_sequence);
+    }
+
     /*****************************************************************************************/
     //
     //                                 Size & Capacity Methods
@@ -438,8 +599,9 @@ namespace Oliver {
     template<typename VALUE, typename IMPL>
     inline constexpr SeqContainer<VALUE, IMPL>& SeqContainer<VALUE, IMPL>::apply(SeqContainer<VALUE, IMPL>::value_type func(SeqContainer<VALUE, IMPL>::value_type)) {
         const auto limit = _sequence.size(); 
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] = func(_sequence[i]);
+            out[i] = func(out[i]);
         }
         return *this;
     }
@@ -447,8 +609,9 @@ namespace Oliver {
     template<typename VALUE, typename IMPL>
     inline constexpr SeqContainer<VALUE, IMPL>& SeqContainer<VALUE, IMPL>::apply(SeqContainer<VALUE, IMPL>::value_type func(const SeqContainer<VALUE, IMPL>::value_type&)) {
         const auto limit = _sequence.size();
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] = func(_sequence[i]);
+            out[i] = func(out[i]);
         }
         return *this;
     }
@@ -459,8 +622,9 @@ namespace Oliver {
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] = func(_sequence[i], b._sequence[i]);
+            out[i] = func(out[i], b._sequence[i]);
         }
         return *this;
     }
@@ -471,8 +635,9 @@ namespace Oliver {
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] = func(_sequence[i], b._sequence[i]);
+            out[i] = func(out[i], b._sequence[i]);
         }
         return *this;
     }
@@ -519,8 +684,9 @@ namespace Oliver {
     inline constexpr SeqContainer<VALUE, IMPL> SeqContainer<VALUE, IMPL>::operator+() {
         SeqContainer<VALUE, IMPL> a = *this;
         const auto limit = a._sequence.size(); 
+        auto&& out = a.elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            a._sequence[i] = +a._sequence[i];
+            out[i] = +out[i];
         }
         return a;
     }
@@ -529,8 +695,9 @@ namespace Oliver {
     inline constexpr SeqContainer<VALUE, IMPL> SeqContainer<VALUE, IMPL>::operator-() {
         SeqContainer<VALUE, IMPL> a = *this;
         const auto limit = a._sequence.size(); 
+        auto&& out = a.elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            a._sequence[i] = -a._sequence[i];
+            out[i] = -out[i];
         }
         return a;
     }
@@ -538,8 +705,9 @@ namespace Oliver {
     template<typename VALUE, typename IMPL>
     inline constexpr SeqContainer<VALUE, IMPL> SeqContainer<VALUE, IMPL>::operator~() {
         const auto limit = _sequence.size(); 
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] = ~_sequence[i];
+            out[i] = ~out[i];
         }
         return *this;
     }
@@ -556,8 +724,9 @@ namespace Oliver {
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] += b[i];
+            out[i] += b[i];
         }
         return *this;
     }
@@ -568,8 +737,9 @@ namespace Oliver {
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] -= b[i];
+            out[i] -= b[i];
         }
         return *this;
     }
@@ -580,8 +750,9 @@ namespace Oliver {
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] *= b[i];
+            out[i] *= b[i];
         }
         return *this;
     }
@@ -592,8 +763,9 @@ namespace Oliver {
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] /= b[i];
+            out[i] /= b[i];
         }
         return *this;
     }
@@ -604,8 +776,9 @@ namespace Oliver {
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] %= b[i];
+            out[i] %= b[i];
         }
         return *this;
     }
@@ -616,8 +789,9 @@ namespace Oliver {
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] &= b[i];
+            out[i] &= b[i];
         }
         return *this;
     }
@@ -628,8 +802,9 @@ namespace Oliver {
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] |= b[i];
+            out[i] |= b[i];
         }
         return *this;
     }
@@ -640,8 +815,9 @@ namespace Oliver {
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] ^= b[i];
+            out[i] ^= b[i];
         }
         return *this;
     }
@@ -652,8 +828,9 @@ namespace Oliver {
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] <<= b[i];
+            out[i] <<= b[i];
         }
         return *this;
     }
@@ -664,8 +841,9 @@ namespace Oliver {
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] >>= b[i];
+            out[i] >>= b[i];
         }
         return *this;
     }
@@ -679,25 +857,47 @@ namespace Oliver {
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
     inline SeqContainer<VALUE, IMPL>& SeqContainer<VALUE, IMPL>::operator=(RightExpr&& re) {
+        if (aliased_by(re)) {
+            auto fresh = evaluated(re);
+            return *this = fresh;
+        }
+        if constexpr (requires { re.template rvalue_leaf<SeqContainer>(std::size_t{}); }) {
+            if (_sequence.size() == re.size()) {
+                auto leaf = re.template rvalue_leaf<SeqContainer>(_sequence.size());
+                if (leaf != nullptr && leaf != this) {
+                    leaf->assign_elements(leaf->_sequence.size(), re);
+                    _sequence = std::move(leaf->_sequence);
+                    return *this;
+                }
+            }
+        }
         const auto limit = max_val(_sequence.size(), re.size());
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
-        for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] = re[i];
-        }
+        assign_elements(limit, re);
         return *this;
     }
 
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
     inline SeqContainer<VALUE, IMPL>& SeqContainer<VALUE, IMPL>::operator+=(RightExpr&& re) {
+        if (aliased_by(re)) {
+            auto fresh = evaluated(re);
+            return *this += fresh;
+        }
+        if constexpr (std::ranges::contiguous_range<IMPL>) {
+            if (CompoundAssign<Add_Op<value_type>, value_type, std::remove_cvref_t<RightExpr>>::apply(data(), _sequence.size(), re)) {
+                return *this;
+            }
+        }
         const auto limit = max_val(_sequence.size(), re.size());
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] += re[i];
+            out[i] += re[i];
         }
         return *this;
     }
@@ -705,12 +905,22 @@ namespace Oliver {
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
     inline SeqContainer<VALUE, IMPL>& SeqContainer<VALUE, IMPL>::operator-=(RightExpr&& re) {
+        if (aliased_by(re)) {
+            auto fresh = evaluated(re);
+            return *this -= fresh;
+        }
+        if constexpr (std::ranges::contiguous_range<IMPL>) {
+            if (CompoundAssign<Sub_Op<value_type>, value_type, std::remove_cvref_t<RightExpr>>::apply(data(), _sequence.size(), re)) {
+                return *this;
+            }
+        }
         const auto limit = max_val(_sequence.size(), re.size());
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] -= re[i];
+            out[i] -= re[i];
         }
         return *this;
     }
@@ -718,12 +928,22 @@ namespace Oliver {
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
     inline SeqContainer<VALUE, IMPL>& SeqContainer<VALUE, IMPL>::operator*=(RightExpr&& re) {
+        if (aliased_by(re)) {
+            auto fresh = evaluated(re);
+            return *this *= fresh;
+        }
+        if constexpr (std::ranges::contiguous_range<IMPL>) {
+            if (CompoundAssign<Mul_Op<value_type>, value_type, std::remove_cvref_t<RightExpr>>::apply(data(), _sequence.size(), re)) {
+                return *this;
+            }
+        }
         const auto limit = max_val(_sequence.size(), re.size());
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] *= re[i];
+            out[i] *= re[i];
         }
         return *this;
     }
@@ -731,12 +951,17 @@ namespace Oliver {
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
     inline SeqContainer<VALUE, IMPL>& SeqContainer<VALUE, IMPL>::operator/=(RightExpr&& re) {
+        if (aliased_by(re)) {
+            auto fresh = evaluated(re);
+            return *this /= fresh;
+        }
         const auto limit = max_val(_sequence.size(), re.size());
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] /= re[i];
+            out[i] /= re[i];
         }
         return *this;
     }
@@ -744,12 +969,17 @@ namespace Oliver {
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
     inline SeqContainer<VALUE, IMPL>& SeqContainer<VALUE, IMPL>::operator%=(RightExpr&& re) {
+        if (aliased_by(re)) {
+            auto fresh = evaluated(re);
+            return *this %= fresh;
+        }
         const auto limit = max_val(_sequence.size(), re.size());
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] %= re[i];
+            out[i] %= re[i];
         }
         return *this;
     }
@@ -757,12 +987,17 @@ namespace Oliver {
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
     inline SeqContainer<VALUE, IMPL>& SeqContainer<VALUE, IMPL>::operator&=(RightExpr&& re) {
+        if (aliased_by(re)) {
+            auto fresh = evaluated(re);
+            return *this &= fresh;
+        }
         const auto limit = max_val(_sequence.size(), re.size());
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] &= re[i];
+            out[i] &= re[i];
         }
         return *this;
     }
@@ -770,12 +1005,17 @@ namespace Oliver {
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
     inline SeqContainer<VALUE, IMPL>& SeqContainer<VALUE, IMPL>::operator|=(RightExpr&& re) {
+        if (aliased_by(re)) {
+            auto fresh = evaluated(re);
+            return *this |= fresh;
+        }
         const auto limit = max_val(_sequence.size(), re.size());
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] |= re[i];
+            out[i] |= re[i];
         }
         return *this;
     }
@@ -783,12 +1023,17 @@ namespace Oliver {
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
     inline SeqContainer<VALUE, IMPL>& SeqContainer<VALUE, IMPL>::operator^=(RightExpr&& re) {
+        if (aliased_by(re)) {
+            auto fresh = evaluated(re);
+            return *this ^= fresh;
+        }
         const auto limit = max_val(_sequence.size(), re.size());
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] ^= re[i];
+            out[i] ^= re[i];
         }
         return *this;
     }
@@ -796,12 +1041,17 @@ namespace Oliver {
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
     inline SeqContainer<VALUE, IMPL>& SeqContainer<VALUE, IMPL>::operator<<=(RightExpr&& re) {
+        if (aliased_by(re)) {
+            auto fresh = evaluated(re);
+            return *this <<= fresh;
+        }
         const auto limit = max_val(_sequence.size(), re.size());
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] <<= re[i];
+            out[i] <<= re[i];
         }
         return *this;
     }
@@ -809,12 +1059,17 @@ namespace Oliver {
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
     inline SeqContainer<VALUE, IMPL>& SeqContainer<VALUE, IMPL>::operator>>=(RightExpr&& re) {
+        if (aliased_by(re)) {
+            auto fresh = evaluated(re);
+            return *this >>= fresh;
+        }
         const auto limit = max_val(_sequence.size(), re.size());
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] >>= re[i];
+            out[i] >>= re[i];
         }
         return *this;
     }
@@ -826,8 +1081,9 @@ namespace Oliver {
         if (_sequence.size() < limit) {
             resize(limit + 1);
         }
+        auto&& out = elements();
         for (std::size_t i = 0; i < limit; ++i) {
-            _sequence[i] = std::function<VALUE(VALUE, VALUE)>(_sequence[i], re[i]);
+            out[i] = std::function<VALUE(VALUE, VALUE)>(out[i], re[i]);
         }
         return *this;
     }
@@ -840,61 +1096,61 @@ namespace Oliver {
 
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
-    inline auto SeqContainer<VALUE, IMPL>::operator+(RightExpr&& re) const -> ExprTemplate<const SeqContainer&, Add_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+    inline auto SeqContainer<VALUE, IMPL>::operator+(RightExpr&& re) const& -> ExprTemplate<const SeqContainer&, Add_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
         return ExprTemplate<const SeqContainer&, Add_Op<value_type>, decltype(std::forward<RightExpr>(re))>(*this, std::forward<RightExpr>(re));
     }
 
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
-    inline auto SeqContainer<VALUE, IMPL>::operator-(RightExpr&& re) const -> ExprTemplate<const SeqContainer&, Sub_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+    inline auto SeqContainer<VALUE, IMPL>::operator-(RightExpr&& re) const& -> ExprTemplate<const SeqContainer&, Sub_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
         return ExprTemplate<const SeqContainer&, Sub_Op<value_type>, decltype(std::forward<RightExpr>(re))>(*this, std::forward<RightExpr>(re));
     }
 
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
-    inline auto SeqContainer<VALUE, IMPL>::operator*(RightExpr&& re) const -> ExprTemplate<const SeqContainer&, Mul_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+    inline auto SeqContainer<VALUE, IMPL>::operator*(RightExpr&& re) const& -> ExprTemplate<const SeqContainer&, Mul_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
         return ExprTemplate<const SeqContainer&, Mul_Op<value_type>, decltype(std::forward<RightExpr>(re))>(*this, std::forward<RightExpr>(re));
     }
 
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
-    inline auto SeqContainer<VALUE, IMPL>::operator/(RightExpr&& re) const -> ExprTemplate<const SeqContainer&, Div_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+    inline auto SeqContainer<VALUE, IMPL>::operator/(RightExpr&& re) const& -> ExprTemplate<const SeqContainer&, Div_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
         return ExprTemplate<const SeqContainer&, Div_Op<value_type>, decltype(std::forward<RightExpr>(re))>(*this, std::forward<RightExpr>(re));
     }
 
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
-    inline auto SeqContainer<VALUE, IMPL>::operator%(RightExpr&& re) const -> ExprTemplate<const SeqContainer&, Mod_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+    inline auto SeqContainer<VALUE, IMPL>::operator%(RightExpr&& re) const& -> ExprTemplate<const SeqContainer&, Mod_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
         return ExprTemplate<const SeqContainer&, Mod_Op<value_type>, decltype(std::forward<RightExpr>(re))>(*this, std::forward<RightExpr>(re));
     }
 
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
-    inline auto SeqContainer<VALUE, IMPL>::operator&(RightExpr&& re) const -> ExprTemplate<const SeqContainer&, And_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+    inline auto SeqContainer<VALUE, IMPL>::operator&(RightExpr&& re) const& -> ExprTemplate<const SeqContainer&, And_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
         return ExprTemplate<const SeqContainer&, And_Op<value_type>, decltype(std::forward<RightExpr>(re))>(*this, std::forward<RightExpr>(re));
     }
 
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
-    inline auto SeqContainer<VALUE, IMPL>::operator|(RightExpr&& re) const -> ExprTemplate<const SeqContainer&, Or_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+    inline auto SeqContainer<VALUE, IMPL>::operator|(RightExpr&& re) const& -> ExprTemplate<const SeqContainer&, Or_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
         return ExprTemplate<const SeqContainer&, Or_Op<value_type>, decltype(std::forward<RightExpr>(re))>(*this, std::forward<RightExpr>(re));
     }
 
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
-    inline auto SeqContainer<VALUE, IMPL>::operator^(RightExpr&& re) const -> ExprTemplate<const SeqContainer&, Xor_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+    inline auto SeqContainer<VALUE, IMPL>::operator^(RightExpr&& re) const& -> ExprTemplate<const SeqContainer&, Xor_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
         return ExprTemplate<const SeqContainer&, Xor_Op<value_type>, decltype(std::forward<RightExpr>(re))>(*this, std::forward<RightExpr>(re));
     }
 
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
-    inline auto SeqContainer<VALUE, IMPL>::operator<<(RightExpr&& re) const -> ExprTemplate<const SeqContainer&, LeftShift_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+    inline auto SeqContainer<VALUE, IMPL>::operator<<(RightExpr&& re) const& -> ExprTemplate<const SeqContainer&, LeftShift_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
         return ExprTemplate<const SeqContainer&, LeftShift_Op<value_type>, decltype(std::forward<RightExpr>(re))>(*this, std::forward<RightExpr>(re));
     }
 
     template<typename VALUE, typename IMPL>
     template<typename RightExpr>
-    inline auto SeqContainer<VALUE, IMPL>::operator>>(RightExpr&& re) const -> ExprTemplate<const SeqContainer&, RightShift_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+    inline auto SeqContainer<VALUE, IMPL>::operator>>(RightExpr&& re) const& -> ExprTemplate<const SeqContainer&, RightShift_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
         return ExprTemplate<const SeqContainer&, RightShift_Op<value_type>, decltype(std::forward<RightExpr>(re))>(*this, std::forward<RightExpr>(re));
     }
 
@@ -904,12 +1160,148 @@ namespace Oliver {
         return ExprTemplate<const SeqContainer&, std::function<VALUE(VALUE, VALUE)>, decltype(std::forward<RightExpr>(re))>(*this, std::forward<RightExpr>(re));
     }
 
+    /*****************************************************************************************/
+    //
+    //                             Rvalue Binary Expression Templates
+    //
+    //          A temporary SeqContainer on the left of a binary operator is held by
+    //          rvalue reference.  This allows the constructor and the assignment
+    //          operator to recycle its buffer as the destination of the expression.
+    //
+    /*****************************************************************************************/
+
+    template<typename VALUE, typename IMPL>
+    template<typename RightExpr>
+    inline auto SeqContainer<VALUE, IMPL>::operator+(RightExpr&& re) && -> ExprTemplate<SeqContainer&&, Add_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+        return ExprTemplate<SeqContainer&&, Add_Op<value_type>, decltype(std::forward<RightExpr>(re))>(std::move(*this), std::forward<RightExpr>(re));
+    }
+
+    template<typename VALUE, typename IMPL>
+    template<typename RightExpr>
+    inline auto SeqContainer<VALUE, IMPL>::operator-(RightExpr&& re) && -> ExprTemplate<SeqContainer&&, Sub_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+        return ExprTemplate<SeqContainer&&, Sub_Op<value_type>, decltype(std::forward<RightExpr>(re))>(std::move(*this), std::forward<RightExpr>(re));
+    }
+
+    template<typename VALUE, typename IMPL>
+    template<typename RightExpr>
+    inline auto SeqContainer<VALUE, IMPL>::operator*(RightExpr&& re) && -> ExprTemplate<SeqContainer&&, Mul_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+        return ExprTemplate<SeqContainer&&, Mul_Op<value_type>, decltype(std::forward<RightExpr>(re))>(std::move(*this), std::forward<RightExpr>(re));
+    }
+
+    template<typename VALUE, typename IMPL>
+    template<typename RightExpr>
+    inline auto SeqContainer<VALUE, IMPL>::operator/(RightExpr&& re) && -> ExprTemplate<SeqContainer&&, Div_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+        return ExprTemplate<SeqContainer&&, Div_Op<value_type>, decltype(std::forward<RightExpr>(re))>(std::move(*this), std::forward<RightExpr>(re));
+    }
+
+    template<typename VALUE, typename IMPL>
+    template<typename RightExpr>
+    inline auto SeqContainer<VALUE, IMPL>::operator%(RightExpr&& re) && -> ExprTemplate<SeqContainer&&, Mod_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+        return ExprTemplate<SeqContainer&&, Mod_Op<value_type>, decltype(std::forward<RightExpr>(re))>(std::move(*this), std::forward<RightExpr>(re));
+    }
+
+    template<typename VALUE, typename IMPL>
+    template<typename RightExpr>
+    inline auto SeqContainer<VALUE, IMPL>::operator&(RightExpr&& re) && -> ExprTemplate<SeqContainer&&, And_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+        return ExprTemplate<SeqContainer&&, And_Op<value_type>, decltype(std::forward<RightExpr>(re))>(std::move(*this), std::forward<RightExpr>(re));
+    }
+
+    template<typename VALUE, typename IMPL>
+    template<typename RightExpr>
+    inline auto SeqContainer<VALUE, IMPL>::operator|(RightExpr&& re) && -> ExprTemplate<SeqContainer&&, Or_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+        return ExprTemplate<SeqContainer&&, Or_Op<value_type>, decltype(std::forward<RightExpr>(re))>(std::move(*this), std::forward<RightExpr>(re));
+    }
+
+    template<typename VALUE, typename IMPL>
+    template<typename RightExpr>
+    inline auto SeqContainer<VALUE, IMPL>::operator^(RightExpr&& re) && -> ExprTemplate<SeqContainer&&, Xor_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+        return ExprTemplate<SeqContainer&&, Xor_Op<value_type>, decltype(std::forward<RightExpr>(re))>(std::move(*this), std::forward<RightExpr>(re));
+    }
+
+    template<typename VALUE, typename IMPL>
+    template<typename RightExpr>
+    inline auto SeqContainer<VALUE, IMPL>::operator<<(RightExpr&& re) && -> ExprTemplate<SeqContainer&&, LeftShift_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+        return ExprTemplate<SeqContainer&&, LeftShift_Op<value_type>, decltype(std::forward<RightExpr>(re))>(std::move(*this), std::forward<RightExpr>(re));
+    }
+
+    template<typename VALUE, typename IMPL>
+    template<typename RightExpr>
+    inline auto SeqContainer<VALUE, IMPL>::operator>>(RightExpr&& re) && -> ExprTemplate<SeqContainer&&, RightShift_Op<value_type>, decltype(std::forward<RightExpr>(re))> {
+        return ExprTemplate<SeqContainer&&, RightShift_Op<value_type>, decltype(std::forward<RightExpr>(re))>(std::move(*this), std::forward<RightExpr>(re));
+    }
+
     /*****************************************************************************************/
     //
     //                                     Private Methods
     //
     /*****************************************************************************************/
 
+    /*
+        The elements for an assignment loop to write through: the data pointer of
+        a contiguous IMPL, and otherwise the IMPL itself.  Taking the pointer once
+        means an IMPL which does work on each mutable access, such as unsharing a
+        SharedSequence, does it once per assignment rather than once per element.
+    */
+    template<typename VALUE, typename IMPL>
+    inline constexpr decltype(auto) SeqContainer<VALUE, IMPL>::elements() {
+        if constexpr (std::ranges::contiguous_range<IMPL>) {
+            return _sequence.data();
+        }
+        else {
+            return (_sequence);
+        }
+    }
+
+    /*
+        Writes expr[i] to the first 'limit' elements.  An IMPL which stores its
+        elements in contiguous chunks, such as a PersistentSequence, exposes them
+        through for_each_chunk(func), and is written one chunk at a time so that
+        the inner loop indexes a plain pointer instead of looking each element up.
+    */
+    template<typename VALUE, typename IMPL>
+    template<typename Expr>
+    inline constexpr void SeqContainer<VALUE, IMPL>::assign_elements(std::size_t limit, const Expr& expr) {
+        if constexpr (requires (IMPL& impl) { impl.for_each_chunk([](value_type*, std::size_t, std::size_t) {}); }) {
+            _sequence.for_each_chunk([&](value_type* data, std::size_t count, std::size_t index) {
+                const auto last = std::min(index + count, limit);
+                for (std::size_t i = index; i < last; ++i) {
+                    data[i - index] = expr[i];
+                }
+            });
+        }
+        else {
+            auto&& out = elements();
+            for (std::size_t i = 0; i < limit; ++i) {
+                out[i] = expr[i];
+            }
+        }
+    }
+
+    /*
+        Whether 'expr' is not element wise and reads this sequence, in which case
+        writing it in place would change elements it has yet to read, (as in
+        x = A * x), and it is evaluated into a fresh buffer first.
+    */
+    template<typename VALUE, typename IMPL>
+    template<typename Expr>
+    inline constexpr bool SeqContainer<VALUE, IMPL>::aliased_by(const Expr& expr) const {
+        if constexpr (is_element_wise<Expr>::value) {
+            return false;
+        }
+        else {
+            return expr_refers_to(expr, this);
+        }
+    }
+
+    template<typename VALUE, typename IMPL>
+    template<typename Expr>
+    inline SeqContainer<VALUE, IMPL> SeqContainer<VALUE, IMPL>::evaluated(const Expr& expr) {
+        SeqContainer result;
+        result.resize(expr.size());
+        result.assign_elements(expr.size(), expr);
+        return result;
+    }
+
     template<typename VALUE, typename IMPL>
     constexpr SeqContainer<VALUE, IMPL>& SeqContainer<VALUE, IMPL>::rotate_left(std::size_t shift) {
         //shift = _sequence.size() - shift;
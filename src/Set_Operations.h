@@ -0,0 +1,352 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "Parallel.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                  Sorted Set Operations
+    //
+    //          merge, set_union, set_intersection and set_difference of two
+    //          sequences sorted in ascending order by operator<.  As with the
+    //          standard algorithms, repeated elements are treated as a multiset:
+    //          an element occurring m times in 'a' and n times in 'b' occurs
+    //          max(m, n), min(m, n) and max(m - n, 0) times in the union,
+    //          intersection and difference respectively.
+    //
+    //          The merged output is split into equal blocks along its merge path:
+    //          the start of every block is found by a binary search along a cross
+    //          diagonal of the (a, b) grid, and the blocks are then merged in
+    //          parallel.  Set operations first move every split to the start of a
+    //          run of equal elements in both inputs, so a run is never shared by
+    //          two blocks, then write each block into a local buffer, and finally
+    //          copy the buffers to their offsets in the output.
+    //
+    //          The intersection loop advances both inputs without branching on
+    //          the comparison, and switches to a galloping search when one input
+    //          is much longer than the other.
+    //
+    /********************************************************************************************/
+
+    constexpr std::size_t gallop_ratio = 32;
+
+    /*
+        Returns the first index in [first, last) of 'in' whose element is not
+        less than 'key'.
+    */
+    template <typename Reader, typename T>
+    std::size_t lower_bound_index(const Reader& in, std::size_t first, std::size_t last, const T& key) {
+        while (first < last) {
+            const auto mid = first + (last - first) / 2;
+            if (in[mid] < key) {
+                first = mid + 1;
+            }
+            else {
+                last = mid;
+            }
+        }
+        return first;
+    }
+
+    /*
+        Returns the number of elements of 'a' and 'b' among the first 'diagonal'
+        elements of their merge, where an element of 'a' precedes an equal
+        element of 'b'.
+    */
+    template <typename ReaderA, typename ReaderB>
+    std::pair<std::size_t, std::size_t> merge_path(const ReaderA& a, std::size_t size_a, const ReaderB& b, std::size_t size_b, std::size_t diagonal) {
+        auto low  = diagonal > size_b ? diagonal - size_b : 0;
+        auto high = std::min(diagonal, size_a);
+        while (low < high) {
+            const auto mid = low + (high - low) / 2;
+            if (!(b[diagonal - mid - 1] < a[mid])) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        return { low, diagonal - low };
+    }
+
+    /*
+        Moves the merge path split at 'diagonal' back to the first occurrence, in
+        both inputs, of the next element of the merge.
+    */
+    template <typename ReaderA, typename ReaderB>
+    std::pair<std::size_t, std::size_t> run_split(const ReaderA& a, std::size_t size_a, const ReaderB& b, std::size_t size_b, std::size_t diagonal) {
+        const auto [i, j] = merge_path(a, size_a, b, size_b, diagonal);
+        if (i == size_a && j == size_b) {
+            return { i, j };
+        }
+        const bool from_a = i < size_a && (j == size_b || !(b[j] < a[i]));
+        const auto key    = from_a ? a[i] : b[j];
+        return { lower_bound_index(a, 0, i, key), lower_bound_index(b, 0, j, key) };
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                    Block Kernels
+    //
+    //          Each kernel processes [ia, ea) of 'a' and [jb, eb) of 'b', writes
+    //          to 'out' and returns the number of elements written.
+    //
+    /*****************************************************************************************/
+
+    template <typename T, typename ReaderA, typename ReaderB>
+    std::size_t merge_block(const ReaderA& a, std::size_t ia, std::size_t ea, const ReaderB& b, std::size_t jb, std::size_t eb, T* out) {
+        std::size_t k = 0;
+        while (ia < ea && jb < eb) {
+            const T x = a[ia];
+            const T y = b[jb];
+            if (y < x) {
+                out[k++] = y;
+                ++jb;
+            }
+            else {
+                out[k++] = x;
+                ++ia;
+            }
+        }
+        for (; ia < ea; ++ia) {
+            out[k++] = a[ia];
+        }
+        for (; jb < eb; ++jb) {
+            out[k++] = b[jb];
+        }
+        return k;
+    }
+
+    template <typename T, typename ReaderA, typename ReaderB>
+    std::size_t union_block(const ReaderA& a, std::size_t ia, std::size_t ea, const ReaderB& b, std::size_t jb, std::size_t eb, T* out) {
+        std::size_t k = 0;
+        while (ia < ea && jb < eb) {
+            const T x = a[ia];
+            const T y = b[jb];
+            if (x < y) {
+                out[k++] = x;
+                ++ia;
+            }
+            else if (y < x) {
+                out[k++] = y;
+                ++jb;
+            }
+            else {
+                out[k++] = x;
+                ++ia;
+                ++jb;
+            }
+        }
+        for (; ia < ea; ++ia) {
+            out[k++] = a[ia];
+        }
+        for (; jb < eb; ++jb) {
+            out[k++] = b[jb];
+        }
+        return k;
+    }
+
+    /*
+        Intersects the shorter range with a galloping search of the longer one.
+    */
+    template <typename T, typename ReaderA, typename ReaderB>
+    std::size_t gallop_intersection_block(const ReaderA& a, std::size_t ia, std::size_t ea, const ReaderB& b, std::size_t jb, std::size_t eb, T* out) {
+        std::size_t k = 0;
+        while (ia < ea && jb < eb) {
+            const T x = a[ia];
+            std::size_t step = 1;
+            auto low = jb;
+            while (low + step < eb && b[low + step] < x) {
+                low  += step;
+                step *= 2;
+            }
+            jb = lower_bound_index(b, low, std::min(low + step + 1, eb), x);
+            if (jb < eb && !(x < b[jb])) {
+                out[k++] = x;
+                ++jb;
+            }
+            ++ia;
+        }
+        return k;
+    }
+
+    template <typename T, typename ReaderA, typename ReaderB>
+    std::size_t intersection_block(const ReaderA& a, std::size_t ia, std::size_t ea, const ReaderB& b, std::size_t jb, std::size_t eb, T* out) {
+        const auto length_a = ea - ia;
+        const auto length_b = eb - jb;
+        if (length_a * gallop_ratio < length_b) {
+            return gallop_intersection_block<T>(a, ia, ea, b, jb, eb, out);
+        }
+        if (length_b * gallop_ratio < length_a) {
+            return gallop_intersection_block<T>(b, jb, eb, a, ia, ea, out);
+        }
+        std::size_t k = 0;
+        while (ia < ea && jb < eb) {
+            const T x = a[ia];
+            const T y = b[jb];
+            const bool a_less = x < y;
+            const bool b_less = y < x;
+            out[k] = x;
+            k  += static_cast<std::size_t>(!a_less && !b_less);
+            ia += static_cast<std::size_t>(!b_less);
+            jb += static_cast<std::size_t>(!a_less);
+        }
+        return k;
+    }
+
+    template <typename T, typename ReaderA, typename ReaderB>
+    std::size_t difference_block(const ReaderA& a, std::size_t ia, std::size_t ea, const ReaderB& b, std::size_t jb, std::size_t eb, T* out) {
+        std::size_t k = 0;
+        while (ia < ea && jb < eb) {
+            const T x = a[ia];
+            const T y = b[jb];
+            if (x < y) {
+                out[k++] = x;
+                ++ia;
+            }
+            else if (y < x) {
+                ++jb;
+            }
+            else {
+                ++ia;
+                ++jb;
+            }
+        }
+        for (; ia < ea; ++ia) {
+            out[k++] = a[ia];
+        }
+        return k;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                    Parallel Drivers
+    //
+    /*****************************************************************************************/
+
+    /*
+        Splits the merge of 'a' and 'b' into blocks at the start of runs, runs
+        'kernel' on every block into a local buffer of capacity(length_a,
+        length_b) elements, and concatenates the buffers into 'out'.
+    */
+    template <typename Expr, typename ExprB, typename Capacity, typename Kernel>
+    auto set_operation(const Expr& a, const ExprB& b, std::size_t grain, Capacity&& capacity, Kernel&& kernel) -> sequence_type_of<Expr> {
+        using value_type = expr_value_type<Expr>;
+        const auto in_a   = element_reader(a);
+        const auto in_b   = element_reader(b);
+        const auto size_a = a.size();
+        const auto size_b = b.size();
+        const auto blocks = block_count(size_a + size_b, grain);
+
+        std::vector<std::pair<std::size_t, std::size_t>> splits(blocks + 1);
+        splits[blocks] = { size_a, size_b };
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto first = block_range(size_a + size_b, blocks, block).first;
+            splits[block] = block == 0 ? std::pair<std::size_t, std::size_t>{ 0, 0 } : run_split(in_a, size_a, in_b, size_b, first);
+        });
+
+        std::vector<std::vector<value_type>> buffers(blocks);
+        std::vector<std::size_t>             offsets(blocks + 1, 0);
+        parallel_blocks(blocks, [&](std::size_t block) {
+            const auto [ia, jb] = splits[block];
+            const auto [ea, eb] = splits[block + 1];
+            auto& buffer = buffers[block];
+            buffer.resize(capacity(ea - ia, eb - jb));
+            buffer.resize(kernel(in_a, ia, ea, in_b, jb, eb, buffer.data()));
+        });
+        for (std::size_t block = 0; block < blocks; ++block) {
+            offsets[block + 1] = offsets[block] + buffers[block].size();
+        }
+
+        sequence_type_of<Expr> out;
+        fill_sequence(out, offsets[blocks], [&](value_type* data) {
+            parallel_blocks(blocks, [&](std::size_t block) {
+                std::move(buffers[block].begin(), buffers[block].end(), data + offsets[block]);
+            });
+        });
+        return out;
+    }
+
+    /*
+        Merges two sorted sequences.  The merge is stable: an element of 'a'
+        precedes an equal element of 'b'.
+    */
+    template <typename Expr, typename ExprB>
+    auto merge(const Expr& a, const ExprB& b, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        using value_type = expr_value_type<Expr>;
+        const auto in_a   = element_reader(a);
+        const auto in_b   = element_reader(b);
+        const auto size_a = a.size();
+        const auto size_b = b.size();
+        sequence_type_of<Expr> out;
+        fill_sequence(out, size_a + size_b, [&](value_type* data) {
+            parallel_for(size_a + size_b, grain, [&](std::size_t first, std::size_t last, std::size_t) {
+                const auto [ia, jb] = merge_path(in_a, size_a, in_b, size_b, first);
+                const auto [ea, eb] = merge_path(in_a, size_a, in_b, size_b, last);
+                merge_block<value_type>(in_a, ia, ea, in_b, jb, eb, data + first);
+            });
+        });
+        return out;
+    }
+
+    template <typename Expr, typename ExprB>
+    auto set_union(const Expr& a, const ExprB& b, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        using value_type = expr_value_type<Expr>;
+        return set_operation(a, b, grain,
+            [](std::size_t length_a, std::size_t length_b) { return length_a + length_b; },
+            [](const auto& in_a, std::size_t ia, std::size_t ea, const auto& in_b, std::size_t jb, std::size_t eb, value_type* out) {
+                return union_block<value_type>(in_a, ia, ea, in_b, jb, eb, out);
+            });
+    }
+
+    template <typename Expr, typename ExprB>
+    auto set_intersection(const Expr& a, const ExprB& b, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        using value_type = expr_value_type<Expr>;
+        return set_operation(a, b, grain,
+            [](std::size_t length_a, std::size_t length_b) { return std::min(length_a, length_b) + 1; },
+            [](const auto& in_a, std::size_t ia, std::size_t ea, const auto& in_b, std::size_t jb, std::size_t eb, value_type* out) {
+                return intersection_block<value_type>(in_a, ia, ea, in_b, jb, eb, out);
+            });
+    }
+
+    template <typename Expr, typename ExprB>
+    auto set_difference(const Expr& a, const ExprB& b, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        using value_type = expr_value_type<Expr>;
+        return set_operation(a, b, grain,
+            [](std::size_t length_a, std::size_t) { return length_a; },
+            [](const auto& in_a, std::size_t ia, std::size_t ea, const auto& in_b, std::size_t jb, std::size_t eb, value_type* out) {
+                return difference_block<value_type>(in_a, ia, ea, in_b, jb, eb, out);
+            });
+    }
+}
@@ -0,0 +1,324 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                  'SharedSequence' class
+    //
+    //          The SharedSequence is a copy-on-write sequence intended to be used as
+    //          the IMPL of a SeqContainer.  Copies share a single reference counted
+    //          buffer, making them O(1).  The buffer is only detached, (deep copied),
+    //          the first time a shared copy is accessed through a mutable method:
+    //          the non const operator[], begin(), end(), resize(), and so on.
+    //
+    //          The assignments and compound operators of the SeqContainer take the
+    //          data() pointer once before their loop, so they detach once rather
+    //          than checking the use count for every element.  Each use of the non
+    //          const operator[] does check it.
+    //
+    //          A reference, pointer or iterator obtained from a mutable method is
+    //          not detached again by a later copy: after 'b = a', writing through a
+    //          reference taken from 'a' before the copy changes 'b' as well.  Take
+    //          them after the last copy, or not at all while copies are being made.
+    //
+    /********************************************************************************************/
+
+    template<typename VALUE = intmax_t>
+    class SharedSequence {
+
+        using buffer_type = std::vector<VALUE>;
+
+    public:
+        using value_type             = buffer_type::value_type;
+        using iterator               = buffer_type::iterator;
+        using const_iterator         = buffer_type::const_iterator;
+        using reverse_iterator       = buffer_type::reverse_iterator;
+        using const_reverse_iterator = buffer_type::const_reverse_iterator;
+
+        SharedSequence();
+        SharedSequence(std::size_t size, value_type value);
+        SharedSequence(std::initializer_list<value_type> list);
+
+        ~SharedSequence() = default;
+
+        SharedSequence(SharedSequence&& seq)                  noexcept = default;
+        SharedSequence(const SharedSequence& seq)             noexcept = default;
+        SharedSequence& operator =(SharedSequence&& seq)      noexcept = default;
+        SharedSequence& operator =(const SharedSequence& seq) noexcept = default;
+
+        iterator        begin();
+        const_iterator  begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+
+        iterator        end();
+        const_iterator  end() const noexcept;
+        const_iterator cend() const noexcept;
+
+        reverse_iterator        rbegin();
+        const_reverse_iterator  rbegin() const noexcept;
+        const_reverse_iterator crbegin() const noexcept;
+
+        reverse_iterator        rend();
+        const_reverse_iterator  rend() const noexcept;
+        const_reverse_iterator crend() const noexcept;
+
+        std::size_t     size() const noexcept;
+        std::size_t max_size() const noexcept;
+        std::size_t capacity() const noexcept;
+        std::size_t use_count() const noexcept;
+
+        void resize(std::size_t size);
+        void resize(std::size_t size, value_type value);
+        void reserve(std::size_t size);
+
+        void  pop_back();
+        void push_back(value_type value);
+
+        template<typename InputIt>
+        iterator insert(const_iterator at, InputIt first, InputIt last);
+
+              value_type* data();
+        const value_type* data() const noexcept;
+
+        const value_type& operator [](std::size_t index) const;
+              value_type& operator [](std::size_t index);
+
+    private:
+        std::shared_ptr<buffer_type> _buffer;
+
+        static const buffer_type& empty_buffer() noexcept;
+
+        const buffer_type& read() const noexcept;
+              buffer_type& write();
+    };
+
+    template <typename VALUE = intmax_t>
+    using SharedSeqContainer = SeqContainer<VALUE, SharedSequence<VALUE>>;
+
+    /*****************************************************************************************/
+    //
+    //                                       Constructors
+    //
+    /*****************************************************************************************/
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::SharedSequence() : _buffer() {
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::SharedSequence(std::size_t size, value_type value) : _buffer(std::make_shared<buffer_type>(size, value)) {
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::SharedSequence(std::initializer_list<value_type> list) : _buffer(std::make_shared<buffer_type>(list)) {
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                        Iterators
+    //
+    /*****************************************************************************************/
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::iterator SharedSequence<VALUE>::begin() {
+        return write().begin();
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::const_iterator SharedSequence<VALUE>::begin() const noexcept {
+        return read().begin();
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::const_iterator SharedSequence<VALUE>::cbegin() const noexcept {
+        return read().cbegin();
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::iterator SharedSequence<VALUE>::end() {
+        return write().end();
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::const_iterator SharedSequence<VALUE>::end() const noexcept {
+        return read().end();
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::const_iterator SharedSequence<VALUE>::cend() const noexcept {
+        return read().cend();
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::reverse_iterator SharedSequence<VALUE>::rbegin() {
+        return write().rbegin();
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::const_reverse_iterator SharedSequence<VALUE>::rbegin() const noexcept {
+        return read().rbegin();
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::const_reverse_iterator SharedSequence<VALUE>::crbegin() const noexcept {
+        return read().crbegin();
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::reverse_iterator SharedSequence<VALUE>::rend() {
+        return write().rend();
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::const_reverse_iterator SharedSequence<VALUE>::rend() const noexcept {
+        return read().rend();
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::const_reverse_iterator SharedSequence<VALUE>::crend() const noexcept {
+        return read().crend();
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                 Size & Capacity Methods
+    //
+    /*****************************************************************************************/
+
+    template<typename VALUE>
+    inline std::size_t SharedSequence<VALUE>::size() const noexcept {
+        return read().size();
+    }
+
+    template<typename VALUE>
+    inline std::size_t SharedSequence<VALUE>::max_size() const noexcept {
+        return read().max_size();
+    }
+
+    template<typename VALUE>
+    inline std::size_t SharedSequence<VALUE>::capacity() const noexcept {
+        return read().capacity();
+    }
+
+    template<typename VALUE>
+    inline std::size_t SharedSequence<VALUE>::use_count() const noexcept {
+        return static_cast<std::size_t>(_buffer.use_count());
+    }
+
+    template<typename VALUE>
+    inline void SharedSequence<VALUE>::resize(std::size_t size) {
+        write().resize(size);
+    }
+
+    template<typename VALUE>
+    inline void SharedSequence<VALUE>::resize(std::size_t size, value_type value) {
+        write().resize(size, value);
+    }
+
+    template<typename VALUE>
+    inline void SharedSequence<VALUE>::reserve(std::size_t size) {
+        write().reserve(size);
+    }
+
+    template<typename VALUE>
+    inline void SharedSequence<VALUE>::pop_back() {
+        write().pop_back();
+    }
+
+    template<typename VALUE>
+    inline void SharedSequence<VALUE>::push_back(value_type value) {
+        write().push_back(value);
+    }
+
+    template<typename VALUE>
+    template<typename InputIt>
+    inline SharedSequence<VALUE>::iterator SharedSequence<VALUE>::insert(const_iterator at, InputIt first, InputIt last) {
+        return write().insert(at, first, last);
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                     Element Access
+    //
+    /*****************************************************************************************/
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::value_type* SharedSequence<VALUE>::data() {
+        return write().data();
+    }
+
+    template<typename VALUE>
+    inline const SharedSequence<VALUE>::value_type* SharedSequence<VALUE>::data() const noexcept {
+        return read().data();
+    }
+
+    template<typename VALUE>
+    inline const SharedSequence<VALUE>::value_type& SharedSequence<VALUE>::operator[](std::size_t index) const {
+        return read()[index];
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::value_type& SharedSequence<VALUE>::operator[](std::size_t index) {
+        return write()[index];
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                     Private Methods
+    //
+    /*****************************************************************************************/
+
+    template<typename VALUE>
+    inline const SharedSequence<VALUE>::buffer_type& SharedSequence<VALUE>::empty_buffer() noexcept {
+        static const buffer_type empty{};
+        return empty;
+    }
+
+    template<typename VALUE>
+    inline const SharedSequence<VALUE>::buffer_type& SharedSequence<VALUE>::read() const noexcept {
+        return _buffer ? *_buffer : empty_buffer();
+    }
+
+    template<typename VALUE>
+    inline SharedSequence<VALUE>::buffer_type& SharedSequence<VALUE>::write() {
+        if (!_buffer) {
+            _buffer = std::make_shared<buffer_type>();
+        }
+        else if (_buffer.use_count() > 1) {
+            _buffer = std::make_shared<buffer_type>(*_buffer);
+        }
+        return *_buffer;
+    }
+}
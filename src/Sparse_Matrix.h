@@ -0,0 +1,507 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Parallel.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                  'SparseMatrix' class
+    //
+    //          A sparse matrix in compressed sparse row, (CSR), form: the column
+    //          indices and values of the non zero elements of each row are stored
+    //          one row after the other, and row_offsets()[r] is the position of the
+    //          first element of row r, (with row_offsets()[rows()] the total count).
+    //          The column indices are of type INDEX, 32 bits by default, since the
+    //          index stream is as much of the memory traffic of a product as the
+    //          values are.
+    //
+    //          A * x is a lazy product, an expression template leaf whose element i
+    //          is the dot product of row i with x.  So it combines with dense
+    //          sequences without an intermediate container:
+    //
+    //              y = A * x + b;                  // rows evaluated in order
+    //              sparse_assign(y, A * x + b);    // rows evaluated in parallel
+    //
+    //          sparse_assign() and spmv() split the rows into blocks of about equal
+    //          work, (non zeros plus rows), rather than of equal row count, so a few
+    //          dense rows do not leave one thread with most of the product.
+    //
+    //          Row i of a product reads every element of x, so a product is not
+    //          element wise, (see is_element_wise).  Assigning it to a sequence it
+    //          reads, (x = A * x), evaluates it into a fresh buffer first, it never
+    //          reuses the buffer of an rvalue operand, and it cannot be fused.  The
+    //          shapes are checked, throwing std::invalid_argument, when a matrix is
+    //          built and when a product is formed.
+    //
+    /********************************************************************************************/
+
+    template <typename VALUE, typename INDEX>
+    struct SparseEntry {
+        std::size_t row;
+        INDEX       col;
+        VALUE       value;
+    };
+
+    template <typename Matrix, typename Expr>
+    class SparseProduct;
+
+    template <typename VALUE = double, typename INDEX = std::uint32_t>
+    class SparseMatrix {
+
+    public:
+        using value_type = VALUE;
+        using index_type = INDEX;
+        using entry_type = SparseEntry<VALUE, INDEX>;
+
+        SparseMatrix();
+        SparseMatrix(std::size_t rows, std::size_t cols, std::vector<std::size_t> row_offsets, std::vector<INDEX> col_indices, std::vector<VALUE> values);
+
+        static SparseMatrix from_entries(std::size_t rows, std::size_t cols, std::vector<entry_type> entries);
+
+        std::size_t rows() const noexcept;
+        std::size_t cols() const noexcept;
+        std::size_t nonzeros() const noexcept;
+
+        const std::vector<std::size_t>& row_offsets() const noexcept;
+        const std::vector<INDEX>&       col_indices() const noexcept;
+        const std::vector<VALUE>&       values() const noexcept;
+        std::vector<VALUE>&             values() noexcept;
+
+        value_type operator ()(std::size_t row, std::size_t col) const;
+
+        template <typename Expr>
+        auto operator *(const Expr& x) const& -> SparseProduct<SparseMatrix, Expr>;
+
+        std::vector<std::size_t> partition(std::size_t blocks) const;
+
+    private:
+        std::size_t              _rows;
+        std::size_t              _cols;
+        std::vector<std::size_t> _row_offsets;
+        std::vector<INDEX>       _col_indices;
+        std::vector<VALUE>       _values;
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                      Row Kernel
+    //
+    /*****************************************************************************************/
+
+    /*
+        The dot product of the elements [first, last) of a row with x, with
+        four independent accumulators so the gathers of x overlap.
+    */
+    template <typename T, typename INDEX, typename Reader>
+    T sparse_row_dot(const T* values, const INDEX* cols, std::size_t first, std::size_t last, const Reader& x) {
+        T a0 = T{ 0 };
+        T a1 = T{ 0 };
+        T a2 = T{ 0 };
+        T a3 = T{ 0 };
+        auto k = first;
+        for (; k + 4 <= last; k += 4) {
+            a0 += values[k + 0] * static_cast<T>(x[cols[k + 0]]);
+            a1 += values[k + 1] * static_cast<T>(x[cols[k + 1]]);
+            a2 += values[k + 2] * static_cast<T>(x[cols[k + 2]]);
+            a3 += values[k + 3] * static_cast<T>(x[cols[k + 3]]);
+        }
+        for (; k < last; ++k) {
+            a0 += values[k] * static_cast<T>(x[cols[k]]);
+        }
+        return (a0 + a1) + (a2 + a3);
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                 'SparseProduct' class
+    //
+    //          The lazy product of a SparseMatrix and a dense expression, both held
+    //          by reference, so it must be evaluated within the full expression it
+    //          was built in.
+    //
+    /*****************************************************************************************/
+
+    template <typename Matrix, typename Expr>
+    class SparseProduct {
+
+    public:
+        using value_type = Matrix::value_type;
+
+        SparseProduct(const Matrix& matrix, const Expr& x) : _matrix(matrix), _x(x) {
+        }
+
+        const Matrix& matrix() const noexcept {
+            return _matrix;
+        }
+
+        bool refers_to(const void* object) const noexcept {
+            return expr_refers_to(_x, object);
+        }
+
+        auto operator [](std::size_t row) const -> value_type {
+            if (row >= _matrix.rows()) {
+                return value_type{};
+            }
+            const auto& offsets = _matrix.row_offsets();
+            return sparse_row_dot(_matrix.values().data(), _matrix.col_indices().data(), offsets[row], offsets[row + 1], element_reader(_x));
+        }
+
+        auto size() const -> std::size_t {
+            return _matrix.rows();
+        }
+
+        template <typename RE> auto operator +(RE&& re) const& -> ExprTemplate<const SparseProduct&, Add_Op<value_type>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator -(RE&& re) const& -> ExprTemplate<const SparseProduct&, Sub_Op<value_type>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator *(RE&& re) const& -> ExprTemplate<const SparseProduct&, Mul_Op<value_type>, decltype(std::forward<RE>(re))>;
+        template <typename RE> auto operator /(RE&& re) const& -> ExprTemplate<const SparseProduct&, Div_Op<value_type>, decltype(std::forward<RE>(re))>;
+
+    private:
+        const Matrix& _matrix;
+        const Expr&   _x;
+    };
+
+    template <typename Matrix, typename Expr>
+    struct is_element_wise<SparseProduct<Matrix, Expr>> : std::false_type {};
+
+    template <typename Matrix, typename Expr>
+    template <typename RE>
+    inline auto SparseProduct<Matrix, Expr>::operator +(RE&& re) const& -> ExprTemplate<const SparseProduct&, Add_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const SparseProduct&, Add_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    template <typename Matrix, typename Expr>
+    template <typename RE>
+    inline auto SparseProduct<Matrix, Expr>::operator -(RE&& re) const& -> ExprTemplate<const SparseProduct&, Sub_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const SparseProduct&, Sub_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    template <typename Matrix, typename Expr>
+    template <typename RE>
+    inline auto SparseProduct<Matrix, Expr>::operator *(RE&& re) const& -> ExprTemplate<const SparseProduct&, Mul_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const SparseProduct&, Mul_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    template <typename Matrix, typename Expr>
+    template <typename RE>
+    inline auto SparseProduct<Matrix, Expr>::operator /(RE&& re) const& -> ExprTemplate<const SparseProduct&, Div_Op<value_type>, decltype(std::forward<RE>(re))> {
+        return ExprTemplate<const SparseProduct&, Div_Op<value_type>, decltype(std::forward<RE>(re))>(*this, std::forward<RE>(re));
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                     Construction
+    //
+    /*****************************************************************************************/
+
+    template <typename VALUE, typename INDEX>
+    inline SparseMatrix<VALUE, INDEX>::SparseMatrix() : _rows(0), _cols(0), _row_offsets(1, 0), _col_indices(), _values() {
+    }
+
+    /*
+        Adopts arrays already in CSR form, with the column indices of each row
+        in increasing order.  Throws std::invalid_argument unless there are
+        rows + 1 non decreasing offsets, from zero to the number of values,
+        and every column index is less than cols.
+    */
+    template <typename VALUE, typename INDEX>
+    inline SparseMatrix<VALUE, INDEX>::SparseMatrix(std::size_t rows, std::size_t cols, std::vector<std::size_t> row_offsets, std::vector<INDEX> col_indices, std::vector<VALUE> values)
+        : _rows(rows), _cols(cols), _row_offsets(std::move(row_offsets)), _col_indices(std::move(col_indices)), _values(std::move(values)) {
+        if (_row_offsets.size() != _rows + 1 || _row_offsets.front() != 0 || _row_offsets.back() != _col_indices.size() || _col_indices.size() != _values.size()) {
+            throw std::invalid_argument("SparseMatrix: the row offsets do not match the rows, column indices and values");
+        }
+        for (std::size_t r = 0; r < _rows; ++r) {
+            if (_row_offsets[r] > _row_offsets[r + 1]) {
+                throw std::invalid_argument("SparseMatrix: the row offsets are not in increasing order");
+            }
+        }
+        for (const auto col : _col_indices) {
+            if (static_cast<std::size_t>(col) >= _cols) {
+                throw std::invalid_argument("SparseMatrix: a column index is outside of the matrix");
+            }
+        }
+    }
+
+    /*
+        Builds the matrix from (row, col, value) entries in any order.  The
+        entries are bucketed by row with a counting pass, each row is sorted by
+        column, and the values of repeated positions are summed.  An entry
+        outside of the matrix throws std::invalid_argument.
+    */
+    template <typename VALUE, typename INDEX>
+    inline SparseMatrix<VALUE, INDEX> SparseMatrix<VALUE, INDEX>::from_entries(std::size_t rows, std::size_t cols, std::vector<entry_type> entries) {
+        std::vector<std::size_t> offsets(rows + 1, 0);
+        for (const auto& entry : entries) {
+            if (entry.row >= rows || static_cast<std::size_t>(entry.col) >= cols) {
+                throw std::invalid_argument("SparseMatrix::from_entries: an entry is outside of the matrix");
+            }
+            ++offsets[entry.row + 1];
+        }
+        for (std::size_t r = 0; r < rows; ++r) {
+            offsets[r + 1] += offsets[r];
+        }
+        std::vector<entry_type> bucketed(entries.size());
+        auto next = offsets;
+        for (const auto& entry : entries) {
+            bucketed[next[entry.row]++] = entry;
+        }
+
+        SparseMatrix result;
+        result._rows = rows;
+        result._cols = cols;
+        result._row_offsets.assign(rows + 1, 0);
+        result._col_indices.reserve(entries.size());
+        result._values.reserve(entries.size());
+        for (std::size_t r = 0; r < rows; ++r) {
+            const auto first = bucketed.begin() + offsets[r];
+            const auto last  = bucketed.begin() + offsets[r + 1];
+            std::sort(first, last, [](const entry_type& a, const entry_type& b) { return a.col < b.col; });
+            for (auto it = first; it != last; ++it) {
+                if (it != first && it->col == result._col_indices.back()) {
+                    result._values.back() += it->value;
+                }
+                else {
+                    result._col_indices.push_back(it->col);
+                    result._values.push_back(it->value);
+                }
+            }
+            result._row_offsets[r + 1] = result._values.size();
+        }
+        return result;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                       Access
+    //
+    /*****************************************************************************************/
+
+    template <typename VALUE, typename INDEX>
+    inline std::size_t SparseMatrix<VALUE, INDEX>::rows() const noexcept {
+        return _rows;
+    }
+
+    template <typename VALUE, typename INDEX>
+    inline std::size_t SparseMatrix<VALUE, INDEX>::cols() const noexcept {
+        return _cols;
+    }
+
+    template <typename VALUE, typename INDEX>
+    inline std::size_t SparseMatrix<VALUE, INDEX>::nonzeros() const noexcept {
+        return _values.size();
+    }
+
+    template <typename VALUE, typename INDEX>
+    inline const std::vector<std::size_t>& SparseMatrix<VALUE, INDEX>::row_offsets() const noexcept {
+        return _row_offsets;
+    }
+
+    template <typename VALUE, typename INDEX>
+    inline const std::vector<INDEX>& SparseMatrix<VALUE, INDEX>::col_indices() const noexcept {
+        return _col_indices;
+    }
+
+    template <typename VALUE, typename INDEX>
+    inline const std::vector<VALUE>& SparseMatrix<VALUE, INDEX>::values() const noexcept {
+        return _values;
+    }
+
+    template <typename VALUE, typename INDEX>
+    inline std::vector<VALUE>& SparseMatrix<VALUE, INDEX>::values() noexcept {
+        return _values;
+    }
+
+    /*
+        A binary search of the row, returning zero for an element not stored.
+    */
+    template <typename VALUE, typename INDEX>
+    inline SparseMatrix<VALUE, INDEX>::value_type SparseMatrix<VALUE, INDEX>::operator ()(std::size_t row, std::size_t col) const {
+        const auto first = _col_indices.begin() + _row_offsets[row];
+        const auto last  = _col_indices.begin() + _row_offsets[row + 1];
+        const auto it    = std::lower_bound(first, last, col, [](INDEX a, std::size_t b) { return static_cast<std::size_t>(a) < b; });
+        if (it == last || static_cast<std::size_t>(*it) != col) {
+            return value_type{};
+        }
+        return _values[it - _col_indices.begin()];
+    }
+
+    template <typename VALUE, typename INDEX>
+    template <typename Expr>
+    inline auto SparseMatrix<VALUE, INDEX>::operator *(const Expr& x) const& -> SparseProduct<SparseMatrix, Expr> {
+        if (x.size() < _cols) {
+            throw std::invalid_argument("SparseMatrix::operator *: x holds fewer elements than the matrix has columns");
+        }
+        return SparseProduct<SparseMatrix, Expr>(*this, x);
+    }
+
+    /*
+        Returns blocks + 1 row bounds, such that each block holds about the same
+        number of non zeros plus rows.  The work up to row r is
+        row_offsets[r] + r, which increases with r, so each bound is a binary
+        search for its share of the total.
+    */
+    template <typename VALUE, typename INDEX>
+    inline std::vector<std::size_t> SparseMatrix<VALUE, INDEX>::partition(std::size_t blocks) const {
+        blocks = std::max<std::size_t>(blocks, 1);
+        const auto total = nonzeros() + _rows;
+        std::vector<std::size_t> bounds(blocks + 1, _rows);
+        bounds[0] = 0;
+        for (std::size_t b = 1; b < blocks; ++b) {
+            const auto target = total / blocks * b + std::min(b, total % blocks);
+            std::size_t low  = bounds[b - 1];
+            std::size_t high = _rows;
+            while (low < high) {
+                const auto mid = low + (high - low) / 2;
+                if (_row_offsets[mid] + mid < target) {
+                    low = mid + 1;
+                }
+                else {
+                    high = mid;
+                }
+            }
+            bounds[b] = low;
+        }
+        return bounds;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                   Parallel Products
+    //
+    /*****************************************************************************************/
+
+    template <typename Expr>
+    struct is_sparse_product : std::false_type {};
+
+    template <typename Matrix, typename X>
+    struct is_sparse_product<SparseProduct<Matrix, X>> : std::true_type {};
+
+    /*
+        The row bounds of the first sparse product found within an expression,
+        balanced by its work, or an empty vector if there is none.
+    */
+    template <typename Expr>
+    auto sparse_partition_of(const Expr& expr, std::size_t grain) -> std::vector<std::size_t> {
+        if constexpr (is_sparse_product<Expr>::value) {
+            const auto& matrix = expr.matrix();
+            return matrix.partition(block_count(matrix.nonzeros() + matrix.rows(), grain));
+        }
+        else if constexpr (is_expr_template<Expr>::value) {
+            auto bounds = sparse_partition_of(expr.left_expr(), grain);
+            return bounds.empty() ? sparse_partition_of(expr.right_expr(), grain) : bounds;
+        }
+        else {
+            return {};
+        }
+    }
+
+    /*
+        Evaluates an expression holding sparse products into 'y', resized to
+        the size of the expression, with the blocks of rows balanced by the
+        work of the first product found.  When the expression reads y, it is
+        evaluated into a fresh sequence which is then moved into y.
+    */
+    template <typename Seq, typename Expr>
+    Seq& sparse_assign(Seq& y, const Expr& expr, std::size_t grain = default_grain) {
+        using value_type = Seq::value_type;
+        if (!is_element_wise<Expr>::value && expr_refers_to(expr, &y)) {
+            Seq fresh;
+            sparse_assign(fresh, expr, grain);
+            y = std::move(fresh);
+            return y;
+        }
+        const auto count = expr.size();
+        auto bounds = sparse_partition_of(expr, grain);
+        if (bounds.empty()) {
+            const auto blocks = block_count(count, grain);
+            bounds.resize(blocks + 1);
+            for (std::size_t b = 0; b < blocks; ++b) {
+                bounds[b] = block_range(count, blocks, b).first;
+            }
+            bounds[blocks] = count;
+        }
+        bounds.back() = count;
+        fill_sequence(y, count, [&](value_type* out) {
+            parallel_blocks(bounds.size() - 1, [&](std::size_t block) {
+                const auto first = std::min(bounds[block], count);
+                const auto last  = std::min(bounds[block + 1], count);
+                for (auto i = first; i < last; ++i) {
+                    out[i] = expr[i];
+                }
+            });
+        });
+        return y;
+    }
+
+    /*
+        y = alpha * A * x + beta * y, resizing y to the rows of A.  Throws
+        std::invalid_argument when x holds fewer elements than A has columns.
+        When x reads y, x is copied first.
+    */
+    template <typename VALUE, typename INDEX, typename Expr, typename Seq>
+    Seq& spmv(VALUE alpha, const SparseMatrix<VALUE, INDEX>& a, const Expr& x, VALUE beta, Seq& y, std::size_t grain = default_grain) {
+        using value_type = Seq::value_type;
+        if (x.size() < a.cols()) {
+            throw std::invalid_argument("spmv: x holds fewer elements than the matrix has columns");
+        }
+        if (expr_refers_to(x, &y)) {
+            SeqContainer<VALUE> copy;
+            fill_sequence(copy, x.size(), [&](VALUE* data) {
+                for (std::size_t i = 0; i < x.size(); ++i) {
+                    data[i] = static_cast<VALUE>(x[i]);
+                }
+            });
+            return spmv(alpha, a, copy, beta, y, grain);
+        }
+        const auto rows = a.rows();
+        if (y.size() != rows) {
+            y.resize(rows);
+        }
+        const auto& offsets = a.row_offsets();
+        const auto* values  = a.values().data();
+        const auto* cols    = a.col_indices().data();
+        const auto  in      = element_reader(x);
+        const auto  bounds  = a.partition(block_count(a.nonzeros() + rows, grain));
+        auto& out = y.impl();
+        parallel_blocks(bounds.size() - 1, [&](std::size_t block) {
+            for (auto r = bounds[block]; r < bounds[block + 1]; ++r) {
+                const VALUE dot = sparse_row_dot(values, cols, offsets[r], offsets[r + 1], in);
+                out[r] = static_cast<value_type>(alpha * dot + (beta == VALUE{ 0 } ? VALUE{ 0 } : beta * static_cast<VALUE>(out[r])));
+            }
+        });
+        return y;
+    }
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                    Statement Fusion
+    //
+    //          Consecutive statements such as:
+    //
+    //              m += n * n;
+    //              k  = m * c;
+    //              s  = k - n;
+    //
+    //          each stream all of their operands through memory.  When fused:
+    //
+    //              fuse(add_assign(m, n * n), assign(k, m * c), assign(s, k - n));
+    //
+    //          the statements are evaluated one cache sized tile at a time, running
+    //          every statement over the tile, in order, before moving on to the
+    //          next tile.  So the tile of 'm' written by the first statement is still
+    //          in cache when the second statement reads it.
+    //
+    //          Since every operation of an expression template is element wise,
+    //          index i of a statement only reads index i of its operands.  Running
+    //          the statements in order within each tile therefore honors every
+    //          dependency between them, exactly as if they were run one after the
+    //          other.  The destinations are all sized before the first tile, in
+    //          statement order, so that a later statement sees the final size of
+    //          a sequence written by an earlier one.  An expression which is not
+    //          element wise, (see is_element_wise), would read elements of other
+    //          tiles, so a statement rejects it at compile time.  A reduction over
+    //          such an expression must not be fused with a statement writing one
+    //          of its operands.
+    //
+    //          A statement holds its expression by reference, so the statements must
+    //          be built within the same full expression as the call to fuse().
+    //
+    /********************************************************************************************/
+
+    constexpr std::size_t fusion_tile_size = 2048;
+
+    /*****************************************************************************************/
+    //
+    //                                     'Statement' class
+    //
+    //          Applies 'dest[i] = Op::apply(dest[i], expr[i])' over a tile of indices.
+    //
+    /*****************************************************************************************/
+
+    template <typename Seq, typename Op, typename Expr>
+    class Statement {
+
+    public:
+        using value_type = Seq::value_type;
+
+        static_assert(is_element_wise<Expr>::value, "a statement which reads other elements of its operands, such as a sparse product, cannot be fused");
+
+        Statement(Seq& dest, const Expr& expr) : _dest(dest), _expr(expr) {
+        }
+
+        void prepare() {
+            const auto limit = std::max(_dest.size(), _expr.size());
+            if (_dest.size() < limit) {
+                _dest.resize(limit);
+            }
+        }
+
+        std::size_t size() const {
+            return _dest.size();
+        }
+
+        void run(std::size_t first, std::size_t last) {
+            auto& out = _dest.impl();
+            last = std::min(last, out.size());
+            for (std::size_t i = first; i < last; ++i) {
+                const value_type value = _expr[i];
+                out[i] = Op::apply(std::as_const(out[i]), value);
+            }
+        }
+
+        Seq& result() {
+            return _dest;
+        }
+
+    private:
+        Seq&        _dest;
+        const Expr& _expr;
+    };
+
+    template <typename Op, typename Seq, typename Expr>
+    auto statement(Seq& dest, const Expr& expr) -> Statement<Seq, Op, Expr> {
+        return Statement<Seq, Op, Expr>(dest, expr);
+    }
+
+    template <typename Seq, typename Expr>
+    auto assign(Seq& dest, const Expr& expr) -> Statement<Seq, Assign_Op<typename Seq::value_type>, Expr> {
+        return statement<Assign_Op<typename Seq::value_type>>(dest, expr);
+    }
+
+    template <typename Seq, typename Expr>
+    auto add_assign(Seq& dest, const Expr& expr) -> Statement<Seq, Add_Op<typename Seq::value_type>, Expr> {
+        return statement<Add_Op<typename Seq::value_type>>(dest, expr);
+    }
+
+    template <typename Seq, typename Expr>
+    auto sub_assign(Seq& dest, const Expr& expr) -> Statement<Seq, Sub_Op<typename Seq::value_type>, Expr> {
+        return statement<Sub_Op<typename Seq::value_type>>(dest, expr);
+    }
+
+    template <typename Seq, typename Expr>
+    auto mul_assign(Seq& dest, const Expr& expr) -> Statement<Seq, Mul_Op<typename Seq::value_type>, Expr> {
+        return statement<Mul_Op<typename Seq::value_type>>(dest, expr);
+    }
+
+    template <typename Seq, typename Expr>
+    auto div_assign(Seq& dest, const Expr& expr) -> Statement<Seq, Div_Op<typename Seq::value_type>, Expr> {
+        return statement<Div_Op<typename Seq::value_type>>(dest, expr);
+    }
+
+    template <typename Seq, typename Expr>
+    auto mod_assign(Seq& dest, const Expr& expr) -> Statement<Seq, Mod_Op<typename Seq::value_type>, Expr> {
+        return statement<Mod_Op<typename Seq::value_type>>(dest, expr);
+    }
+
+    template <typename Seq, typename Expr>
+    auto and_assign(Seq& dest, const Expr& expr) -> Statement<Seq, And_Op<typename Seq::value_type>, Expr> {
+        return statement<And_Op<typename Seq::value_type>>(dest, expr);
+    }
+
+    template <typename Seq, typename Expr>
+    auto or_assign(Seq& dest, const Expr& expr) -> Statement<Seq, Or_Op<typename Seq::value_type>, Expr> {
+        return statement<Or_Op<typename Seq::value_type>>(dest, expr);
+    }
+
+    template <typename Seq, typename Expr>
+    auto xor_assign(Seq& dest, const Expr& expr) -> Statement<Seq, Xor_Op<typename Seq::value_type>, Expr> {
+        return statement<Xor_Op<typename Seq::value_type>>(dest, expr);
+    }
+
+    template <typename Seq, typename Expr>
+    auto lshift_assign(Seq& dest, const Expr& expr) -> Statement<Seq, LeftShift_Op<typename Seq::value_type>, Expr> {
+        return statement<LeftShift_Op<typename Seq::value_type>>(dest, expr);
+    }
+
+    template <typename Seq, typename Expr>
+    auto rshift_assign(Seq& dest, const Expr& expr) -> Statement<Seq, RightShift_Op<typename Seq::value_type>, Expr> {
+        return statement<RightShift_Op<typename Seq::value_type>>(dest, expr);
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                       Fused Evaluation
+    //
+    //          Every fused item provides prepare(), size(), run(first, last) and
+    //          result().  The results of the items are returned as a tuple.
+    //
+    /*****************************************************************************************/
+
+    template <typename... Items>
+    auto fuse_tiled(std::size_t tile, Items&&... items) -> std::tuple<decltype(items.result())...> {
+        (items.prepare(), ...);
+        const auto limit = std::max({ std::size_t{ 0 }, items.size()... });
+        tile = std::max<std::size_t>(tile, 1);
+        for (std::size_t first = 0; first < limit; first += tile) {
+            const auto last = std::min(first + tile, limit);
+            (items.run(first, last), ...);
+        }
+        return std::tuple<decltype(items.result())...>(items.result()...);
+    }
+
+    template <typename... Items>
+    auto fuse(Items&&... items) -> std::tuple<decltype(items.result())...> {
+        return fuse_tiled(fusion_tile_size, std::forward<Items>(items)...);
+    }
+}
@@ -0,0 +1,795 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Parallel.h"
+#include "SeqContainer.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                     'TensorView' class
+    //
+    //          An N dimensional view, (a shape and a stride per dimension), over the
+    //          contiguous buffer of a SeqContainer.  Views are cheap to copy, and
+    //          reshape(), permute(), slice(), expand_dims() and broadcast_to() all
+    //          return new views of the same buffer.  Assigning to a view writes the
+    //          elements through it, it never rebinds the view.
+    //
+    //          Views, and scalars, combine element wise with NumPy broadcasting:
+    //          shapes are aligned on their last dimension, and a dimension of
+    //          extent one, (or a missing one), is repeated along the extent of the
+    //          other operand by giving it a stride of zero.  So no operand is ever
+    //          expanded in memory:
+    //
+    //              auto x = tensor_view(xs, { 64, 128 });
+    //              auto m = tensor_view(ms, { 128 });
+    //              auto s = tensor_view(ss, { 64, 1 });
+    //
+    //              tensor_view(out, { 64, 128 }) = (x - m) / s + 1.0;
+    //
+    //          Unlike an ExprTemplate, a TensorExpr holds its operands by value,
+    //          which for a view is a pointer, a shape and the strides.  The views
+    //          must not outlive the SeqContainers they were taken from.
+    //
+    /********************************************************************************************/
+
+    using TensorShape   = std::vector<std::size_t>;
+    using TensorStrides = std::vector<std::ptrdiff_t>;
+
+    constexpr std::size_t tensor_tile_size = 256;
+
+    template <typename T>
+    class TensorView;
+
+    template <typename T>
+    class TensorScalar;
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    class TensorExpr;
+
+    template <typename Expr>
+    struct is_tensor_expr : std::false_type {};
+
+    template <typename T>
+    struct is_tensor_expr<TensorView<T>> : std::true_type {};
+
+    template <typename T>
+    struct is_tensor_expr<TensorScalar<T>> : std::true_type {};
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    struct is_tensor_expr<TensorExpr<LeftExpr, BinaryOp, RightExpr>> : std::true_type {};
+
+    inline std::size_t shape_size(const TensorShape& shape) {
+        return std::accumulate(shape.begin(), shape.end(), std::size_t{ 1 }, std::multiplies<std::size_t>());
+    }
+
+    inline TensorStrides contiguous_strides(const TensorShape& shape) {
+        TensorStrides strides(shape.size());
+        std::ptrdiff_t stride = 1;
+        for (std::size_t d = shape.size(); d-- > 0;) {
+            strides[d] = stride;
+            stride    *= static_cast<std::ptrdiff_t>(shape[d]);
+        }
+        return strides;
+    }
+
+    /*
+        The NumPy broadcast of two shapes, throwing std::invalid_argument when
+        a pair of aligned extents differ and neither of them is one.
+    */
+    inline TensorShape broadcast_shapes(const TensorShape& a, const TensorShape& b) {
+        const auto rank = std::max(a.size(), b.size());
+        TensorShape shape(rank);
+        for (std::size_t d = 0; d < rank; ++d) {
+            const auto ea = d < rank - a.size() ? 1 : a[d - (rank - a.size())];
+            const auto eb = d < rank - b.size() ? 1 : b[d - (rank - b.size())];
+            if (ea != eb && ea != 1 && eb != 1) {
+                throw std::invalid_argument("broadcast_shapes: incompatible tensor shapes");
+            }
+            shape[d] = ea == 1 ? eb : ea;
+        }
+        return shape;
+    }
+
+    /*
+        The strides of an operand of 'shape' and 'strides' broadcast to 'result',
+        which must be its broadcast shape.
+    */
+    inline TensorStrides broadcast_strides(const TensorShape& shape, const TensorStrides& strides, const TensorShape& result) {
+        TensorStrides out(result.size(), 0);
+        const auto offset = result.size() - shape.size();
+        for (std::size_t d = 0; d < shape.size(); ++d) {
+            out[offset + d] = shape[d] == 1 ? 0 : strides[d];
+        }
+        return out;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                    Evaluation Cursors
+    //
+    //          Each node of a tensor expression builds a cursor for the shape of the
+    //          result.  Cursors compute one run of the innermost dimension at a time:
+    //          row(first, count, out) returns a pointer to the 'count' values starting
+    //          at 'first' along the innermost dimension, either within the operand
+    //          itself, (a unit stride view), or written into 'out'.  Every run is
+    //          thus a loop over unit stride pointers.
+    //
+    //          Before evaluating, dimensions of extent one are dropped, and adjacent
+    //          dimensions are merged wherever every operand, (and the destination),
+    //          can step across both with a single stride.  A fully contiguous
+    //          expression is then a single run, whatever its rank.
+    //
+    /*****************************************************************************************/
+
+    template <typename T>
+    class TensorLeafCursor {
+
+    public:
+        using value_type = std::remove_const_t<T>;
+
+        TensorLeafCursor(T* data, TensorStrides strides) : _base(data), _ptr(data), _strides(std::move(strides)) {
+        }
+
+        void collect(std::vector<TensorStrides*>& strides) {
+            strides.push_back(&_strides);
+        }
+
+        void seek(const std::size_t* index, std::size_t outer) {
+            std::ptrdiff_t offset = 0;
+            for (std::size_t d = 0; d < outer; ++d) {
+                offset += static_cast<std::ptrdiff_t>(index[d]) * _strides[d];
+            }
+            _ptr = _base + offset;
+        }
+
+        T* at(std::size_t first) const {
+            return _ptr + static_cast<std::ptrdiff_t>(first) * _strides.back();
+        }
+
+        std::ptrdiff_t inner_stride() const {
+            return _strides.back();
+        }
+
+        const value_type* row(std::size_t first, std::size_t count, value_type* out) const {
+            const auto stride = _strides.back();
+            if (stride == 1) {
+                return _ptr + first;
+            }
+            if (stride == 0) {
+                std::fill_n(out, count, *_ptr);
+                return out;
+            }
+            const T* in = at(first);
+            for (std::size_t j = 0; j < count; ++j) {
+                out[j] = in[static_cast<std::ptrdiff_t>(j) * stride];
+            }
+            return out;
+        }
+
+    private:
+        T*            _base;
+        T*            _ptr;
+        TensorStrides _strides;
+    };
+
+    template <typename T>
+    class TensorScalarCursor {
+
+    public:
+        using value_type = T;
+
+        explicit TensorScalarCursor(T value) : _row(tensor_tile_size, value) {
+        }
+
+        void collect(std::vector<TensorStrides*>&) {
+        }
+
+        void seek(const std::size_t*, std::size_t) {
+        }
+
+        const value_type* row(std::size_t, std::size_t, value_type*) const {
+            return _row.data();
+        }
+
+    private:
+        std::vector<T> _row;
+    };
+
+    template <typename LeftCursor, typename BinaryOp, typename RightCursor>
+    class TensorExprCursor {
+
+    public:
+        using value_type = LeftCursor::value_type;
+
+        TensorExprCursor(LeftCursor left, RightCursor right) : _left(std::move(left)), _right(std::move(right)), _left_row(tensor_tile_size), _right_row(tensor_tile_size) {
+        }
+
+        void collect(std::vector<TensorStrides*>& strides) {
+            _left.collect(strides);
+            _right.collect(strides);
+        }
+
+        void seek(const std::size_t* index, std::size_t outer) {
+            _left.seek(index, outer);
+            _right.seek(index, outer);
+        }
+
+        const value_type* row(std::size_t first, std::size_t count, value_type* out) {
+            const auto* a = _left.row(first, count, _left_row.data());
+            const auto* b = _right.row(first, count, _right_row.data());
+            for (std::size_t j = 0; j < count; ++j) {
+                out[j] = BinaryOp::apply(static_cast<const value_type&>(a[j]), static_cast<const value_type&>(b[j]));
+            }
+            return out;
+        }
+
+    private:
+        LeftCursor  _left;
+        RightCursor _right;
+
+        std::vector<value_type>                       _left_row;
+        std::vector<typename RightCursor::value_type> _right_row;
+    };
+
+    /*
+        Drops the dimensions of extent one and merges adjacent dimensions d and
+        d + 1 whenever every stride satisfies strides[d] == strides[d + 1] * shape[d + 1].
+        At least one dimension is always left.
+    */
+    inline void collapse_dimensions(TensorShape& shape, const std::vector<TensorStrides*>& strides) {
+        auto erase = [&](std::size_t d) {
+            shape.erase(shape.begin() + d);
+            for (auto* s : strides) {
+                s->erase(s->begin() + d);
+            }
+        };
+        for (std::size_t d = shape.size(); d-- > 0 && shape.size() > 1;) {
+            if (shape[d] == 1) {
+                erase(d);
+            }
+        }
+        for (std::size_t d = shape.size() - 1; d-- > 0;) {
+            const auto extent = static_cast<std::ptrdiff_t>(shape[d + 1]);
+            const auto merge  = std::all_of(strides.begin(), strides.end(), [&](const TensorStrides* s) {
+                return (*s)[d] == (*s)[d + 1] * extent;
+            });
+            if (merge) {
+                shape[d + 1] *= shape[d];
+                erase(d);
+            }
+        }
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                    'TensorScalar' class
+    //
+    /*****************************************************************************************/
+
+    template <typename T>
+    class TensorScalar {
+
+    public:
+        using value_type = T;
+
+        explicit TensorScalar(T value) : _value(value) {
+        }
+
+        const TensorShape& shape() const noexcept {
+            static const TensorShape scalar_shape;
+            return scalar_shape;
+        }
+
+        auto cursor(const TensorShape&) const -> TensorScalarCursor<T> {
+            return TensorScalarCursor<T>(_value);
+        }
+
+    private:
+        T _value;
+    };
+
+    /*
+        Wraps a value which is not a tensor expression as a scalar of 'T'.
+    */
+    template <typename T, typename Expr>
+    auto tensor_operand(const Expr& expr) {
+        if constexpr (is_tensor_expr<Expr>::value) {
+            return expr;
+        }
+        else {
+            return TensorScalar<T>(static_cast<T>(expr));
+        }
+    }
+
+    template <typename T, typename Expr>
+    using tensor_operand_t = decltype(tensor_operand<T>(std::declval<const Expr&>()));
+
+    /*****************************************************************************************/
+    //
+    //                                     'TensorExpr' class
+    //
+    /*****************************************************************************************/
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    class TensorExpr {
+
+    public:
+        using value_type = LeftExpr::value_type;
+
+        TensorExpr(LeftExpr l, RightExpr r) : _left_expr(std::move(l)), _right_expr(std::move(r)), _shape(broadcast_shapes(_left_expr.shape(), _right_expr.shape())) {
+        }
+
+        const TensorShape& shape() const noexcept {
+            return _shape;
+        }
+
+        std::size_t rank() const noexcept {
+            return _shape.size();
+        }
+
+        std::size_t size() const {
+            return shape_size(_shape);
+        }
+
+        auto cursor(const TensorShape& result) const {
+            auto left  = _left_expr.cursor(result);
+            auto right = _right_expr.cursor(result);
+            return TensorExprCursor<decltype(left), BinaryOp, decltype(right)>(std::move(left), std::move(right));
+        }
+
+        template <typename RE> auto operator +(const RE& re) const -> TensorExpr<TensorExpr, Add_Op<value_type>, tensor_operand_t<value_type, RE>>;
+        template <typename RE> auto operator -(const RE& re) const -> TensorExpr<TensorExpr, Sub_Op<value_type>, tensor_operand_t<value_type, RE>>;
+        template <typename RE> auto operator *(const RE& re) const -> TensorExpr<TensorExpr, Mul_Op<value_type>, tensor_operand_t<value_type, RE>>;
+        template <typename RE> auto operator /(const RE& re) const -> TensorExpr<TensorExpr, Div_Op<value_type>, tensor_operand_t<value_type, RE>>;
+
+    private:
+        LeftExpr    _left_expr;
+        RightExpr   _right_expr;
+        TensorShape _shape;
+    };
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    template <typename RE>
+    inline auto TensorExpr<LeftExpr, BinaryOp, RightExpr>::operator +(const RE& re) const -> TensorExpr<TensorExpr, Add_Op<value_type>, tensor_operand_t<value_type, RE>> {
+        return TensorExpr<TensorExpr, Add_Op<value_type>, tensor_operand_t<value_type, RE>>(*this, tensor_operand<value_type>(re));
+    }
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    template <typename RE>
+    inline auto TensorExpr<LeftExpr, BinaryOp, RightExpr>::operator -(const RE& re) const -> TensorExpr<TensorExpr, Sub_Op<value_type>, tensor_operand_t<value_type, RE>> {
+        return TensorExpr<TensorExpr, Sub_Op<value_type>, tensor_operand_t<value_type, RE>>(*this, tensor_operand<value_type>(re));
+    }
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    template <typename RE>
+    inline auto TensorExpr<LeftExpr, BinaryOp, RightExpr>::operator *(const RE& re) const -> TensorExpr<TensorExpr, Mul_Op<value_type>, tensor_operand_t<value_type, RE>> {
+        return TensorExpr<TensorExpr, Mul_Op<value_type>, tensor_operand_t<value_type, RE>>(*this, tensor_operand<value_type>(re));
+    }
+
+    template <typename LeftExpr, typename BinaryOp, typename RightExpr>
+    template <typename RE>
+    inline auto TensorExpr<LeftExpr, BinaryOp, RightExpr>::operator /(const RE& re) const -> TensorExpr<TensorExpr, Div_Op<value_type>, tensor_operand_t<value_type, RE>> {
+        return TensorExpr<TensorExpr, Div_Op<value_type>, tensor_operand_t<value_type, RE>>(*this, tensor_operand<value_type>(re));
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                   'TensorView' class
+    //
+    /*****************************************************************************************/
+
+    template <typename T>
+    class TensorView {
+
+    public:
+        using value_type = std::remove_const_t<T>;
+
+        TensorView(T* data, TensorShape shape);
+        TensorView(T* data, TensorShape shape, TensorStrides strides);
+
+        TensorView(const TensorView&) = default;
+        TensorView(TensorView&&)      = default;
+
+        TensorView& operator =(const TensorView& other) requires (!std::is_const_v<T>);
+        TensorView& operator =(value_type value)        requires (!std::is_const_v<T>);
+
+        template <typename Expr> requires is_tensor_expr<Expr>::value
+        TensorView& operator =(const Expr& expr) requires (!std::is_const_v<T>);
+
+        T*                   data() const noexcept;
+        const TensorShape&   shape() const noexcept;
+        const TensorStrides& strides() const noexcept;
+        std::size_t          rank() const noexcept;
+        std::size_t          size() const;
+        bool                 is_contiguous() const;
+
+        template <typename... Index>
+        T& operator ()(Index... index) const;
+
+        TensorView          reshape(TensorShape shape) const;
+        TensorView          permute(const std::vector<std::size_t>& axes) const;
+        TensorView          transpose() const;
+        TensorView          slice(std::size_t axis, std::size_t first, std::size_t last) const;
+        TensorView          expand_dims(std::size_t axis) const;
+        TensorView<const T> broadcast_to(const TensorShape& shape) const;
+
+        auto cursor(const TensorShape& result) const -> TensorLeafCursor<const value_type>;
+
+        template <typename RE> auto operator +(const RE& re) const -> TensorExpr<TensorView, Add_Op<value_type>, tensor_operand_t<value_type, RE>>;
+        template <typename RE> auto operator -(const RE& re) const -> TensorExpr<TensorView, Sub_Op<value_type>, tensor_operand_t<value_type, RE>>;
+        template <typename RE> auto operator *(const RE& re) const -> TensorExpr<TensorView, Mul_Op<value_type>, tensor_operand_t<value_type, RE>>;
+        template <typename RE> auto operator /(const RE& re) const -> TensorExpr<TensorView, Div_Op<value_type>, tensor_operand_t<value_type, RE>>;
+
+    private:
+        T*            _data;
+        TensorShape   _shape;
+        TensorStrides _strides;
+    };
+
+    /*****************************************************************************************/
+    //
+    //                                     Construction
+    //
+    /*****************************************************************************************/
+
+    template <typename T>
+    inline TensorView<T>::TensorView(T* data, TensorShape shape) : _data(data), _shape(std::move(shape)), _strides() {
+        _strides = contiguous_strides(_shape);
+    }
+
+    template <typename T>
+    inline TensorView<T>::TensorView(T* data, TensorShape shape, TensorStrides strides) : _data(data), _shape(std::move(shape)), _strides(std::move(strides)) {
+    }
+
+    /*
+        Views the whole of a contiguous SeqContainer as a tensor of 'shape',
+        (by default one dimensional), which must hold exactly seq.size() elements.
+    */
+    template <typename VALUE, typename IMPL> requires std::ranges::contiguous_range<IMPL>
+    auto tensor_view(SeqContainer<VALUE, IMPL>& seq, TensorShape shape) -> TensorView<typename IMPL::value_type> {
+        if (shape_size(shape) != seq.size()) {
+            throw std::invalid_argument("tensor_view: the shape does not match the size of the sequence");
+        }
+        return TensorView<typename IMPL::value_type>(seq.data(), std::move(shape));
+    }
+
+    template <typename VALUE, typename IMPL> requires std::ranges::contiguous_range<const IMPL>
+    auto tensor_view(const SeqContainer<VALUE, IMPL>& seq, TensorShape shape) -> TensorView<const typename IMPL::value_type> {
+        if (shape_size(shape) != seq.size()) {
+            throw std::invalid_argument("tensor_view: the shape does not match the size of the sequence");
+        }
+        return TensorView<const typename IMPL::value_type>(seq.data(), std::move(shape));
+    }
+
+    template <typename VALUE, typename IMPL> requires std::ranges::contiguous_range<IMPL>
+    auto tensor_view(SeqContainer<VALUE, IMPL>& seq) -> TensorView<typename IMPL::value_type> {
+        return tensor_view(seq, TensorShape{ seq.size() });
+    }
+
+    template <typename VALUE, typename IMPL> requires std::ranges::contiguous_range<const IMPL>
+    auto tensor_view(const SeqContainer<VALUE, IMPL>& seq) -> TensorView<const typename IMPL::value_type> {
+        return tensor_view(seq, TensorShape{ seq.size() });
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                  Broadcast Evaluation
+    //
+    //          The collapsed dimensions of the result are split into runs of the
+    //          innermost dimension, and the runs are split into blocks evaluated in
+    //          parallel, each with its own cursors.  Every element of the destination
+    //          is written once, so the destination may be an operand of the expression
+    //          read through the same view, but must not otherwise overlap one.
+    //
+    /*****************************************************************************************/
+
+    template <typename T, typename Expr>
+    void tensor_assign(const TensorView<T>& dest, const Expr& expr, std::size_t grain = default_grain) {
+        using value_type = TensorView<T>::value_type;
+        if (broadcast_shapes(expr.shape(), dest.shape()) != dest.shape()) {
+            throw std::invalid_argument("tensor_assign: the expression does not broadcast to the destination");
+        }
+        if (dest.size() == 0) {
+            return;
+        }
+        const auto result = dest.shape().empty() ? TensorShape{ 1 } : dest.shape();
+        const auto target = dest.shape().empty() ? TensorStrides{ 0 } : dest.strides();
+
+        auto prepare = [&](auto& source, TensorLeafCursor<T>& out) {
+            std::vector<TensorStrides*> strides;
+            source.collect(strides);
+            out.collect(strides);
+            auto shape = result;
+            collapse_dimensions(shape, strides);
+            return shape;
+        };
+
+        auto probe_source = expr.cursor(result);
+        auto probe_dest   = TensorLeafCursor<T>(dest.data(), target);
+        const auto shape  = prepare(probe_source, probe_dest);
+        const auto outer  = shape.size() - 1;
+        const auto inner  = shape.back();
+        const auto runs   = shape_size(shape) / inner;
+
+        parallel_for(runs, std::max<std::size_t>(grain / inner, 1), [&](std::size_t first, std::size_t last, std::size_t) {
+            auto source = expr.cursor(result);
+            auto out    = TensorLeafCursor<T>(dest.data(), target);
+            prepare(source, out);
+
+            std::vector<std::size_t> index(outer + 1, 0);
+            for (auto rest = first, d = outer; d-- > 0;) {
+                index[d] = rest % shape[d];
+                rest    /= shape[d];
+            }
+            std::vector<value_type> buffer(tensor_tile_size);
+            for (auto run = first; run < last; ++run) {
+                source.seek(index.data(), outer);
+                out.seek(index.data(), outer);
+                for (std::size_t at = 0; at < inner; at += tensor_tile_size) {
+                    const auto count = std::min(tensor_tile_size, inner - at);
+                    if (out.inner_stride() == 1) {
+                        T* to = out.at(at);
+                        const auto* values = source.row(at, count, to);
+                        if (values != to) {
+                            std::copy_n(values, count, to);
+                        }
+                    }
+                    else {
+                        const auto* values = source.row(at, count, buffer.data());
+                        T* to = out.at(at);
+                        for (std::size_t j = 0; j < count; ++j) {
+                            to[static_cast<std::ptrdiff_t>(j) * out.inner_stride()] = values[j];
+                        }
+                    }
+                }
+                for (auto d = outer; d-- > 0;) {
+                    if (++index[d] < shape[d]) {
+                        break;
+                    }
+                    index[d] = 0;
+                }
+            }
+        });
+    }
+
+    /*
+        Evaluates a tensor expression into a new contiguous SeqContainer, in
+        row major order of expr.shape().
+    */
+    template <typename Expr> requires is_tensor_expr<Expr>::value
+    auto materialize(const Expr& expr) -> SeqContainer<typename Expr::value_type> {
+        using value_type = Expr::value_type;
+        SeqContainer<value_type> out;
+        out.resize(shape_size(expr.shape()));
+        tensor_assign(TensorView<value_type>(out.data(), expr.shape()), expr);
+        return out;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                      Assignment
+    //
+    /*****************************************************************************************/
+
+    template <typename T>
+    inline TensorView<T>& TensorView<T>::operator =(const TensorView& other) requires (!std::is_const_v<T>) {
+        tensor_assign(*this, other);
+        return *this;
+    }
+
+    template <typename T>
+    inline TensorView<T>& TensorView<T>::operator =(value_type value) requires (!std::is_const_v<T>) {
+        tensor_assign(*this, TensorScalar<value_type>(value));
+        return *this;
+    }
+
+    template <typename T>
+    template <typename Expr> requires is_tensor_expr<Expr>::value
+    inline TensorView<T>& TensorView<T>::operator =(const Expr& expr) requires (!std::is_const_v<T>) {
+        tensor_assign(*this, expr);
+        return *this;
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                       Access
+    //
+    /*****************************************************************************************/
+
+    template <typename T>
+    inline T* TensorView<T>::data() const noexcept {
+        return _data;
+    }
+
+    template <typename T>
+    inline const TensorShape& TensorView<T>::shape() const noexcept {
+        return _shape;
+    }
+
+    template <typename T>
+    inline const TensorStrides& TensorView<T>::strides() const noexcept {
+        return _strides;
+    }
+
+    template <typename T>
+    inline std::size_t TensorView<T>::rank() const noexcept {
+        return _shape.size();
+    }
+
+    template <typename T>
+    inline std::size_t TensorView<T>::size() const {
+        return shape_size(_shape);
+    }
+
+    template <typename T>
+    inline bool TensorView<T>::is_contiguous() const {
+        const auto expected = contiguous_strides(_shape);
+        for (std::size_t d = 0; d < _shape.size(); ++d) {
+            if (_shape[d] != 1 && _strides[d] != expected[d]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename T>
+    template <typename... Index>
+    inline T& TensorView<T>::operator ()(Index... index) const {
+        const std::size_t at[] = { static_cast<std::size_t>(index)..., 0 };
+        std::ptrdiff_t offset = 0;
+        for (std::size_t d = 0; d < sizeof...(Index); ++d) {
+            offset += static_cast<std::ptrdiff_t>(at[d]) * _strides[d];
+        }
+        return _data[offset];
+    }
+
+    template <typename T>
+    inline auto TensorView<T>::cursor(const TensorShape& result) const -> TensorLeafCursor<const value_type> {
+        return TensorLeafCursor<const value_type>(_data, broadcast_strides(_shape, _strides, result));
+    }
+
+    /*****************************************************************************************/
+    //
+    //                                    View Transforms
+    //
+    /*****************************************************************************************/
+
+    /*
+        Only a contiguous view can be reshaped, to a shape of the same size.
+    */
+    template <typename T>
+    inline TensorView<T> TensorView<T>::reshape(TensorShape shape) const {
+        if (!is_contiguous() || shape_size(shape) != size()) {
+            throw std::invalid_argument("TensorView::reshape: the view is not contiguous, or the sizes differ");
+        }
+        return TensorView(_data, std::move(shape));
+    }
+
+    /*
+        Dimension d of the result is dimension axes[d] of this view.
+    */
+    template <typename T>
+    inline TensorView<T> TensorView<T>::permute(const std::vector<std::size_t>& axes) const {
+        if (axes.size() != rank()) {
+            throw std::invalid_argument("TensorView::permute: one axis is needed per dimension");
+        }
+        TensorShape   shape(rank());
+        TensorStrides strides(rank());
+        for (std::size_t d = 0; d < rank(); ++d) {
+            shape[d]   = _shape.at(axes[d]);
+            strides[d] = _strides.at(axes[d]);
+        }
+        return TensorView(_data, std::move(shape), std::move(strides));
+    }
+
+    template <typename T>
+    inline TensorView<T> TensorView<T>::transpose() const {
+        return TensorView(_data, TensorShape(_shape.rbegin(), _shape.rend()), TensorStrides(_strides.rbegin(), _strides.rend()));
+    }
+
+    /*
+        The indices [first, last) along 'axis'.
+    */
+    template <typename T>
+    inline TensorView<T> TensorView<T>::slice(std::size_t axis, std::size_t first, std::size_t last) const {
+        if (axis >= rank() || first > last || last > _shape[axis]) {
+            throw std::invalid_argument("TensorView::slice: the range is outside of the view");
+        }
+        auto shape = _shape;
+        shape[axis] = last - first;
+        return TensorView(_data + static_cast<std::ptrdiff_t>(first) * _strides[axis], std::move(shape), _strides);
+    }
+
+    /*
+        Inserts a dimension of extent one before dimension 'axis', as with
+        numpy.expand_dims(), so a vector of n elements may broadcast as an
+        n x 1 column.
+    */
+    template <typename T>
+    inline TensorView<T> TensorView<T>::expand_dims(std::size_t axis) const {
+        if (axis > rank()) {
+            throw std::invalid_argument("TensorView::expand_dims: the axis is outside of the view");
+        }
+        auto shape   = _shape;
+        auto strides = _strides;
+        shape.insert(shape.begin() + axis, 1);
+        strides.insert(strides.begin() + axis, 0);
+        return TensorView(_data, std::move(shape), std::move(strides));
+    }
+
+    /*
+        The broadcast view is read only, since its repeated elements alias one
+        another.
+    */
+    template <typename T>
+    inline TensorView<const T> TensorView<T>::broadcast_to(const TensorShape& shape) const {
+        if (broadcast_shapes(_shape, shape) != shape) {
+            throw std::invalid_argument("TensorView::broadcast_to: the view does not broadcast to the shape");
+        }
+        return TensorView<const T>(_data, shape, broadcast_strides(_shape, _strides, shape));
+    }
+
+    /*****************************************************************************************/
+    //
+    //                               Element Wise Expressions
+    //
+    /*****************************************************************************************/
+
+    template <typename T>
+    template <typename RE>
+    inline auto TensorView<T>::operator +(const RE& re) const -> TensorExpr<TensorView, Add_Op<value_type>, tensor_operand_t<value_type, RE>> {
+        return TensorExpr<TensorView, Add_Op<value_type>, tensor_operand_t<value_type, RE>>(*this, tensor_operand<value_type>(re));
+    }
+
+    template <typename T>
+    template <typename RE>
+    inline auto TensorView<T>::operator -(const RE& re) const -> TensorExpr<TensorView, Sub_Op<value_type>, tensor_operand_t<value_type, RE>> {
+        return TensorExpr<TensorView, Sub_Op<value_type>, tensor_operand_t<value_type, RE>>(*this, tensor_operand<value_type>(re));
+    }
+
+    template <typename T>
+    template <typename RE>
+    inline auto TensorView<T>::operator *(const RE& re) const -> TensorExpr<TensorView, Mul_Op<value_type>, tensor_operand_t<value_type, RE>> {
+        return TensorExpr<TensorView, Mul_Op<value_type>, tensor_operand_t<value_type, RE>>(*this, tensor_operand<value_type>(re));
+    }
+
+    template <typename T>
+    template <typename RE>
+    inline auto TensorView<T>::operator /(const RE& re) const -> TensorExpr<TensorView, Div_Op<value_type>, tensor_operand_t<value_type, RE>> {
+        return TensorExpr<TensorView, Div_Op<value_type>, tensor_operand_t<value_type, RE>>(*this, tensor_operand<value_type>(re));
+    }
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Parallel.h"
+#include "Reductions.h"
+
+namespace Oliver {
+
+    /********************************************************************************************/
+    //
+    //                                Sliding Window Aggregates
+    //
+    //          rolling<Op>(x, w) aggregates every full window of 'w' consecutive
+    //          elements, so that out[j] = x[j] Op x[j + 1] Op ... Op x[j + w - 1], and
+    //          the result holds x.size() - w + 1 elements, (none when w > x.size()).
+    //
+    //          Sums use a running difference, adding the element entering the window
+    //          and subtracting the one leaving it.  Any other associative Op, such as
+    //          Min_Op and Max_Op, uses the van Herk / Gil-Werman algorithm: the input
+    //          is cut into blocks of w elements, each block gets a prefix and a suffix
+    //          aggregate, and every window is then the suffix of one block combined
+    //          with the prefix of the next.  Both are O(1) per element independent
+    //          of w, and the latter has no data dependent branches.
+    //
+    //          A floating point running sum carries a Neumaier compensation term,
+    //          so that a large element leaving the window does not take the small
+    //          ones still in it with it, (rolling_sum({1e20, 1, 1, 1, 1}, 2) is
+    //          {1e20, 2, 2, 2} rather than {1e20, 0, 0, 0}).
+    //
+    //          The output is split into chunks evaluated in parallel.  Each chunk
+    //          also reads the w - 1 elements past its end, (its halo), and restarts
+    //          its running sum.
+    //
+    //          rolling_mean divides the sums in floating point, so the mean of an
+    //          integer sequence is a sequence of double.
+    //
+    /********************************************************************************************/
+
+    constexpr std::size_t window_tile_size = std::size_t{ 1 } << 14;
+
+    /*
+        Adds 'value' to 'total', accumulating the low order bits it loses in
+        'error', (Neumaier).  The compensated sum is total + error.
+    */
+    template <typename T>
+    void compensated_add(T& total, T& error, T value) {
+        const T sum = total + value;
+        if (std::abs(total) >= std::abs(value)) {
+            error += (total - sum) + value;
+        }
+        else {
+            error += (value - sum) + total;
+        }
+        total = sum;
+    }
+
+    /*
+        Sums the windows starting in [first, last) with a running difference.
+    */
+    template <typename T, typename Reader>
+    void window_sum_range(const Reader& in, T* out, std::size_t first, std::size_t last, std::size_t width) {
+        T total = T{ 0 };
+        if constexpr (std::is_floating_point_v<T>) {
+            T error = T{ 0 };
+            for (std::size_t i = first; i < first + width; ++i) {
+                compensated_add(total, error, static_cast<T>(in[i]));
+            }
+            out[first] = total + error;
+            for (std::size_t j = first + 1; j < last; ++j) {
+                compensated_add(total, error, static_cast<T>(in[j + width - 1]));
+                compensated_add(total, error, static_cast<T>(-in[j - 1]));
+                out[j] = total + error;
+            }
+        }
+        else {
+            for (std::size_t i = first; i < first + width; ++i) {
+                total += in[i];
+            }
+            out[first] = total;
+            for (std::size_t j = first + 1; j < last; ++j) {
+                const T entering = in[j + width - 1];
+                const T leaving  = in[j - 1];
+                total   += entering - leaving;
+                out[j]   = total;
+            }
+        }
+    }
+
+    /*
+        Aggregates the windows starting in [first, last) with van Herk / Gil-Werman.
+        The blocks are aligned to 'first', and 'prefix' and 'suffix' are scratch
+        space for the last - first + width - 1 elements read.
+    */
+    template <typename Op, typename T, typename Reader>
+    void window_block_range(const Reader& in, T* out, std::size_t first, std::size_t last, std::size_t width, std::vector<T>& prefix, std::vector<T>& suffix) {
+        const auto length = last - first + width - 1;
+        prefix.resize(length);
+        suffix.resize(length);
+        for (std::size_t block = 0; block < length; block += width) {
+            const auto end = std::min(block + width, length);
+            prefix[block] = in[first + block];
+            for (std::size_t t = block + 1; t < end; ++t) {
+                const T value = in[first + t];
+                prefix[t] = Op::apply(std::as_const(prefix[t - 1]), value);
+            }
+            suffix[end - 1] = in[first + end - 1];
+            for (std::size_t t = end - 1; t-- > block;) {
+                const T value = in[first + t];
+                suffix[t] = Op::apply(value, std::as_const(suffix[t + 1]));
+            }
+        }
+        for (std::size_t t = 0; t < last - first; ++t) {
+            if (t % width == 0) {
+                out[first + t] = suffix[t];
+            }
+            else {
+                out[first + t] = Op::apply(std::as_const(suffix[t]), std::as_const(prefix[t + width - 1]));
+            }
+        }
+    }
+
+    template <typename Op, typename T, typename Reader>
+    void window_into(const Reader& in, T* out, std::size_t windows, std::size_t width, std::size_t grain) {
+        parallel_for(windows, grain, [&](std::size_t first, std::size_t last, std::size_t) {
+            if constexpr (std::is_same_v<Op, Add_Op<T>>) {
+                window_sum_range(in, out, first, last, width);
+            }
+            else {
+                const auto tile = std::max(4 * width, window_tile_size);
+                std::vector<T> prefix;
+                std::vector<T> suffix;
+                for (auto at = first; at < last; at += tile) {
+                    window_block_range<Op>(in, out, at, std::min(at + tile, last), width, prefix, suffix);
+                }
+            }
+        });
+    }
+
+    template <typename Op, typename Expr>
+    auto rolling(const Expr& expr, std::size_t width, std::size_t grain = default_grain) -> sequence_type_of<Expr> {
+        using value_type = expr_value_type<Expr>;
+        const auto size    = expr.size();
+        const auto windows = (width == 0 || width > size) ? 0 : size - width + 1;
+        sequence_type_of<Expr> out;
+        fill_sequence(out, windows, [&](value_type* data) {
+            if (windows > 0) {
+                window_into<Op>(element_reader(expr), data, windows, width, grain);
+            }
+        });
+        return out;
+    }
+
+    template <typename Expr>
+    auto rolling_sum(const Expr& expr, std::size_t width) -> sequence_type_of<Expr> {
+        return rolling<Add_Op<expr_value_type<Expr>>>(expr, width);
+    }
+
+    template <typename Expr>
+    auto rolling_min(const Expr& expr, std::size_t width) -> sequence_type_of<Expr> {
+        return rolling<Min_Op<expr_value_type<Expr>>>(expr, width);
+    }
+
+    template <typename Expr>
+    auto rolling_max(const Expr& expr, std::size_t width) -> sequence_type_of<Expr> {
+        return rolling<Max_Op<expr_value_type<Expr>>>(expr, width);
+    }
+
+    template <typename Expr>
+    auto rolling_mean(const Expr& expr, std::size_t width) {
+        using value_type = expr_value_type<Expr>;
+        if constexpr (std::is_floating_point_v<value_type>) {
+            auto out = rolling_sum(expr, width);
+            const auto divisor = static_cast<value_type>(width);
+            for (auto& value : out) {
+                value /= divisor;
+            }
+            return out;
+        }
+        else {
+            const auto sums = rolling_sum(expr, width);
+            const auto divisor = static_cast<double>(width);
+            SeqContainer<double> out;
+            fill_sequence(out, sums.size(), [&](double* data) {
+                for (std::size_t i = 0; i < sums.size(); ++i) {
+                    data[i] = static_cast<double>(sums[i]) / divisor;
+                }
+            });
+            return out;
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+/*
+    An arena sequence moved by construction out of its ArenaScope is rebuilt
+    on the outer arena, (or the global heap), so it stays readable after the
+    scope releases its arena.
+
+    g++ -std=c++20 -pthread -I../src Arena_Allocator_Test.cpp
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "Arena_Allocator.h"
+
+using namespace Oliver;
+
+ArenaSeqContainer<int> iota(std::size_t n) {
+    ArenaSeqContainer<int> seq;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        seq[i] = static_cast<int>(i);
+    }
+
+    return seq;
+}
+
+ArenaSeqContainer<int> scoped_iota(std::size_t n) {
+    ArenaScope scope;
+    ArenaSeqContainer<int> seq = iota(n);
+
+    return std::move(seq);
+}
+
+int main() {
+
+    // Move construction into a container which outlives the scope.
+    {
+        std::vector<ArenaSeqContainer<int>> keep;
+        {
+            ArenaScope scope;
+            ArenaSeqContainer<int> tmp = iota(1000);
+            keep.push_back(std::move(tmp));
+        }
+        assert(keep[0].impl().get_allocator().arena() == nullptr);
+        assert(keep[0][500] == 500);
+        assert(keep[0][999] == 999);
+    }
+
+    // Return from a function holding the scope.
+    {
+        ArenaSeqContainer<int> seq = scoped_iota(1000);
+        assert(seq[500] == 500);
+        assert(seq[999] == 999);
+    }
+
+    // Nested scopes, the sequence lands on the outer arena.
+    {
+        ArenaScope outer;
+        std::vector<ArenaSeqContainer<int>> keep;
+        {
+            ArenaScope inner;
+            ArenaSeqContainer<int> tmp = iota(100);
+            keep.push_back(std::move(tmp));
+        }
+        assert(keep[0].impl().get_allocator().arena() == Arena::current());
+        assert(keep[0][42] == 42);
+    }
+
+    // A heap sequence still moves without copying.
+    {
+        ArenaSeqContainer<int> heap = iota(100);
+        const int* data = heap.data();
+        ArenaSeqContainer<int> moved(std::move(heap));
+        assert(moved.data() == data);
+    }
+
+    std::cout << "Arena_Allocator_Test passed\n";
+    return 0;
+}
@@ -0,0 +1,189 @@
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+/*
+    A convolution is checked against a plain loop over the full convolution,
+    in every mode, with kernels shorter and longer than the signal, and long
+    enough for the FFT method, over several threads.  It is not element wise:
+    element i reads the elements of the signal before it.  So it must not
+    reuse the buffer of an rvalue operand, and an assignment to its own
+    signal must not overwrite elements it has yet to read.
+
+    g++ -std=c++20 -pthread -I../src Convolution_Test.cpp
+*/
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "Convolution.h"
+#include "Test_Helpers.h"
+
+using namespace Oliver;
+using namespace Oliver::Test;
+
+/*
+    y[j] = sum over k of h[k] x[j - k], cut to the range of 'mode'.
+*/
+std::vector<double> naive_convolution(const SeqContainer<double>& x, const SeqContainer<double>& h, ConvolutionMode mode) {
+    const auto nx = x.size();
+    const auto nh = h.size();
+    std::vector<double> full(nx + nh - 1, 0.0);
+    for (std::size_t j = 0; j < full.size(); ++j) {
+        for (std::size_t k = 0; k < nh; ++k) {
+            if (j >= k && j - k < nx) {
+                full[j] += h[k] * x[j - k];
+            }
+        }
+    }
+    std::size_t first = 0;
+    std::size_t count = nx;
+    switch (mode) {
+    case ConvolutionMode::full:
+        count = full.size();
+        break;
+    case ConvolutionMode::same:
+        first = (nh - 1) / 2;
+        break;
+    case ConvolutionMode::valid:
+        first = nh - 1;
+        count = nx >= nh ? nx - nh + 1 : 0;
+        break;
+    default:
+        break;
+    }
+    return std::vector<double>(full.begin() + first, full.begin() + first + count);
+}
+
+bool near(const SeqContainer<double>& seq, const std::vector<double>& values) {
+    if (seq.size() != values.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (std::abs(seq[i] - values[i]) > 1e-9 * (1.0 + std::abs(values[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SeqContainer<double> wave(std::size_t count) {
+    SeqContainer<double> x;
+    for (std::size_t i = 0; i < count; ++i) {
+        x[i] = std::sin(0.01 * static_cast<double>(i)) + 0.5;
+    }
+    return x;
+}
+
+SeqContainer<double> harmonic(std::size_t count) {
+    SeqContainer<double> h;
+    for (std::size_t k = 0; k < count; ++k) {
+        h[k] = 1.0 / static_cast<double>(k + 1);
+    }
+    return h;
+}
+
+int main() {
+    set_thread_count(4);
+
+    const auto h = sequence({ 1, 1 });
+
+    {
+        auto x = sequence({ 1, 2, 3, 4, 5 });
+        static_assert(!is_element_wise<std::remove_cvref_t<decltype(fir(x, h) + x)>>::value);
+    }
+
+    // Every mode, by the direct method below convolution_fft_cutoff taps and
+    // by overlap-save above it, tiled over several threads, against the loop.
+    // A plain assignment computes each element as a dot product instead.
+    for (const std::size_t nx : { 1, 5, 300, 12000 }) {
+        for (const std::size_t nh : { 1, 4, 130, 500 }) {
+            const auto x    = wave(nx);
+            const auto taps = harmonic(nh);
+            for (const auto mode : { ConvolutionMode::full, ConvolutionMode::same, ConvolutionMode::valid, ConvolutionMode::causal }) {
+                const auto expected = naive_convolution(x, taps, mode);
+                SeqContainer<double> tiled;
+                convolve_assign(tiled, convolve(x, taps, mode), 1024);
+                assert(near(tiled, expected));
+                if (nx * nh <= 300 * 500) {
+                    SeqContainer<double> direct;
+                    direct.resize(expected.size());
+                    direct = convolve(x, taps, mode);
+                    assert(near(direct, expected));
+                }
+            }
+        }
+    }
+
+    // A signal which is an expression, read into the scratch of each tile.
+    {
+        const auto x    = wave(12000);
+        const auto taps = harmonic(130);
+        const auto expected = naive_convolution(x, taps, ConvolutionMode::same);
+        SeqContainer<double> y;
+        convolve_assign(y, convolve(x * scalar(2.0), taps, ConvolutionMode::same) - scalar(1.0), 1024);
+        assert(y.size() == expected.size());
+        for (std::size_t i = 0; i < y.size(); ++i) {
+            assert(std::abs(y[i] - (2.0 * expected[i] - 1.0)) <= 1e-9 * (1.0 + std::abs(expected[i])));
+        }
+    }
+
+    // The rvalue signal is not reused as the destination buffer.
+    {
+        auto signal = sequence({ 1, 2, 3, 4, 5 });
+        SeqContainer<double> r = fir(signal, h) + std::move(signal);
+        assert(equals(r, { 2, 5, 8, 11, 14 }));
+    }
+
+    // Assignments to the signal of the convolution.
+    {
+        auto x = sequence({ 1, 2, 3, 4, 5 });
+        x = fir(x, h);
+        assert(equals(x, { 1, 3, 5, 7, 9 }));
+    }
+    {
+        auto x = sequence({ 1, 2, 3, 4, 5 });
+        x += fir(x, h);
+        assert(equals(x, { 2, 5, 8, 11, 14 }));
+    }
+    {
+        auto x = sequence({ 1, 2, 3, 4, 5 });
+        convolve_assign(x, fir(x, h));
+        assert(equals(x, { 1, 3, 5, 7, 9 }));
+    }
+
+    // A kernel long enough for the FFT method, assigned over its own signal.
+    {
+        auto       x        = wave(8192);
+        const auto taps     = harmonic(128);
+        const auto expected = naive_convolution(x, taps, ConvolutionMode::causal);
+        convolve_assign(x, fir(x, taps));
+        assert(near(x, expected));
+    }
+
+    std::cout << "Convolution_Test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+/*
+    Integer coefficients are computed modulo 2^N.  A signed coefficient type
+    must wrap like its unsigned counterpart rather than overflow, so each
+    result is checked against the same computation in unsigned arithmetic,
+    with the undefined behavior sanitizer catching any signed overflow.
+
+    g++ -std=c++20 -pthread -fsanitize=undefined -fno-sanitize-recover=undefined -I../src Polynomial_Test.cpp
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+#include "Polynomial.h"
+
+using namespace Oliver;
+
+/*
+    Coefficients near the limits of the type, of both signs.
+*/
+template <typename T>
+SeqContainer<T> extreme(std::size_t count, std::size_t seed) {
+    SeqContainer<T> p;
+    for (std::size_t i = 0; i < count; ++i) {
+        switch ((i + seed) % 3) {
+            case 0:  p[i] = std::numeric_limits<T>::max();                        break;
+            case 1:  p[i] = std::numeric_limits<T>::min() + static_cast<T>(i);   break;
+            default: p[i] = static_cast<T>(i * 7919 % 1000) - 500;                break;
+        }
+    }
+    return p;
+}
+
+/*
+    Coefficients in [-500, 500), small enough for the number theoretic transform.
+*/
+template <typename T>
+SeqContainer<T> small(std::size_t count, std::size_t seed) {
+    SeqContainer<T> p;
+    for (std::size_t i = 0; i < count; ++i) {
+        p[i] = static_cast<T>((i + seed) * 7919 % 1000) - 500;
+    }
+    return p;
+}
+
+/*
+    The product computed directly modulo 2^64, and so modulo 2^N.
+*/
+template <typename T>
+bool product_wraps(const SeqContainer<T>& a, const SeqContainer<T>& b) {
+    using U = std::uint64_t;
+    const auto c = poly_mul(a, b);
+    if (c.size() != a.size() + b.size() - 1) {
+        return false;
+    }
+    for (std::size_t k = 0; k < c.size(); ++k) {
+        U expected = 0;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if (k >= i && k - i < b.size()) {
+                expected += static_cast<U>(a[i]) * static_cast<U>(b[k - i]);
+            }
+        }
+        if (c[k] != static_cast<T>(expected)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+
+    // Schoolbook, Karatsuba and transform products of signed coefficients.
+    assert(product_wraps(extreme<int>(8, 0), extreme<int>(5, 1)));
+    assert(product_wraps(extreme<int>(100, 0), extreme<int>(60, 2)));
+    assert(product_wraps(extreme<std::int64_t>(400, 1), extreme<std::int64_t>(300, 0)));
+    assert(product_wraps(small<int>(600, 0), small<int>(500, 3)));
+
+    // A narrow type promotes to int, and its products are computed unsigned as well.
+    assert(product_wraps(extreme<short>(50, 0), extreme<short>(40, 1)));
+
+    // Division by a monic divisor: a = q b + r modulo 2^N.
+    {
+        const auto a = extreme<int>(200, 0);
+        const SeqContainer<int> b{ 3, std::numeric_limits<int>::max(), -1 };
+        const auto [q, r] = poly_divmod(a, b);
+        const auto back = poly_add(poly_mul(q, b), r);
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            assert(back[i] == a[i]);
+        }
+    }
+
+    // The subproduct tree agrees with Horner's rule.
+    {
+        const auto p = extreme<std::int64_t>(200, 2);
+        SeqContainer<std::int64_t> xs;
+        for (std::size_t i = 0; i < 300; ++i) {
+            xs[i] = static_cast<std::int64_t>(i * 1000003) - 150000000;
+        }
+        const auto tree   = poly_eval_multipoint(p, xs);
+        const auto direct = poly_eval(p, xs);
+        assert(tree.size() == xs.size());
+        for (std::size_t i = 0; i < xs.size(); ++i) {
+            assert(tree[i] == direct[i]);
+            assert(direct[i] == horner(p, xs[i]));
+        }
+    }
+
+    std::cout << "Polynomial_Test passed\n";
+    return 0;
+}
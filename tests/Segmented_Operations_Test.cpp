@@ -0,0 +1,81 @@
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+/*
+    Scans and segmented reductions with an associative Op which is not
+    commutative.  Assign_Op(a, b) returns b, so a reduction yields the last
+    element of its range, and reordering any two operands changes the result.
+
+    g++ -std=c++20 -pthread -I../src Segmented_Operations_Test.cpp
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+
+#include "Segmented_Operations.h"
+
+using namespace Oliver;
+
+int main() {
+    set_thread_count(4);
+
+    SeqContainer<double> x;
+    SeqContainer<int>    flags;
+    SeqContainer<int>    keys;
+    for (std::size_t i = 0; i < 100; ++i) {
+        x[i]     = static_cast<double>(i);
+        flags[i] = i % 30 == 0 ? 1 : 0;
+        keys[i]  = static_cast<int>(i / 30);
+    }
+
+    const auto exclusive = exclusive_scan<Assign_Op<double>>(x, -1.0, 10);
+    const auto inclusive = inclusive_scan<Assign_Op<double>>(x, 10);
+    assert(exclusive[0] == -1.0);
+    for (std::size_t i = 1; i < 100; ++i) {
+        assert(exclusive[i] == static_cast<double>(i - 1));
+    }
+    for (std::size_t i = 0; i < 100; ++i) {
+        assert(inclusive[i] == static_cast<double>(i));
+    }
+
+    const auto last = segmented_reduce<Assign_Op<double>>(x, flags, 10);
+    assert(last.size() == 4);
+    assert(last[0] == 29.0 && last[1] == 59.0 && last[2] == 89.0 && last[3] == 99.0);
+
+    const auto [by_key, last_by_key] = reduce_by_key<Assign_Op<double>>(x, keys, 10);
+    assert(by_key.size() == 4 && last_by_key.size() == 4);
+    for (std::size_t s = 0; s < 4; ++s) {
+        assert(by_key[s] == static_cast<int>(s));
+        assert(last_by_key[s] == last[s]);
+    }
+
+    const auto scanned = segmented_inclusive_scan<Assign_Op<double>>(x, flags, 10);
+    for (std::size_t i = 0; i < 100; ++i) {
+        assert(scanned[i] == static_cast<double>(i));
+    }
+
+    std::cout << "Segmented_Operations_Test passed" << std::endl;
+    return 0;
+}
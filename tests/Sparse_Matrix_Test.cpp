@@ -0,0 +1,138 @@
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+/*
+    A sparse product is not element wise: row i reads every element of x.  So
+    it must not reuse the buffer of an rvalue operand, and an assignment to a
+    sequence the product reads must not overwrite elements it has yet to read.
+
+    g++ -std=c++20 -pthread -I../src Sparse_Matrix_Test.cpp
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "Sparse_Matrix.h"
+#include "Statement_Fusion.h"
+#include "Test_Helpers.h"
+
+using namespace Oliver;
+using namespace Oliver::Test;
+
+/*
+    | 1 1 0 |
+    | 0 1 1 |   times (1, 2, 3) is (3, 5, 4)
+    | 1 0 1 |
+*/
+SparseMatrix<double> cycle_matrix() {
+    return SparseMatrix<double>::from_entries(3, 3, {
+        { 0, 0, 1.0 }, { 0, 1, 1.0 },
+        { 1, 1, 1.0 }, { 1, 2, 1.0 },
+        { 2, 0, 1.0 }, { 2, 2, 1.0 } });
+}
+
+template <typename Func>
+bool throws_invalid_argument(Func&& func) {
+    try {
+        func();
+    }
+    catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    const auto a = cycle_matrix();
+
+    {
+        auto y = sequence({ 1, 2, 3 });
+        static_assert(!is_element_wise<std::remove_cvref_t<decltype(a * y + y)>>::value);
+        static_assert(is_element_wise<std::remove_cvref_t<decltype(y + y)>>::value);
+    }
+
+    // The rvalue y is not reused as the destination buffer.
+    {
+        auto y = sequence({ 1, 2, 3 });
+        SeqContainer<double> z = a * y + std::move(y);
+        assert(equals(z, { 4, 7, 7 }));
+    }
+
+    // Assignments to the x of the product.
+    {
+        auto x = sequence({ 1, 2, 3 });
+        x = a * x;
+        assert(equals(x, { 3, 5, 4 }));
+    }
+    {
+        auto x = sequence({ 1, 2, 3 });
+        x += a * x;
+        assert(equals(x, { 4, 7, 7 }));
+    }
+    {
+        auto x = sequence({ 1, 2, 3 });
+        sparse_assign(x, a * x + x);
+        assert(equals(x, { 4, 7, 7 }));
+    }
+    {
+        auto x = sequence({ 1, 2, 3 });
+        spmv(1.0, a, x, 0.0, x);
+        assert(equals(x, { 3, 5, 4 }));
+    }
+
+    // An unaliased product is unchanged.
+    {
+        const auto x = sequence({ 1, 2, 3 });
+        SeqContainer<double> y;
+        sparse_assign(y, a * x);
+        assert(equals(y, { 3, 5, 4 }));
+    }
+
+    // A rectangular matrix with an empty row.
+    {
+        const auto b = SparseMatrix<double>::from_entries(3, 4, { { 0, 3, 2.0 }, { 2, 0, -1.0 }, { 2, 2, 0.5 } });
+        const auto x = sequence({ 1, 2, 3, 4 });
+        SeqContainer<double> y;
+        sparse_assign(y, b * x);
+        assert(equals(y, { 8, 0, 0.5 }));
+    }
+
+    // Shapes.
+    {
+        const auto shorter = sequence({ 1, 2 });
+        assert(throws_invalid_argument([&] { SeqContainer<double> y = a * shorter + shorter; }));
+        assert(throws_invalid_argument([&] { SeqContainer<double> y; spmv(1.0, a, shorter, 0.0, y); }));
+        assert(throws_invalid_argument([] { SparseMatrix<double>(2, 2, { 0, 1 }, { 0 }, { 1.0 }); }));
+        assert(throws_invalid_argument([] { SparseMatrix<double>(2, 2, { 0, 2, 1 }, { 0 }, { 1.0 }); }));
+        assert(throws_invalid_argument([] { SparseMatrix<double>(1, 2, { 0, 1 }, { 2 }, { 1.0 }); }));
+        assert(throws_invalid_argument([] { SparseMatrix<double>::from_entries(2, 2, { { 2, 0, 1.0 } }); }));
+        assert(throws_invalid_argument([] { SparseMatrix<double>::from_entries(2, 2, { { 0, 2, 1.0 } }); }));
+    }
+
+    std::cout << "Sparse_Matrix_Test passed" << std::endl;
+    return 0;
+}
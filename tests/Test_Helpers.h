@@ -0,0 +1,59 @@
+#pragma once
+
+/*****************************************************************************************/
+//
+//                           Copyright(C) 2024 Max J Martin
+//
+//                            This file is part of Oliver.
+//                      Oliver is program language interpreter.
+//
+//        This program is free software : you can redistribute it and /or modify
+//        it under the terms of the GNU Affero General Public License as published by
+//        the Free Software Foundation, either version 3 of the License, or
+//        (at your option) any later version.
+//
+//        This program is distributed in the hope that it will be useful,
+//        but WITHOUT ANY WARRANTY; without even the implied warranty of
+//        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//        GNU Affero General Public License for more details.
+//
+//        You should have received a copy of the GNU Affero General Public License
+//        along with this program.If not, see <https://www.gnu.org/licenses/>.
+//
+//        The author can be reached at: maxjmartin@gmail.com
+//
+/*****************************************************************************************/
+
+/*
+    Helpers shared by the tests of the expression template leaves.
+*/
+
+#include <cstddef>
+#include <initializer_list>
+
+#include "SeqContainer.h"
+
+namespace Oliver::Test {
+
+    inline SeqContainer<double> sequence(std::initializer_list<double> values) {
+        SeqContainer<double> seq;
+        std::size_t i = 0;
+        for (const auto value : values) {
+            seq[i++] = value;
+        }
+        return seq;
+    }
+
+    inline bool equals(const SeqContainer<double>& seq, std::initializer_list<double> values) {
+        if (seq.size() != values.size()) {
+            return false;
+        }
+        std::size_t i = 0;
+        for (const auto value : values) {
+            if (seq[i++] != value) {
+                return false;
+            }
+        }
+        return true;
+    }
+}